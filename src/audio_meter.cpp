@@ -0,0 +1,262 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "audio_meter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_METER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define AUDIO_METER_NEON
+#include <arm_neon.h>
+#endif
+
+//MSVC compiles AVX intrinsics without extra flags, GCC and Clang need them enabled per function
+#if defined(AUDIO_METER_X86) && !defined(_MSC_VER)
+#define AUDIO_METER_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AUDIO_METER_AVX2_TARGET
+#endif
+
+static void accumulate_scalar(audio_meter::level& value, const float* samples, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		value.m_sum_squares += samples[i] * samples[i];
+		value.m_peak = std::max(value.m_peak, std::fabs(samples[i]));
+	}
+}
+
+#ifdef AUDIO_METER_X86
+static audio_meter::level measure_sse2(const float* samples, size_t count)
+{
+	//Four independent accumulators each, one would wait for the previous add every time
+	const auto magnitude_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+	auto sum0 = _mm_setzero_ps();
+	auto sum1 = _mm_setzero_ps();
+	auto sum2 = _mm_setzero_ps();
+	auto sum3 = _mm_setzero_ps();
+	auto peak0 = _mm_setzero_ps();
+	auto peak1 = _mm_setzero_ps();
+	auto peak2 = _mm_setzero_ps();
+	auto peak3 = _mm_setzero_ps();
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		auto a = _mm_loadu_ps(samples + i);
+		auto b = _mm_loadu_ps(samples + i + 4);
+		auto c = _mm_loadu_ps(samples + i + 8);
+		auto d = _mm_loadu_ps(samples + i + 12);
+
+		sum0 = _mm_add_ps(sum0, _mm_mul_ps(a, a));
+		sum1 = _mm_add_ps(sum1, _mm_mul_ps(b, b));
+		sum2 = _mm_add_ps(sum2, _mm_mul_ps(c, c));
+		sum3 = _mm_add_ps(sum3, _mm_mul_ps(d, d));
+
+		peak0 = _mm_max_ps(peak0, _mm_and_ps(a, magnitude_mask));
+		peak1 = _mm_max_ps(peak1, _mm_and_ps(b, magnitude_mask));
+		peak2 = _mm_max_ps(peak2, _mm_and_ps(c, magnitude_mask));
+		peak3 = _mm_max_ps(peak3, _mm_and_ps(d, magnitude_mask));
+	}
+
+	alignas(16) float sums[4];
+	alignas(16) float peaks[4];
+	_mm_store_ps(sums, _mm_add_ps(_mm_add_ps(sum0, sum1), _mm_add_ps(sum2, sum3)));
+	_mm_store_ps(peaks, _mm_max_ps(_mm_max_ps(peak0, peak1), _mm_max_ps(peak2, peak3)));
+
+	audio_meter::level result{ (sums[0] + sums[1]) + (sums[2] + sums[3]), std::max(std::max(peaks[0], peaks[1]), std::max(peaks[2], peaks[3])) };
+	accumulate_scalar(result, samples + i, count - i);
+
+	return result;
+}
+
+AUDIO_METER_AVX2_TARGET static audio_meter::level measure_avx2(const float* samples, size_t count)
+{
+	const auto magnitude_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+	auto sum0 = _mm256_setzero_ps();
+	auto sum1 = _mm256_setzero_ps();
+	auto sum2 = _mm256_setzero_ps();
+	auto sum3 = _mm256_setzero_ps();
+	auto peak0 = _mm256_setzero_ps();
+	auto peak1 = _mm256_setzero_ps();
+	auto peak2 = _mm256_setzero_ps();
+	auto peak3 = _mm256_setzero_ps();
+
+	size_t i = 0;
+	for (; i + 32 <= count; i += 32)
+	{
+		auto a = _mm256_loadu_ps(samples + i);
+		auto b = _mm256_loadu_ps(samples + i + 8);
+		auto c = _mm256_loadu_ps(samples + i + 16);
+		auto d = _mm256_loadu_ps(samples + i + 24);
+
+		sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(a, a));
+		sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(b, b));
+		sum2 = _mm256_add_ps(sum2, _mm256_mul_ps(c, c));
+		sum3 = _mm256_add_ps(sum3, _mm256_mul_ps(d, d));
+
+		peak0 = _mm256_max_ps(peak0, _mm256_and_ps(a, magnitude_mask));
+		peak1 = _mm256_max_ps(peak1, _mm256_and_ps(b, magnitude_mask));
+		peak2 = _mm256_max_ps(peak2, _mm256_and_ps(c, magnitude_mask));
+		peak3 = _mm256_max_ps(peak3, _mm256_and_ps(d, magnitude_mask));
+	}
+
+	auto sum = _mm256_add_ps(_mm256_add_ps(sum0, sum1), _mm256_add_ps(sum2, sum3));
+	auto peak = _mm256_max_ps(_mm256_max_ps(peak0, peak1), _mm256_max_ps(peak2, peak3));
+
+	alignas(16) float sums[4];
+	alignas(16) float peaks[4];
+	_mm_store_ps(sums, _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1)));
+	_mm_store_ps(peaks, _mm_max_ps(_mm256_castps256_ps128(peak), _mm256_extractf128_ps(peak, 1)));
+
+	//Leaving AVX code without this makes later SSE code pay for the dirty upper halves
+	_mm256_zeroupper();
+
+	audio_meter::level result{ (sums[0] + sums[1]) + (sums[2] + sums[3]), std::max(std::max(peaks[0], peaks[1]), std::max(peaks[2], peaks[3])) };
+	accumulate_scalar(result, samples + i, count - i);
+
+	return result;
+}
+
+static bool cpu_has_avx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	//AVX and OSXSAVE, without the latter the OS does not save the upper register halves
+	constexpr int AVX_OSXSAVE = (1 << 27) | (1 << 28);
+	__cpuid(info, 1);
+	if ((info[2] & AVX_OSXSAVE) != AVX_OSXSAVE || (_xgetbv(0) & 6) != 6)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#ifdef AUDIO_METER_NEON
+static audio_meter::level measure_neon(const float* samples, size_t count)
+{
+	auto sum0 = vdupq_n_f32(0.0f);
+	auto sum1 = vdupq_n_f32(0.0f);
+	auto sum2 = vdupq_n_f32(0.0f);
+	auto sum3 = vdupq_n_f32(0.0f);
+	auto peak0 = vdupq_n_f32(0.0f);
+	auto peak1 = vdupq_n_f32(0.0f);
+	auto peak2 = vdupq_n_f32(0.0f);
+	auto peak3 = vdupq_n_f32(0.0f);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		auto a = vld1q_f32(samples + i);
+		auto b = vld1q_f32(samples + i + 4);
+		auto c = vld1q_f32(samples + i + 8);
+		auto d = vld1q_f32(samples + i + 12);
+
+		sum0 = vmlaq_f32(sum0, a, a);
+		sum1 = vmlaq_f32(sum1, b, b);
+		sum2 = vmlaq_f32(sum2, c, c);
+		sum3 = vmlaq_f32(sum3, d, d);
+
+		peak0 = vmaxq_f32(peak0, vabsq_f32(a));
+		peak1 = vmaxq_f32(peak1, vabsq_f32(b));
+		peak2 = vmaxq_f32(peak2, vabsq_f32(c));
+		peak3 = vmaxq_f32(peak3, vabsq_f32(d));
+	}
+
+	float sums[4];
+	float peaks[4];
+	vst1q_f32(sums, vaddq_f32(vaddq_f32(sum0, sum1), vaddq_f32(sum2, sum3)));
+	vst1q_f32(peaks, vmaxq_f32(vmaxq_f32(peak0, peak1), vmaxq_f32(peak2, peak3)));
+
+	audio_meter::level result{ (sums[0] + sums[1]) + (sums[2] + sums[3]), std::max(std::max(peaks[0], peaks[1]), std::max(peaks[2], peaks[3])) };
+	accumulate_scalar(result, samples + i, count - i);
+
+	return result;
+}
+#endif
+
+static audio_meter::kernel select_kernel()
+{
+#if defined(AUDIO_METER_X86)
+	if (cpu_has_avx2())
+		return audio_meter::kernel{ measure_avx2, "AVX2" };
+
+	return audio_meter::kernel{ measure_sse2, "SSE2" };
+#elif defined(AUDIO_METER_NEON)
+	return audio_meter::kernel{ measure_neon, "NEON" };
+#else
+	return audio_meter::kernel{ audio_meter::measure_scalar, "scalar" };
+#endif
+}
+
+//Picked during static initialization, so the audio thread never runs into a guarded local static
+static const audio_meter::kernel selected_kernel = select_kernel();
+
+audio_meter::level audio_meter::measure(const float* samples, size_t count)
+{
+	return selected_kernel.m_function(samples, count);
+}
+
+audio_meter::level audio_meter::measure_scalar(const float* samples, size_t count)
+{
+	level result;
+	accumulate_scalar(result, samples, count);
+
+	return result;
+}
+
+const char* audio_meter::kernel_name()
+{
+	return selected_kernel.m_name;
+}
+
+std::vector<audio_meter::kernel> audio_meter::get_kernels()
+{
+	std::vector<kernel> result;
+
+#if defined(AUDIO_METER_X86)
+	if (cpu_has_avx2())
+		result.push_back(kernel{ measure_avx2, "AVX2" });
+
+	result.push_back(kernel{ measure_sse2, "SSE2" });
+#elif defined(AUDIO_METER_NEON)
+	result.push_back(kernel{ measure_neon, "NEON" });
+#endif
+
+	result.push_back(kernel{ measure_scalar, "scalar" });
+
+	return result;
+}
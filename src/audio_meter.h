@@ -0,0 +1,53 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+//Loudness of blocks of float samples, as OBS hands them to audio capture callbacks.
+//Never allocates or locks, the audio thread calls it for every block.
+class audio_meter
+{
+	public:
+		struct level
+		{
+			float m_sum_squares = 0.0f;
+			float m_peak = 0.0f;
+		};
+
+		struct kernel
+		{
+			level(*m_function)(const float* samples, size_t count);
+			const char* m_name;
+		};
+
+	public:
+		//Uses the widest kernel the CPU supports (AVX2, SSE2 or NEON), picked once when the plugin is loaded
+		static level measure(const float* samples, size_t count);
+
+		//Plain loop, the reference the vector kernels are compared against. Results differ by rounding only.
+		static level measure_scalar(const float* samples, size_t count);
+
+		//Name of the kernel measure() uses, for the log
+		static const char* kernel_name();
+
+		//Every kernel the CPU supports, widest first and measure_scalar last. For the tests, measure() never looks at it.
+		static std::vector<kernel> get_kernels();
+};
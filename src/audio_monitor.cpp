@@ -0,0 +1,248 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "audio_monitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+#include "audio_meter.h"
+#include "constants.h"
+
+audio_gate::audio_gate()
+	: audio_gate{ options{} }
+{ }
+
+audio_gate::audio_gate(const options& value)
+	: m_open_level{ std::pow(10.0f, static_cast<float>(value.m_threshold) / 20.0f) }
+	, m_close_level{ std::pow(10.0f, static_cast<float>(value.m_threshold - 6) / 20.0f) }
+	, m_attack{ static_cast<float>(value.m_attack) / 1000.0f }
+	, m_hold{ static_cast<float>(value.m_hold) / 1000.0f }
+	, m_release{ static_cast<float>(value.m_release) / 1000.0f }
+	, m_envelope{ 0.0f }
+	, m_below{ 0.0f }
+	, m_open{ false }
+{ }
+
+bool audio_gate::process(float rms, uint32_t frames, uint32_t sample_rate)
+{
+	if (!frames || !sample_rate)
+		return false;
+
+	auto duration = static_cast<float>(frames) / static_cast<float>(sample_rate);
+
+	//One pole smoothing, the coefficient follows the block length so any block size gives the same envelope
+	auto time_constant = rms > m_envelope ? m_attack : m_release;
+	auto coefficient = time_constant > 0.0f ? std::exp(-duration / time_constant) : 0.0f;
+	m_envelope = rms + (m_envelope - rms) * coefficient;
+
+	if (!m_open)
+	{
+		if (m_envelope < m_open_level)
+			return false;
+
+		m_open = true;
+		m_below = 0.0f;
+
+		return true;
+	}
+
+	if (m_envelope >= m_close_level)
+	{
+		m_below = 0.0f;
+		return false;
+	}
+
+	m_below += duration;
+	if (m_below < m_hold)
+		return false;
+
+	m_open = false;
+
+	return true;
+}
+
+audio_monitor::audio_monitor(callback value)
+	: m_callback{ std::move(value) }
+{ }
+
+audio_monitor::~audio_monitor()
+{
+	clear();
+}
+
+void audio_monitor::set_options(const audio_gate::options& value)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	m_options = value;
+}
+
+void audio_monitor::synchronize(obs_source_t* const* sources, size_t count)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	std::unordered_set<source_key, source_key_hash> wanted;
+	wanted.reserve(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto key = source_key::from_source(sources[i]);
+		if (!key.valid())
+			continue;
+
+		wanted.insert(key);
+
+		if (!m_attachments.count(key))
+			attach(sources[i], key);
+	}
+
+	for (auto it = m_attachments.begin(); it != m_attachments.end();)
+	{
+		if (wanted.count(it->first))
+		{
+			++it;
+			continue;
+		}
+
+		detach(std::move(it->second));
+		it = m_attachments.erase(it);
+	}
+}
+
+void audio_monitor::clear()
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	for (auto& v : m_attachments)
+		detach(std::move(v.second));
+
+	m_attachments.clear();
+}
+
+size_t audio_monitor::size() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	return m_attachments.size();
+}
+
+std::vector<audio_monitor::attachment_statistics> audio_monitor::get_statistics() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	std::vector<attachment_statistics> result;
+	result.reserve(m_attachments.size());
+
+	for (const auto& v : m_attachments)
+		result.push_back(statistics_of(*v.second));
+
+	return result;
+}
+
+void audio_monitor::audio_callback(void* param, obs_source_t* source, const audio_data* audio, bool muted)
+{
+	(void)source;	//unused parameter
+
+	auto a = static_cast<attachment*>(param);
+	if (a->m_retired.load(std::memory_order_relaxed) || !audio)
+		return;
+
+	auto start = clock::now();
+
+	//A muted source still delivers its samples, it counts as silence
+	audio_meter::level level;
+	if (!muted)
+	{
+		for (size_t i = 0; i < a->m_channels; ++i)
+		{
+			if (!audio->data[i])
+				continue;
+
+			auto channel = audio_meter::measure(reinterpret_cast<const float*>(audio->data[i]), audio->frames);
+			level.m_sum_squares += channel.m_sum_squares;
+			level.m_peak = std::max(level.m_peak, channel.m_peak);
+		}
+	}
+
+	auto samples = static_cast<float>(audio->frames) * static_cast<float>(a->m_channels);
+	auto rms = samples > 0.0f ? std::sqrt(level.m_sum_squares / samples) : 0.0f;
+	auto changed = a->m_gate.process(rms, audio->frames, a->m_sample_rate);
+
+	//This thread is the only writer, plain stores are enough
+	auto block_time = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+	a->m_blocks.store(a->m_blocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	a->m_block_time.store(a->m_block_time.load(std::memory_order_relaxed) + block_time, std::memory_order_relaxed);
+
+	if (block_time > a->m_max_block_time.load(std::memory_order_relaxed))
+		a->m_max_block_time.store(block_time, std::memory_order_relaxed);
+
+	if (level.m_peak > a->m_peak.load(std::memory_order_relaxed))
+		a->m_peak.store(level.m_peak, std::memory_order_relaxed);
+
+	if (!changed)
+		return;
+
+	a->m_open.store(a->m_gate.is_open(), std::memory_order_relaxed);
+	a->m_owner->m_callback(a->m_key, a->m_gate.is_open(), start);
+}
+
+audio_monitor::attachment_statistics audio_monitor::statistics_of(const attachment& value)
+{
+	auto source_ptr = std::unique_ptr<obs_source_t, std::function<void(obs_source_t*)>>(obs_weak_source_get_source(value.m_source), [](obs_source_t* ptr) -> void {obs_source_release(ptr); });
+	auto name = source_ptr ? obs_source_get_name(source_ptr.get()) : nullptr;
+
+	return attachment_statistics{ name ? name : "", value.m_blocks.load(), value.m_block_time.load(), value.m_max_block_time.load(), value.m_peak.load(), value.m_open.load() };
+}
+
+void audio_monitor::attach(obs_source_t* source, const source_key& key)
+{
+	auto a = std::make_unique<attachment>();
+	a->m_owner = this;
+	a->m_source = obs_source_get_weak_source(source);
+	a->m_key = key;
+	a->m_gate = audio_gate{ m_options };
+
+	//Capture callbacks get the mix format, float planar with the output's channels and rate
+	auto audio = obs_get_audio();
+	a->m_channels = std::min<size_t>(audio ? audio_output_get_channels(audio) : 0, MAX_AV_PLANES);
+	a->m_sample_rate = audio ? audio_output_get_sample_rate(audio) : 0;
+
+	obs_source_add_audio_capture_callback(source, audio_callback, a.get());
+
+	m_attachments.emplace(key, std::move(a));
+}
+
+void audio_monitor::detach(std::unique_ptr<attachment> value)
+{
+	value->m_retired = true;
+
+	auto statistics = statistics_of(*value);
+	if (statistics.m_blocks)
+		blog(LOG_INFO, "[%s] Audio gate on \"%s\": %llu blocks, %.2f us per block on average, %.2f us at most, peak %.1f dBFS (%s kernel)", PLUGIN_NAME_SHORT.data(), statistics.m_name.c_str(), static_cast<unsigned long long>(statistics.m_blocks), static_cast<double>(statistics.m_block_time) / static_cast<double>(statistics.m_blocks) / 1000.0, static_cast<double>(statistics.m_max_block_time) / 1000.0, statistics.m_peak > 0.0f ? 20.0 * std::log10(statistics.m_peak) : -INFINITY, audio_meter::kernel_name());
+
+	//Removing the callback waits for one running right now, a source which is gone took its callbacks along.
+	//Either way nothing calls into the attachment anymore, so it is freed right away.
+	auto source_ptr = std::unique_ptr<obs_source_t, std::function<void(obs_source_t*)>>(obs_weak_source_get_source(value->m_source), [](obs_source_t* ptr) -> void {obs_source_release(ptr); });
+	if (source_ptr)
+		obs_source_remove_audio_capture_callback(source_ptr.get(), audio_callback, value.get());
+
+	obs_weak_source_release(value->m_source);
+	value->m_source = nullptr;
+}
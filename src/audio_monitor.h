@@ -0,0 +1,146 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "source_key.h"
+
+//Decides whether a source is active from the RMS level of its audio blocks.
+//An envelope follows rising levels with the attack and falling ones with the release time constant.
+//The gate opens once the envelope reaches the threshold and closes after it stayed 6 dB below it for the hold time,
+//so neither a single loud block nor a short pause flips it.
+class audio_gate
+{
+	public:
+		struct options
+		{
+			int32_t m_threshold = -40;	//dBFS
+			uint32_t m_attack = 20;		//ms
+			uint32_t m_hold = 2000;		//ms
+			uint32_t m_release = 300;	//ms
+		};
+
+		audio_gate();
+		explicit audio_gate(const options& value);
+
+	public:
+		//One block of frames, true if the gate opened or closed with it
+		bool process(float rms, uint32_t frames, uint32_t sample_rate);
+
+		inline bool is_open() const { return m_open; }
+
+	protected:
+
+	private:
+		float m_open_level;
+		float m_close_level;
+
+		//Seconds
+		float m_attack;
+		float m_hold;
+		float m_release;
+
+		float m_envelope;
+		float m_below;
+		bool m_open;
+};
+
+//Runs an audio_gate on every wanted source through its audio capture callback.
+//synchronize() diffs the wanted sources against the attached ones, so only the change is (de)attached.
+//The callback runs on OBS's audio thread. It only touches its own attachment and calls out when the gate opened or closed.
+class audio_monitor
+{
+	public:
+		using clock = std::chrono::steady_clock;
+
+		//Called on the audio thread, active tells whether the gate opened or closed
+		using callback = std::function<void(const source_key& key, bool active, clock::time_point time)>;
+
+		struct attachment_statistics
+		{
+			std::string m_name;
+			uint64_t m_blocks;
+			uint64_t m_block_time;		//ns, all blocks together
+			uint64_t m_max_block_time;	//ns
+			float m_peak;
+			bool m_open;
+		};
+
+		explicit audio_monitor(callback value);
+		~audio_monitor();
+
+		//No copying
+		audio_monitor(const audio_monitor& other) = delete;
+		audio_monitor& operator = (const audio_monitor& other) = delete;
+
+	public:
+		//Applies to sources attached from now on
+		void set_options(const audio_gate::options& value);
+
+		void synchronize(obs_source_t* const* sources, size_t count);
+		void clear();
+
+		size_t size() const;
+		std::vector<attachment_statistics> get_statistics() const;
+
+	protected:
+
+	private:
+		struct attachment
+		{
+			audio_monitor* m_owner = nullptr;
+			obs_weak_source_t* m_source = nullptr;
+			source_key m_key;
+
+			//Audio thread only
+			audio_gate m_gate;
+			size_t m_channels = 0;
+			uint32_t m_sample_rate = 0;
+
+			std::atomic<uint64_t> m_blocks{ 0 };
+			std::atomic<uint64_t> m_block_time{ 0 };
+			std::atomic<uint64_t> m_max_block_time{ 0 };
+			std::atomic<float> m_peak{ 0.0f };
+			std::atomic_bool m_open{ false };
+			std::atomic_bool m_retired{ false };
+		};
+
+		static void audio_callback(void* param, obs_source_t* source, const audio_data* audio, bool muted);
+		static attachment_statistics statistics_of(const attachment& value);
+
+		void attach(obs_source_t* source, const source_key& key);
+		void detach(std::unique_ptr<attachment> value);
+
+		const callback m_callback;
+
+		mutable std::mutex m_mutex;
+		audio_gate::options m_options;
+		std::unordered_map<source_key, std::unique_ptr<attachment>, source_key_hash> m_attachments;
+};
@@ -0,0 +1,237 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "binary_rule_store.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+binary_rule_store::binary_rule_store()
+	: m_header{ nullptr }
+	, m_records{ nullptr }
+	, m_pool{ nullptr }
+{ }
+
+bool binary_rule_store::open(const std::filesystem::path& path)
+{
+	close();
+
+	if (!m_file.open(path))
+		return false;
+
+	auto data = m_file.data();
+	auto file_size = m_file.size();
+
+	if (file_size < sizeof(file_header))
+	{
+		close();
+		return false;
+	}
+
+	auto header = reinterpret_cast<const file_header*>(data);
+
+	//There is a single layout, a file of any other version or record size counts as damaged
+	bool valid = header->m_magic == MAGIC
+		&& header->m_version == VERSION
+		&& header->m_record_size == sizeof(file_record)
+		&& file_size == sizeof(file_header) + static_cast<uint64_t>(header->m_record_count) * header->m_record_size + header->m_pool_size
+		&& header->m_checksum == checksum(data + sizeof(file_header), file_size - sizeof(file_header));
+
+	if (!valid)
+	{
+		close();
+		return false;
+	}
+
+	m_header = header;
+	m_records = data + sizeof(file_header);
+	m_pool = reinterpret_cast<const char*>(m_records + static_cast<size_t>(header->m_record_count) * header->m_record_size);
+
+	for (size_t i = 0; i < size(); ++i)
+	{
+		const auto& r = record(i);
+		if (static_cast<uint64_t>(r.m_name_offset) + r.m_name_length > header->m_pool_size)
+		{
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void binary_rule_store::close()
+{
+	m_file.close();
+
+	m_header = nullptr;
+	m_records = nullptr;
+	m_pool = nullptr;
+}
+
+size_t binary_rule_store::size() const
+{
+	return m_header ? m_header->m_record_count : 0;
+}
+
+uint64_t binary_rule_store::get_revision() const
+{
+	return m_header ? m_header->m_revision : 0;
+}
+
+source_key binary_rule_store::get_key(size_t index) const
+{
+	const auto& r = record(index);
+	return source_key{ r.m_key_high, r.m_key_low };
+}
+
+std::string_view binary_rule_store::get_name(size_t index) const
+{
+	const auto& r = record(index);
+	return std::string_view{ m_pool + r.m_name_offset, r.m_name_length };
+}
+
+recording_setting::action binary_rule_store::get_action(size_t index) const
+{
+	return static_cast<recording_setting::action>(record(index).m_action);
+}
+
+uint32_t binary_rule_store::get_trigger_time(size_t index) const
+{
+	return record(index).m_trigger_time;
+}
+
+uint32_t binary_rule_store::get_pre_roll(size_t index) const
+{
+	return record(index).m_pre_roll;
+}
+
+recording_setting::match binary_rule_store::get_match(size_t index) const
+{
+	return static_cast<recording_setting::match>(record(index).m_match);
+}
+
+int32_t binary_rule_store::get_priority(size_t index) const
+{
+	return record(index).m_priority;
+}
+
+uint32_t binary_rule_store::get_window(size_t index) const
+{
+	return record(index).m_window;
+}
+
+recording_setting binary_rule_store::materialize(size_t index) const
+{
+	return recording_setting{ get_key(index), std::string{ get_name(index) }, get_action(index), get_trigger_time(index), get_pre_roll(index), get_match(index), get_priority(index), get_window(index) };
+}
+
+std::vector<recording_setting> binary_rule_store::materialize_all() const
+{
+	std::vector<recording_setting> result;
+	result.reserve(size());
+
+	for (size_t i = 0; i < size(); ++i)
+		result.push_back(materialize(i));
+
+	return result;
+}
+
+bool binary_rule_store::write(const std::filesystem::path& path, const std::vector<recording_setting>& settings, uint64_t revision)
+{
+	static_assert(sizeof(file_record) == 48 && sizeof(file_header) == 32, "the file layout must not depend on padding");
+
+	std::vector<uint8_t> body(settings.size() * sizeof(file_record));
+	std::string pool;
+
+	for (size_t i = 0; i < settings.size(); ++i)
+	{
+		const auto& v = settings[i];
+
+		file_record r{};
+		r.m_key_high = v.get_scene_key().get_high();
+		r.m_key_low = v.get_scene_key().get_low();
+		r.m_name_offset = static_cast<uint32_t>(pool.size());
+		r.m_name_length = static_cast<uint32_t>(v.get_scene_name().size());
+		r.m_trigger_time = v.get_trigger_time();
+		r.m_action = static_cast<uint32_t>(v.get_action());
+		r.m_pre_roll = v.get_pre_roll();
+		r.m_match = static_cast<uint32_t>(v.get_match());
+		r.m_priority = v.get_priority();
+		r.m_window = v.get_window();
+
+		std::memcpy(body.data() + i * sizeof(file_record), &r, sizeof(r));
+		pool += v.get_scene_name();
+	}
+
+	body.insert(body.end(), pool.begin(), pool.end());
+
+	file_header header{};
+	header.m_magic = MAGIC;
+	header.m_version = VERSION;
+	header.m_record_size = sizeof(file_record);
+	header.m_record_count = static_cast<uint32_t>(settings.size());
+	header.m_pool_size = static_cast<uint32_t>(pool.size());
+	header.m_revision = revision;
+	header.m_checksum = checksum(body.data(), body.size());
+
+	std::error_code error;
+	std::filesystem::create_directories(path.parent_path(), error);
+
+	auto temp_path = path;
+	temp_path += ".tmp";
+
+	{
+		std::ofstream stream{ temp_path, std::ios::binary | std::ios::trunc };
+		if (!stream)
+			return false;
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(reinterpret_cast<const char*>(body.data()), static_cast<std::streamsize>(body.size()));
+
+		if (!stream.flush())
+			return false;
+	}
+
+	std::filesystem::rename(temp_path, path, error);
+
+	return !error;
+}
+
+uint64_t binary_rule_store::checksum(const uint8_t* data, size_t size)
+{
+	//FNV-1a, good enough to catch truncated or partially written files
+	uint64_t hash = 0xCBF29CE484222325ull;
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= data[i];
+		hash *= 0x100000001B3ull;
+	}
+
+	return hash;
+}
+
+const binary_rule_store::file_record& binary_rule_store::record(size_t index) const
+{
+	return *reinterpret_cast<const file_record*>(m_records + index * sizeof(file_record));
+}
@@ -0,0 +1,101 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+#include "mapped_file.h"
+#include "recording_setting.h"
+
+//Versioned binary side file holding the rules of one scene collection.
+//Layout: header, fixed-size records, string pool. The file is memory mapped and only validated on open,
+//the getters read a record in place. Rules leave the mapping only through materialize(), which copies them out.
+class binary_rule_store
+{
+	public:
+		static constexpr uint32_t MAGIC = 0x42525353;	//"SSRB"
+		static constexpr uint16_t VERSION = 1;
+
+		binary_rule_store();
+
+	public:
+		bool open(const std::filesystem::path& path);
+		void close();
+
+		inline bool is_open() const { return m_header != nullptr; }
+
+		size_t size() const;
+		uint64_t get_revision() const;
+
+		source_key get_key(size_t index) const;
+		std::string_view get_name(size_t index) const;
+		recording_setting::action get_action(size_t index) const;
+		uint32_t get_trigger_time(size_t index) const;
+		uint32_t get_pre_roll(size_t index) const;
+		recording_setting::match get_match(size_t index) const;
+		int32_t get_priority(size_t index) const;
+		uint32_t get_window(size_t index) const;
+
+		//The result owns its names, it stays valid after the store is closed
+		recording_setting materialize(size_t index) const;
+		std::vector<recording_setting> materialize_all() const;
+
+		//Writes to a temporary file first and renames it over the old one
+		static bool write(const std::filesystem::path& path, const std::vector<recording_setting>& settings, uint64_t revision);
+
+	protected:
+
+	private:
+		struct file_header
+		{
+			uint32_t m_magic;
+			uint16_t m_version;
+			uint16_t m_record_size;
+			uint32_t m_record_count;
+			uint32_t m_pool_size;
+			uint64_t m_revision;
+			uint64_t m_checksum;
+		};
+
+		struct file_record
+		{
+			uint64_t m_key_high;
+			uint64_t m_key_low;
+			uint32_t m_name_offset;
+			uint32_t m_name_length;
+			uint32_t m_trigger_time;
+			uint32_t m_action;
+			uint32_t m_pre_roll;
+			uint32_t m_match;
+			int32_t m_priority;
+			uint32_t m_window;
+		};
+
+		static uint64_t checksum(const uint8_t* data, size_t size);
+
+		const file_record& record(size_t index) const;
+
+		mapped_file m_file;
+		const file_header* m_header;
+		const uint8_t* m_records;
+		const char* m_pool;
+};
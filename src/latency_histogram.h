@@ -0,0 +1,179 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//Log-linear latency histogram in the spirit of HdrHistogram.
+//Values below 64 get their own bucket, above that every power of two is split into 32 buckets (~3% relative error).
+//record() is wait-free: one relaxed increment, plus a CAS loop only when a new maximum shows up.
+class latency_histogram
+{
+	public:
+		struct summary
+		{
+			uint64_t m_count = 0;
+			uint64_t m_mean = 0;
+			uint64_t m_p50 = 0;
+			uint64_t m_p99 = 0;
+			uint64_t m_p999 = 0;
+			uint64_t m_max = 0;
+		};
+
+		latency_histogram()
+		{
+			reset();
+		}
+
+		//No copying
+		latency_histogram(const latency_histogram& other) = delete;
+		latency_histogram& operator = (const latency_histogram& other) = delete;
+
+	public:
+		void record(uint64_t value)
+		{
+			m_buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+			m_count.fetch_add(1, std::memory_order_relaxed);
+			m_sum.fetch_add(value, std::memory_order_relaxed);
+
+			auto max = m_max.load(std::memory_order_relaxed);
+			while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+			{ }
+		}
+
+		//Negative durations (e.g. a timer fired early) count as zero
+		template <typename Rep, typename Period>
+		void record(std::chrono::duration<Rep, Period> duration)
+		{
+			auto value = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+			record(static_cast<uint64_t>(value < 0 ? 0 : value));
+		}
+
+		//Readers may see a sample half recorded, good enough for statistics
+		summary get_summary() const
+		{
+			summary result;
+
+			std::array<uint64_t, BUCKET_COUNT> counts;
+			uint64_t total = 0;
+
+			for (size_t i = 0; i < BUCKET_COUNT; ++i)
+			{
+				counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+				total += counts[i];
+			}
+
+			if (!total)
+				return result;
+
+			result.m_count = total;
+			result.m_mean = m_sum.load(std::memory_order_relaxed) / std::max<uint64_t>(m_count.load(std::memory_order_relaxed), 1);
+			result.m_max = m_max.load(std::memory_order_relaxed);
+			result.m_p50 = percentile(counts, total, 500);
+			result.m_p99 = percentile(counts, total, 990);
+			result.m_p999 = percentile(counts, total, 999);
+
+			return result;
+		}
+
+		inline uint64_t get_count() const { return m_count.load(std::memory_order_relaxed); }
+		inline uint64_t get_mean() const { return m_sum.load(std::memory_order_relaxed) / std::max<uint64_t>(get_count(), 1); }
+
+		//Not atomic with respect to concurrent record() calls
+		void reset()
+		{
+			for (auto& v : m_buckets)
+				v.store(0, std::memory_order_relaxed);
+
+			m_count.store(0, std::memory_order_relaxed);
+			m_sum.store(0, std::memory_order_relaxed);
+			m_max.store(0, std::memory_order_relaxed);
+		}
+
+	protected:
+
+	private:
+		static constexpr int SUB_BUCKET_BITS = 5;
+		static constexpr uint64_t SUB_BUCKETS = uint64_t{ 1 } << SUB_BUCKET_BITS;
+		static constexpr uint64_t LINEAR_LIMIT = SUB_BUCKETS * 2;
+		static constexpr size_t BUCKET_COUNT = LINEAR_LIMIT + (64 - SUB_BUCKET_BITS - 1) * SUB_BUCKETS;
+
+		static inline int highest_bit(uint64_t value)
+		{
+#if defined(_MSC_VER)
+			unsigned long index;
+			_BitScanReverse64(&index, value);
+			return static_cast<int>(index);
+#else
+			return 63 - __builtin_clzll(value);
+#endif
+		}
+
+		static inline size_t bucket_index(uint64_t value)
+		{
+			if (value < LINEAR_LIMIT)
+				return static_cast<size_t>(value);
+
+			auto shift = highest_bit(value) - SUB_BUCKET_BITS;
+			auto mantissa = value >> shift;
+
+			return static_cast<size_t>(LINEAR_LIMIT + static_cast<uint64_t>(shift - 1) * SUB_BUCKETS + (mantissa - SUB_BUCKETS));
+		}
+
+		//Upper bound of the values a bucket stands for
+		static inline uint64_t bucket_value(size_t index)
+		{
+			if (index < LINEAR_LIMIT)
+				return index;
+
+			auto shift = static_cast<int>((index - LINEAR_LIMIT) / SUB_BUCKETS) + 1;
+			auto mantissa = (index - LINEAR_LIMIT) % SUB_BUCKETS + SUB_BUCKETS;
+
+			return ((mantissa + 1) << shift) - 1;
+		}
+
+		//permille: 500 = p50, 999 = p99.9
+		static uint64_t percentile(const std::array<uint64_t, BUCKET_COUNT>& counts, uint64_t total, uint64_t permille)
+		{
+			auto rank = (total * permille + 999) / 1000;
+			uint64_t seen = 0;
+
+			for (size_t i = 0; i < BUCKET_COUNT; ++i)
+			{
+				seen += counts[i];
+				if (seen >= rank && counts[i])
+					return bucket_value(i);
+			}
+
+			return bucket_value(BUCKET_COUNT - 1);
+		}
+
+		std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets;
+		std::atomic<uint64_t> m_count;
+		std::atomic<uint64_t> m_sum;
+		std::atomic<uint64_t> m_max;
+};
@@ -0,0 +1,57 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+//Read-only memory mapping of a whole file
+class mapped_file
+{
+	public:
+		mapped_file();
+		~mapped_file();
+
+		//No copying
+		mapped_file(const mapped_file& other) = delete;
+		mapped_file& operator = (const mapped_file& other) = delete;
+
+		mapped_file(mapped_file&& other) noexcept;
+		mapped_file& operator = (mapped_file&& other) noexcept;
+
+	public:
+		bool open(const std::filesystem::path& path);
+		void close();
+
+		inline bool is_open() const { return m_data != nullptr; }
+		inline const uint8_t* data() const { return m_data; }
+		inline size_t size() const { return m_size; }
+
+	protected:
+
+	private:
+		const uint8_t* m_data;
+		size_t m_size;
+
+#ifdef _WIN32
+		void* m_file;
+		void* m_mapping;
+#endif
+};
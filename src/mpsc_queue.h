@@ -0,0 +1,112 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+//Bounded lock-free ring after Dmitry Vyukov. Any number of threads may push, one thread pops.
+//Every cell carries a sequence number, so producers only contend on a single fetch/CAS of the tail.
+template <typename T, size_t CAPACITY>
+class mpsc_queue
+{
+	static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "capacity has to be a power of two");
+	static_assert(std::is_trivially_copyable_v<T>, "cells are overwritten without destruction");
+
+	public:
+		mpsc_queue()
+			: m_cells{ std::make_unique<cell[]>(CAPACITY) }
+			, m_enqueue_pos{ 0 }
+			, m_dequeue_pos{ 0 }
+		{
+			for (size_t i = 0; i < CAPACITY; ++i)
+				m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+		}
+
+		//No copying
+		mpsc_queue(const mpsc_queue& other) = delete;
+		mpsc_queue& operator = (const mpsc_queue& other) = delete;
+
+	public:
+		//Never blocks. Returns false if the ring is full.
+		bool try_push(const T& value)
+		{
+			auto pos = m_enqueue_pos.load(std::memory_order_relaxed);
+
+			while (true)
+			{
+				auto& c = m_cells[pos & (CAPACITY - 1)];
+				auto sequence = c.m_sequence.load(std::memory_order_acquire);
+				auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+
+				if (diff == 0)
+				{
+					if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						c.m_data = value;
+						c.m_sequence.store(pos + 1, std::memory_order_release);
+
+						return true;
+					}
+				}
+				else if (diff < 0)
+				{
+					return false;
+				}
+				else
+				{
+					pos = m_enqueue_pos.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		//Must only be called from the consumer thread
+		bool try_pop(T& value)
+		{
+			auto& c = m_cells[m_dequeue_pos & (CAPACITY - 1)];
+			auto sequence = c.m_sequence.load(std::memory_order_acquire);
+
+			if (static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(m_dequeue_pos + 1) < 0)
+				return false;
+
+			value = c.m_data;
+			c.m_sequence.store(m_dequeue_pos + CAPACITY, std::memory_order_release);
+			++m_dequeue_pos;
+
+			return true;
+		}
+
+		static constexpr size_t capacity() { return CAPACITY; }
+
+	protected:
+
+	private:
+		struct cell
+		{
+			std::atomic<size_t> m_sequence;
+			T m_data;
+		};
+
+		std::unique_ptr<cell[]> m_cells;
+
+		alignas(64) std::atomic<size_t> m_enqueue_pos;
+		alignas(64) size_t m_dequeue_pos;
+};
@@ -0,0 +1,153 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "plugin_config.h"
+
+#include <obs-module.h>
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "constants.h"
+
+constexpr std::string_view BINARY_RULE_STORE = "binary_rule_store";
+constexpr std::string_view RULE_CACHE_LIMIT = "rule_cache_limit";
+constexpr std::string_view PRE_ARM_RECORDING = "pre_arm_recording";
+constexpr std::string_view PRE_ARM_LEAD = "pre_arm_lead_ms";
+constexpr std::string_view REPLAY_BUFFER_BUDGET = "replay_buffer_budget_mb";
+constexpr std::string_view STOP_HYSTERESIS = "stop_hysteresis_ms";
+constexpr std::string_view SCENE_QUIET_WINDOW = "scene_quiet_window_ms";
+constexpr std::string_view SEGMENT_INDEX = "segment_index";
+constexpr std::string_view RECORDING_CHAPTERS = "recording_chapters";
+constexpr std::string_view AUDIO_GATE_THRESHOLD = "audio_gate_threshold_db";
+constexpr std::string_view AUDIO_GATE_ATTACK = "audio_gate_attack_ms";
+constexpr std::string_view AUDIO_GATE_HOLD = "audio_gate_hold_ms";
+constexpr std::string_view AUDIO_GATE_RELEASE = "audio_gate_release_ms";
+
+static std::string config_file_path()
+{
+	auto path = std::unique_ptr<char, std::function<void(char*)>>(obs_module_config_path(PLUGIN_FILENAME.data()), [](char* ptr) -> void {bfree(ptr); });
+
+	return path ? std::string{ path.get() } : std::string{};
+}
+
+plugin_config::plugin_config()
+	: m_binary_rule_store{ false }
+	, m_rule_cache_limit{ DEFAULT_RULE_CACHE_LIMIT }
+	, m_pre_arm_recording{ false }
+	, m_pre_arm_lead{ DEFAULT_PRE_ARM_LEAD }
+	, m_replay_buffer_budget{ DEFAULT_REPLAY_BUFFER_BUDGET }
+	, m_stop_hysteresis{ 0 }
+	, m_scene_quiet_window{ 0 }
+	, m_segment_index{ false }
+	, m_recording_chapters{ false }
+	, m_audio_gate_threshold{ DEFAULT_AUDIO_GATE_THRESHOLD }
+	, m_audio_gate_attack{ DEFAULT_AUDIO_GATE_ATTACK }
+	, m_audio_gate_hold{ DEFAULT_AUDIO_GATE_HOLD }
+	, m_audio_gate_release{ DEFAULT_AUDIO_GATE_RELEASE }
+{ }
+
+void plugin_config::load()
+{
+	auto path = config_file_path();
+	if (path.empty())
+		return;
+
+	auto data_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_data_create_from_json_file_safe(path.c_str(), "bak"), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
+	if (!data_ptr)
+		return;
+
+	auto data = data_ptr.get();
+	obs_data_set_default_bool(data, BINARY_RULE_STORE.data(), false);
+	obs_data_set_default_int(data, RULE_CACHE_LIMIT.data(), DEFAULT_RULE_CACHE_LIMIT);
+	obs_data_set_default_bool(data, PRE_ARM_RECORDING.data(), false);
+	obs_data_set_default_int(data, PRE_ARM_LEAD.data(), DEFAULT_PRE_ARM_LEAD);
+	obs_data_set_default_int(data, REPLAY_BUFFER_BUDGET.data(), DEFAULT_REPLAY_BUFFER_BUDGET);
+	obs_data_set_default_int(data, STOP_HYSTERESIS.data(), 0);
+	obs_data_set_default_int(data, SCENE_QUIET_WINDOW.data(), 0);
+	obs_data_set_default_bool(data, SEGMENT_INDEX.data(), false);
+	obs_data_set_default_bool(data, RECORDING_CHAPTERS.data(), false);
+	obs_data_set_default_int(data, AUDIO_GATE_THRESHOLD.data(), DEFAULT_AUDIO_GATE_THRESHOLD);
+	obs_data_set_default_int(data, AUDIO_GATE_ATTACK.data(), DEFAULT_AUDIO_GATE_ATTACK);
+	obs_data_set_default_int(data, AUDIO_GATE_HOLD.data(), DEFAULT_AUDIO_GATE_HOLD);
+	obs_data_set_default_int(data, AUDIO_GATE_RELEASE.data(), DEFAULT_AUDIO_GATE_RELEASE);
+
+	m_binary_rule_store = obs_data_get_bool(data, BINARY_RULE_STORE.data());
+	m_rule_cache_limit = static_cast<uint32_t>(obs_data_get_int(data, RULE_CACHE_LIMIT.data()));
+	m_pre_arm_recording = obs_data_get_bool(data, PRE_ARM_RECORDING.data());
+	m_pre_arm_lead = static_cast<uint32_t>(obs_data_get_int(data, PRE_ARM_LEAD.data()));
+	m_replay_buffer_budget = static_cast<uint32_t>(obs_data_get_int(data, REPLAY_BUFFER_BUDGET.data()));
+	m_stop_hysteresis = static_cast<uint32_t>(obs_data_get_int(data, STOP_HYSTERESIS.data()));
+	m_scene_quiet_window = static_cast<uint32_t>(obs_data_get_int(data, SCENE_QUIET_WINDOW.data()));
+	m_segment_index = obs_data_get_bool(data, SEGMENT_INDEX.data());
+	m_recording_chapters = obs_data_get_bool(data, RECORDING_CHAPTERS.data());
+	m_audio_gate_threshold = static_cast<int32_t>(obs_data_get_int(data, AUDIO_GATE_THRESHOLD.data()));
+	m_audio_gate_attack = static_cast<uint32_t>(obs_data_get_int(data, AUDIO_GATE_ATTACK.data()));
+	m_audio_gate_hold = static_cast<uint32_t>(obs_data_get_int(data, AUDIO_GATE_HOLD.data()));
+	m_audio_gate_release = static_cast<uint32_t>(obs_data_get_int(data, AUDIO_GATE_RELEASE.data()));
+}
+
+void plugin_config::save() const
+{
+	auto path = config_file_path();
+	if (path.empty())
+		return;
+
+	std::error_code error;
+	std::filesystem::create_directories(std::filesystem::u8path(path).parent_path(), error);
+
+	auto data_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_data_create(), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
+	auto data = data_ptr.get();
+
+	obs_data_set_bool(data, BINARY_RULE_STORE.data(), m_binary_rule_store);
+	obs_data_set_int(data, RULE_CACHE_LIMIT.data(), m_rule_cache_limit);
+	obs_data_set_bool(data, PRE_ARM_RECORDING.data(), m_pre_arm_recording);
+	obs_data_set_int(data, PRE_ARM_LEAD.data(), m_pre_arm_lead);
+	obs_data_set_int(data, REPLAY_BUFFER_BUDGET.data(), m_replay_buffer_budget);
+	obs_data_set_int(data, STOP_HYSTERESIS.data(), m_stop_hysteresis);
+	obs_data_set_int(data, SCENE_QUIET_WINDOW.data(), m_scene_quiet_window);
+	obs_data_set_bool(data, SEGMENT_INDEX.data(), m_segment_index);
+	obs_data_set_bool(data, RECORDING_CHAPTERS.data(), m_recording_chapters);
+	obs_data_set_int(data, AUDIO_GATE_THRESHOLD.data(), m_audio_gate_threshold);
+	obs_data_set_int(data, AUDIO_GATE_ATTACK.data(), m_audio_gate_attack);
+	obs_data_set_int(data, AUDIO_GATE_HOLD.data(), m_audio_gate_hold);
+	obs_data_set_int(data, AUDIO_GATE_RELEASE.data(), m_audio_gate_release);
+
+	obs_data_save_json_safe(data, path.c_str(), "tmp", "bak");
+}
+
+std::filesystem::path plugin_config::collection_file_path(const char* collection_name, std::string_view extension)
+{
+	std::string file_name = collection_name ? collection_name : "";
+
+	//Collection names are free text, keep the file name portable
+	for (auto& c : file_name)
+	{
+		if (c == '/' || c == '\\' || c == ':' || c == '*' || c == '?' || c == '"' || c == '<' || c == '>' || c == '|')
+			c = '_';
+	}
+
+	file_name += extension;
+
+	auto path = std::unique_ptr<char, std::function<void(char*)>>(obs_module_config_path(file_name.c_str()), [](char* ptr) -> void {bfree(ptr); });
+
+	return path ? std::filesystem::u8path(path.get()) : std::filesystem::path{};
+}
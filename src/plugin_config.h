@@ -0,0 +1,115 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+//Plugin wide options, stored as JSON in the module config directory (independent of the scene collection)
+class plugin_config
+{
+	public:
+		//MiB
+		static constexpr uint32_t DEFAULT_RULE_CACHE_LIMIT = 16;
+		//Milliseconds
+		static constexpr uint32_t DEFAULT_PRE_ARM_LEAD = 1500;
+		//MiB
+		static constexpr uint32_t DEFAULT_REPLAY_BUFFER_BUDGET = 512;
+		//dBFS
+		static constexpr int32_t DEFAULT_AUDIO_GATE_THRESHOLD = -40;
+		//Milliseconds
+		static constexpr uint32_t DEFAULT_AUDIO_GATE_ATTACK = 20;
+		static constexpr uint32_t DEFAULT_AUDIO_GATE_HOLD = 2000;
+		static constexpr uint32_t DEFAULT_AUDIO_GATE_RELEASE = 300;
+
+		plugin_config();
+
+	public:
+		void load();
+		void save() const;
+
+		inline void set_binary_rule_store(bool value) { m_binary_rule_store = value; }
+		inline bool get_binary_rule_store() const { return m_binary_rule_store; }
+
+		//Memory the snapshots of inactive scene collections may occupy, 0 disables the cache
+		inline void set_rule_cache_limit(uint32_t value) { m_rule_cache_limit = value; }
+		inline uint32_t get_rule_cache_limit() const { return m_rule_cache_limit; }
+
+		//Start delayed recordings ahead of time and keep them paused until the deadline
+		inline void set_pre_arm_recording(bool value) { m_pre_arm_recording = value; }
+		inline bool get_pre_arm_recording() const { return m_pre_arm_recording; }
+
+		inline void set_pre_arm_lead(uint32_t value) { m_pre_arm_lead = value; }
+		inline uint32_t get_pre_arm_lead() const { return m_pre_arm_lead; }
+
+		//Milliseconds a stop only pauses the recording, 0 stops right away
+		inline void set_stop_hysteresis(uint32_t value) { m_stop_hysteresis = value; }
+		inline uint32_t get_stop_hysteresis() const { return m_stop_hysteresis; }
+
+		//Milliseconds a scene change waits for the next one, bursts collapse into their last scene. 0 reacts right away.
+		inline void set_scene_quiet_window(uint32_t value) { m_scene_quiet_window = value; }
+		inline uint32_t get_scene_quiet_window() const { return m_scene_quiet_window; }
+
+		//Upper bound for the replay buffer while rules with a pre-roll keep it running
+		inline void set_replay_buffer_budget(uint32_t value) { m_replay_buffer_budget = value; }
+		inline uint32_t get_replay_buffer_budget() const { return m_replay_buffer_budget; }
+
+		//Scene index written next to each recording file, see segment_index
+		inline void set_segment_index(bool value) { m_segment_index = value; }
+		inline bool get_segment_index() const { return m_segment_index; }
+
+		//Chapter markers for every scene change, only hybrid MP4 recordings support them
+		inline void set_recording_chapters(bool value) { m_recording_chapters = value; }
+		inline bool get_recording_chapters() const { return m_recording_chapters; }
+
+		//Audio activity rules, see audio_gate. The gate opens at the threshold and closes 6 dB below it.
+		inline void set_audio_gate_threshold(int32_t value) { m_audio_gate_threshold = value; }
+		inline int32_t get_audio_gate_threshold() const { return m_audio_gate_threshold; }
+
+		inline void set_audio_gate_attack(uint32_t value) { m_audio_gate_attack = value; }
+		inline uint32_t get_audio_gate_attack() const { return m_audio_gate_attack; }
+
+		inline void set_audio_gate_hold(uint32_t value) { m_audio_gate_hold = value; }
+		inline uint32_t get_audio_gate_hold() const { return m_audio_gate_hold; }
+
+		inline void set_audio_gate_release(uint32_t value) { m_audio_gate_release = value; }
+		inline uint32_t get_audio_gate_release() const { return m_audio_gate_release; }
+
+		//Per scene collection files next to the config, e.g. "<collection>.rules"
+		static std::filesystem::path collection_file_path(const char* collection_name, std::string_view extension);
+
+	protected:
+
+	private:
+		std::atomic_bool m_binary_rule_store;
+		std::atomic<uint32_t> m_rule_cache_limit;
+		std::atomic_bool m_pre_arm_recording;
+		std::atomic<uint32_t> m_pre_arm_lead;
+		std::atomic<uint32_t> m_replay_buffer_budget;
+		std::atomic<uint32_t> m_stop_hysteresis;
+		std::atomic<uint32_t> m_scene_quiet_window;
+		std::atomic_bool m_segment_index;
+		std::atomic_bool m_recording_chapters;
+		std::atomic<int32_t> m_audio_gate_threshold;
+		std::atomic<uint32_t> m_audio_gate_attack;
+		std::atomic<uint32_t> m_audio_gate_hold;
+		std::atomic<uint32_t> m_audio_gate_release;
+};
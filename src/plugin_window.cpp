@@ -26,9 +26,11 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <QVariant>
 #include <QCloseEvent>
 #include <QMessageBox>
+#include <QLocale>
 
 #include <sstream>
 #include <memory>
+#include <iterator>
 
 #include <obs-module.h>
 
@@ -36,6 +38,58 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "record_edit_window.h"
 #include "smartstart_recording.h"
 
+//Scene rules show the scene, pattern rules the kind of pattern and the pattern itself
+static QString rule_text(const recording_setting& value)
+{
+	switch (value.get_match())
+	{
+		case recording_setting::match::wildcard:
+			return QString{ obs_module_text("match.wildcard") } + ": " + value.get_scene_name().c_str();
+
+		case recording_setting::match::regex:
+			return QString{ obs_module_text("match.regex") } + ": " + value.get_scene_name().c_str();
+
+		case recording_setting::match::tag:
+			return QString{ obs_module_text("match.tag") } + ": " + value.get_scene_name().c_str();
+
+		case recording_setting::match::sequence:
+			return QString{ obs_module_text("match.sequence") } + ": " + value.get_scene_name().c_str();
+
+		case recording_setting::match::dwell:
+			return QString{ obs_module_text("match.dwell") } + ": " + value.get_scene_name().c_str();
+
+		case recording_setting::match::nested:
+			return QString{ obs_module_text("match.nested") } + ": " + value.get_scene_name().c_str();
+
+		case recording_setting::match::activate:
+			return QString{ obs_module_text("match.activate") } + ": " + value.get_scene_name().c_str();
+
+		case recording_setting::match::deactivate:
+			return QString{ obs_module_text("match.deactivate") } + ": " + value.get_scene_name().c_str();
+
+		case recording_setting::match::audio:
+			return QString{ obs_module_text("match.audio") } + ": " + value.get_scene_name().c_str();
+
+		default:
+			return value.get_scene_name().c_str();
+	}
+}
+
+static const char* action_text(recording_setting::action value)
+{
+	switch (value)
+	{
+		case recording_setting::action::start:
+			return obs_module_text("start");
+
+		case recording_setting::action::split:
+			return obs_module_text("split");
+
+		default:
+			return obs_module_text("stop");
+	}
+}
+
 plugin_window::plugin_window(QWidget* parent, Qt::WindowFlags flags)
 	: QMainWindow{ parent, flags }
 	, m_table_widget{ 0, 3, this }
@@ -43,6 +97,10 @@ plugin_window::plugin_window(QWidget* parent, Qt::WindowFlags flags)
 	, m_edit_button{ this }
 	, m_delete_button{ this }
 	, m_dialog_button_box{ QDialogButtonBox::StandardButton::Save | QDialogButtonBox::Apply | QDialogButtonBox::StandardButton::Close, this  }
+	, m_tab_widget{ this }
+	, m_statistics_widget{ 6, 5, this }
+	, m_counter_label{ this }
+	, m_statistics_timer{ this }
 	, m_dirty{ false }
 {
 	setWindowTitle(PLUGIN_NAME.data());
@@ -99,8 +157,6 @@ plugin_window::plugin_window(QWidget* parent, Qt::WindowFlags flags)
 			
 					add_row(m_recording_setting_list.back());
 					set_dirty(true);
-
-					update_new_button();
 				};
 
 			edit_window->setAttribute(Qt::WA_DeleteOnClose);
@@ -122,8 +178,6 @@ plugin_window::plugin_window(QWidget* parent, Qt::WindowFlags flags)
 			m_table_widget.removeRow(row);
 
 			set_dirty(true);
-
-			m_new_button.setEnabled(true);
 		};
 
 	auto apply_button_click = [this]() -> void
@@ -160,7 +214,7 @@ plugin_window::plugin_window(QWidget* parent, Qt::WindowFlags flags)
 	connect(m_dialog_button_box.button(QDialogButtonBox::StandardButton::Apply), &QPushButton::pressed, apply_button_click);
 	connect(m_dialog_button_box.button(QDialogButtonBox::StandardButton::Close), &QPushButton::pressed, close_button_click);
 
-	update_new_button();
+	//Pattern rules can always be added, even when every scene has a rule of its own
 	m_new_button.setText(obs_module_text("button.new"));
 	m_new_button.setMinimumWidth(150);
 	m_edit_button.setText(obs_module_text("button.edit"));
@@ -197,7 +251,10 @@ plugin_window::plugin_window(QWidget* parent, Qt::WindowFlags flags)
 	group_box->setLayout(vbox);
 	group_box->setFlat(true);
 
-	setCentralWidget(group_box);
+	m_tab_widget.addTab(group_box, obs_module_text("tab.rules"));
+	m_tab_widget.addTab(create_statistics_tab(), obs_module_text("tab.statistics"));
+
+	setCentralWidget(&m_tab_widget);
 }
 
 void plugin_window::closeEvent(QCloseEvent* event)
@@ -248,8 +305,8 @@ void plugin_window::edit_item(int row)
 			{
 				item = edit_window->get_recording_setting().value();
 
-				m_table_widget.item(row, 0)->setText(item.get_scene_name().c_str());
-				m_table_widget.item(row, 1)->setText(item.get_action() == recording_setting::action::start ? obs_module_text("start") : obs_module_text("stop"));
+				m_table_widget.item(row, 0)->setText(rule_text(item));
+				m_table_widget.item(row, 1)->setText(action_text(item.get_action()));
 				m_table_widget.item(row, 2)->setText(std::to_string(item.get_trigger_time()).c_str());
 
 				set_dirty(true);
@@ -268,11 +325,11 @@ void plugin_window::add_row(const recording_setting& rec_setting)
 	m_table_widget.insertRow(i);
 
 	auto data = reinterpret_cast<std::uintptr_t>(&rec_setting);
-	auto scene_name_item = new QTableWidgetItem(rec_setting.get_scene_name().c_str());
+	auto scene_name_item = new QTableWidgetItem(rule_text(rec_setting));
 	scene_name_item->setData(Qt::UserRole, QVariant::fromValue(data));
 	m_table_widget.setItem(i, 0, scene_name_item);
 
-	auto action_item = new QTableWidgetItem(rec_setting.get_action() == recording_setting::action::start ? obs_module_text("start") : obs_module_text("stop"));
+	auto action_item = new QTableWidgetItem(action_text(rec_setting.get_action()));
 	action_item->setTextAlignment(Qt::AlignCenter);
 	m_table_widget.setItem(i, 1, action_item);
 
@@ -306,29 +363,83 @@ bool plugin_window::get_dirty() const
 	return m_dirty;
 }
 
-void plugin_window::update_new_button()
+QWidget* plugin_window::create_statistics_tab()
 {
-	auto scene_list = std::unique_ptr<char*, std::function<void(char**)>>(obs_frontend_get_scene_names(), [](char** ptr)->void { bfree(ptr); });
-	m_new_button.setEnabled(false);
+	auto group_box = new QGroupBox{ this };
+	group_box->setTitle(obs_module_text("statistics.title"));
+	group_box->setFlat(true);
 
-	for (size_t i = 0; scene_list.get()[i]; ++i)
-	{
-		auto item = scene_list.get()[i];
+	m_statistics_widget.setHorizontalHeaderLabels(QStringList() << obs_module_text("statistics.count") << obs_module_text("statistics.p50") << obs_module_text("statistics.p99") << obs_module_text("statistics.p999") << obs_module_text("statistics.max"));
+	m_statistics_widget.setVerticalHeaderLabels(QStringList() << obs_module_text("statistics.decision") << obs_module_text("statistics.timer_slip") << obs_module_text("statistics.start_confirmation") << obs_module_text("statistics.stop_confirmation") << obs_module_text("statistics.deadline_to_live") << obs_module_text("statistics.split"));
+	m_statistics_widget.horizontalHeader()->setHighlightSections(false);
+	m_statistics_widget.horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+	m_statistics_widget.verticalHeader()->setHighlightSections(false);
+	m_statistics_widget.setSelectionMode(QAbstractItemView::NoSelection);
+	m_statistics_widget.setEditTriggers(QAbstractItemView::NoEditTriggers);
+	m_statistics_widget.setFocusPolicy(Qt::FocusPolicy::NoFocus);
 
-		bool item_found = false;
-		for (auto& v : m_recording_setting_list)
+	for (int row = 0; row < m_statistics_widget.rowCount(); ++row)
+	{
+		for (int column = 0; column < m_statistics_widget.columnCount(); ++column)
 		{
-			if (item == v.get_scene_name())
-			{
-				item_found = true;
-				break;
-			}
+			auto item = new QTableWidgetItem{};
+			item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+			m_statistics_widget.setItem(row, column, item);
 		}
+	}
+
+	m_counter_label.setWordWrap(true);
 
-		if (!item_found)
+	auto hint = new QLabel{ obs_module_text("statistics.hint"), this };
+	hint->setWordWrap(true);
+
+	auto vbox = new QVBoxLayout{ this };
+	vbox->addWidget(&m_statistics_widget);
+	vbox->addWidget(&m_counter_label);
+	vbox->addWidget(hint);
+	group_box->setLayout(vbox);
+
+	//The histograms are read without locking, refreshing them once a second costs next to nothing
+	connect(&m_statistics_timer, &QTimer::timeout, [this]() -> void
 		{
-			m_new_button.setEnabled(true);
-			return;
-		}
+			update_statistics();
+		});
+
+	update_statistics();
+	m_statistics_timer.start(1000);
+
+	return group_box;
+}
+
+void plugin_window::update_statistics()
+{
+	auto& controller = smartstart_recording::get().get_recording_controller();
+	auto statistics = controller.get_latency_statistics();
+	const latency_histogram::summary* rows[] = { &statistics.m_decision, &statistics.m_timer_slip, &statistics.m_start_confirmation, &statistics.m_stop_confirmation, &statistics.m_deadline_to_live, &statistics.m_split };
+
+	auto to_ms = [](uint64_t ns) -> QString
+		{
+			return QLocale{}.toString(static_cast<double>(ns) / 1e6, 'f', 3);
+		};
+
+	for (int row = 0; row < static_cast<int>(std::size(rows)); ++row)
+	{
+		auto& summary = *rows[row];
+
+		m_statistics_widget.item(row, 0)->setText(QLocale{}.toString(static_cast<qulonglong>(summary.m_count)));
+		m_statistics_widget.item(row, 1)->setText(summary.m_count ? to_ms(summary.m_p50) : "-");
+		m_statistics_widget.item(row, 2)->setText(summary.m_count ? to_ms(summary.m_p99) : "-");
+		m_statistics_widget.item(row, 3)->setText(summary.m_count ? to_ms(summary.m_p999) : "-");
+		m_statistics_widget.item(row, 4)->setText(summary.m_count ? to_ms(summary.m_max) : "-");
 	}
-}
\ No newline at end of file
+
+	m_counter_label.setText(QString{ obs_module_text("statistics.counters") }
+		.arg(static_cast<qulonglong>(controller.get_avoided_restarts()))
+		.arg(QLocale{}.toString(static_cast<double>(controller.get_saved_setup_time()) / 1e9, 'f', 1))
+		.arg(static_cast<qulonglong>(controller.get_promoted_stops()))
+		.arg(static_cast<qulonglong>(controller.get_pre_armed_starts()))
+		.arg(static_cast<qulonglong>(controller.get_back_fills()))
+		.arg(static_cast<qulonglong>(controller.get_splits()))
+		.arg(static_cast<qulonglong>(controller.get_coalesced_splits()))
+		.arg(static_cast<qulonglong>(controller.get_coalesced_scene_requests())));
+}
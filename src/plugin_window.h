@@ -21,6 +21,9 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <QMainWindow>
 #include <QPushButton>
 #include <QTableWidget>
+#include <QTabWidget>
+#include <QTimer>
+#include <QLabel>
 #include <QDialogButtonBox>
 
 #include <list>
@@ -42,13 +45,18 @@ class plugin_window : public QMainWindow
 		void save();
 		void set_dirty(bool value);
 		bool get_dirty() const;
-		void update_new_button();
+		QWidget* create_statistics_tab();
+		void update_statistics();
 
 		QTableWidget m_table_widget;
 		QPushButton m_new_button;
 		QPushButton m_edit_button;
 		QPushButton m_delete_button;
 		QDialogButtonBox m_dialog_button_box;
+		QTabWidget m_tab_widget;
+		QTableWidget m_statistics_widget;
+		QLabel m_counter_label;
+		QTimer m_statistics_timer;
 
 		std::list<recording_setting> m_recording_setting_list;
 
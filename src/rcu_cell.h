@@ -0,0 +1,161 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+//Read-copy-update cell. Readers pin the current value with two atomic increments and never lock.
+//Writers are serialized, swap in a new immutable value and free the old one after a grace period
+//(sleepable RCU style: two reader counters, the writer flips between them and waits for the old side to drain).
+template <typename T>
+class rcu_cell
+{
+	public:
+		class read_guard
+		{
+			public:
+				~read_guard()
+				{
+					if (m_owner)
+						m_owner->m_readers[m_side].m_count.fetch_sub(1);
+				}
+
+				read_guard(read_guard&& other) noexcept
+					: m_owner{ other.m_owner }
+					, m_value{ other.m_value }
+					, m_side{ other.m_side }
+				{
+					other.m_owner = nullptr;
+				}
+
+				//No copying
+				read_guard(const read_guard& other) = delete;
+				read_guard& operator = (const read_guard& other) = delete;
+				read_guard& operator = (read_guard&& other) = delete;
+
+			public:
+				inline const T* get() const { return m_value; }
+				inline const T* operator->() const { return m_value; }
+				inline const T& operator*() const { return *m_value; }
+
+			private:
+				friend class rcu_cell;
+
+				read_guard(const rcu_cell* owner, const T* value, uint32_t side)
+					: m_owner{ owner }
+					, m_value{ value }
+					, m_side{ side }
+				{ }
+
+				const rcu_cell* m_owner;
+				const T* m_value;
+				uint32_t m_side;
+		};
+
+		explicit rcu_cell(std::unique_ptr<const T> initial)
+			: m_current{ initial.release() }
+			, m_epoch{ 0 }
+		{ }
+
+		~rcu_cell()
+		{
+			delete m_current.load();
+		}
+
+		//No copying
+		rcu_cell(const rcu_cell& other) = delete;
+		rcu_cell& operator = (const rcu_cell& other) = delete;
+
+	public:
+		//The guard must not outlive the cell. Keep it short, writers wait for it.
+		read_guard read() const
+		{
+			auto side = static_cast<uint32_t>(m_epoch.load() & 1);
+			m_readers[side].m_count.fetch_add(1);
+
+			//Sequentially consistent with the writer's exchange: either we see the new value or the writer sees our count
+			return read_guard{ this, m_current.load(), side };
+		}
+
+		void publish(std::unique_ptr<const T> value)
+		{
+			std::unique_lock lock{ m_writer_mutex };
+			replace(std::move(value));
+		}
+
+		//Like publish, but hands the old value back once no reader can see it anymore
+		std::unique_ptr<const T> exchange(std::unique_ptr<const T> value)
+		{
+			std::unique_lock lock{ m_writer_mutex };
+
+			auto old_value = m_current.exchange(value.release());
+			synchronize();
+
+			return std::unique_ptr<const T>{ old_value };
+		}
+
+		//Builds the next value from the current one. Concurrent writers are applied one after another.
+		template <typename F>
+		void update(F&& make_next)
+		{
+			std::unique_lock lock{ m_writer_mutex };
+
+			std::unique_ptr<const T> next = make_next(*m_current.load());
+			if (next)
+				replace(std::move(next));
+		}
+
+	protected:
+
+	private:
+		struct alignas(64) reader_count
+		{
+			std::atomic<uint64_t> m_count{ 0 };
+		};
+
+		void replace(std::unique_ptr<const T> value)
+		{
+			auto old_value = m_current.exchange(value.release());
+
+			synchronize();
+			delete old_value;
+		}
+
+		//Flipping twice covers readers which sampled the epoch right before the first flip
+		void synchronize()
+		{
+			for (int i = 0; i < 2; ++i)
+			{
+				auto side = m_epoch.fetch_add(1) & 1;
+
+				while (m_readers[side].m_count.load() != 0)
+					std::this_thread::yield();
+			}
+		}
+
+		std::atomic<const T*> m_current;
+		std::atomic<uint64_t> m_epoch;
+		mutable reader_count m_readers[2];
+
+		std::mutex m_writer_mutex;
+};
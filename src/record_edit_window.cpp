@@ -30,9 +30,16 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <obs-frontend-api.h>
 
 #include <sstream>
+#include <unordered_set>
+#include <utility>
+
+#include "scene_pattern_set.h"
+#include "scene_sequence_set.h"
+#include "smartstart_recording.h"
 
 record_edit_window::record_edit_window(const std::list<recording_setting>& match_list, QWidget* parent, Qt::WindowFlags flags)
 	: QDialog(parent, flags)
+	, m_ok_button{ nullptr }
 	, m_match_list{ &match_list }
 {
 	setWindowTitle(obs_module_text("add_recording_setting"));
@@ -40,55 +47,190 @@ record_edit_window::record_edit_window(const std::list<recording_setting>& match
 	auto grid_layout = new QGridLayout(this);
 	grid_layout->setColumnMinimumWidth(0, 300);
 
+	auto match_select_layout = new QHBoxLayout(this);
 	auto scene_select_layout = new QHBoxLayout(this);
 	auto action_select_layout = new QHBoxLayout(this);
 	auto timing_select_layout = new QHBoxLayout(this);
+	auto pre_roll_select_layout = new QHBoxLayout(this);
+	auto priority_select_layout = new QHBoxLayout(this);
+	auto window_select_layout = new QHBoxLayout(this);
 	auto spacer_layout = new QHBoxLayout(this);
 	auto button_layout = new QHBoxLayout(this);
 
 	auto dialog_button_box = new QDialogButtonBox(QDialogButtonBox::StandardButton::Ok | QDialogButtonBox::StandardButton::Cancel, this);
-
+	m_ok_button = dialog_button_box->button(QDialogButtonBox::StandardButton::Ok);
+
+	m_match_combobox.addItem(obs_module_text("match.scene"), static_cast<std::underlying_type_t<recording_setting::match>>(recording_setting::match::scene));
+	m_match_combobox.addItem(obs_module_text("match.nested"), static_cast<std::underlying_type_t<recording_setting::match>>(recording_setting::match::nested));
+	m_match_combobox.addItem(obs_module_text("match.wildcard"), static_cast<std::underlying_type_t<recording_setting::match>>(recording_setting::match::wildcard));
+	m_match_combobox.addItem(obs_module_text("match.regex"), static_cast<std::underlying_type_t<recording_setting::match>>(recording_setting::match::regex));
+	m_match_combobox.addItem(obs_module_text("match.tag"), static_cast<std::underlying_type_t<recording_setting::match>>(recording_setting::match::tag));
+	m_match_combobox.addItem(obs_module_text("match.sequence"), static_cast<std::underlying_type_t<recording_setting::match>>(recording_setting::match::sequence));
+	m_match_combobox.addItem(obs_module_text("match.dwell"), static_cast<std::underlying_type_t<recording_setting::match>>(recording_setting::match::dwell));
+	m_match_combobox.addItem(obs_module_text("match.activate"), static_cast<std::underlying_type_t<recording_setting::match>>(recording_setting::match::activate));
+	m_match_combobox.addItem(obs_module_text("match.deactivate"), static_cast<std::underlying_type_t<recording_setting::match>>(recording_setting::match::deactivate));
+	m_match_combobox.addItem(obs_module_text("match.audio"), static_cast<std::underlying_type_t<recording_setting::match>>(recording_setting::match::audio));
+	m_match_combobox.setMinimumWidth(300);
+
+	m_scene_label.setText(obs_module_text("recording_edit_window.scene_label"));
 	m_scene_names_combo_box.setMinimumWidth(300);
 
+	m_source_names_combo_box.setMinimumWidth(300);
+	m_source_names_combo_box.setVisible(false);
+
+	m_pattern_line_edit.setMinimumWidth(300);
+	m_pattern_line_edit.setToolTip(obs_module_text("recording_edit_window.pattern_tooltip"));
+	m_pattern_line_edit.setVisible(false);
+
 	m_record_action_combobox.addItem(obs_module_text("start"), static_cast<std::underlying_type_t<recording_setting::action>>(recording_setting::action::start));
 	m_record_action_combobox.addItem(obs_module_text("stop"), static_cast<std::underlying_type_t<recording_setting::action>>(recording_setting::action::stop));
+	m_record_action_combobox.addItem(obs_module_text("split"), static_cast<std::underlying_type_t<recording_setting::action>>(recording_setting::action::split));
 	m_record_action_combobox.setMinimumWidth(300);
 
 	m_timing_spin_box.setMinimum(0);
 	m_timing_spin_box.setMaximum(1000000);
 
-	scene_select_layout->addWidget(new QLabel(obs_module_text("recording_edit_window.scene_label"), this));
+	//Seconds, the replay buffer has to hold this much
+	m_pre_roll_spin_box.setMinimum(0);
+	m_pre_roll_spin_box.setMaximum(600);
+	m_pre_roll_spin_box.setToolTip(obs_module_text("recording_edit_window.pre_roll_tooltip"));
+
+	//Only decides between patterns, a scene's own rule always wins
+	m_priority_spin_box.setMinimum(-1000);
+	m_priority_spin_box.setMaximum(1000);
+	m_priority_spin_box.setToolTip(obs_module_text("recording_edit_window.priority_tooltip"));
+	m_priority_spin_box.setEnabled(false);
+
+	//Milliseconds a sequence has to complete in, or a dwell rule's scene has to stay on air
+	m_window_spin_box.setMinimum(0);
+	m_window_spin_box.setMaximum(3600000);
+	m_window_spin_box.setToolTip(obs_module_text("recording_edit_window.window_tooltip"));
+	m_window_spin_box.setEnabled(false);
+
+	match_select_layout->addWidget(new QLabel(obs_module_text("recording_edit_window.match_label"), this));
+	match_select_layout->addWidget(&m_match_combobox);
+	grid_layout->addLayout(match_select_layout, 0, 0);
+
+	scene_select_layout->addWidget(&m_scene_label);
 	scene_select_layout->addWidget(&m_scene_names_combo_box);
-	grid_layout->addLayout(scene_select_layout, 0, 0);
+	scene_select_layout->addWidget(&m_source_names_combo_box);
+	scene_select_layout->addWidget(&m_pattern_line_edit);
+	grid_layout->addLayout(scene_select_layout, 1, 0);
 
 	action_select_layout->addWidget(new QLabel(obs_module_text("recording_edit_window.action_label"), this));
 	action_select_layout->addWidget(&m_record_action_combobox);
-	grid_layout->addLayout(action_select_layout, 1, 0);
+	grid_layout->addLayout(action_select_layout, 2, 0);
 
 	timing_select_layout->addWidget(new QLabel(obs_module_text("recording_edit_window.timing_label"), this));
 	timing_select_layout->addWidget(&m_timing_spin_box);
-	grid_layout->addLayout(timing_select_layout, 2, 0);
+	grid_layout->addLayout(timing_select_layout, 3, 0);
+
+	pre_roll_select_layout->addWidget(new QLabel(obs_module_text("recording_edit_window.pre_roll_label"), this));
+	pre_roll_select_layout->addWidget(&m_pre_roll_spin_box);
+	grid_layout->addLayout(pre_roll_select_layout, 4, 0);
+
+	priority_select_layout->addWidget(new QLabel(obs_module_text("recording_edit_window.priority_label"), this));
+	priority_select_layout->addWidget(&m_priority_spin_box);
+	grid_layout->addLayout(priority_select_layout, 5, 0);
+
+	window_select_layout->addWidget(new QLabel(obs_module_text("recording_edit_window.window_label"), this));
+	window_select_layout->addWidget(&m_window_spin_box);
+	grid_layout->addLayout(window_select_layout, 6, 0);
 	
 	auto spacer_line = new QFrame(this);
 	spacer_line->setFrameShape(QFrame::HLine);
 	spacer_line->setFrameShadow(QFrame::Sunken);
 	spacer_layout->addWidget(spacer_line);
-	grid_layout->addLayout(spacer_layout, 3, 0);
+	grid_layout->addLayout(spacer_layout, 7, 0);
 
 	button_layout->addWidget(dialog_button_box);
-	grid_layout->addLayout(button_layout, 4, 0);
+	grid_layout->addLayout(button_layout, 8, 0);
+
+	//Patterns are typed in, a scene (on air or nested) or a source is picked from the ones without a rule
+	auto match_changed = [this](int index) -> void
+		{
+			(void)index;	//unused parameter
+			auto match = static_cast<recording_setting::match>(m_match_combobox.currentData().toInt());
+			auto source = match == recording_setting::match::activate || match == recording_setting::match::deactivate || match == recording_setting::match::audio;
+			auto pattern = match != recording_setting::match::scene && match != recording_setting::match::nested && !source;
+
+			m_scene_label.setText(obs_module_text(pattern ? "recording_edit_window.pattern_label" : (source ? "recording_edit_window.source_label" : "recording_edit_window.scene_label")));
+			m_scene_names_combo_box.setVisible(!pattern && !source);
+			m_source_names_combo_box.setVisible(source);
+			m_pattern_line_edit.setVisible(pattern);
+			m_priority_spin_box.setEnabled(pattern);
+			m_window_spin_box.setEnabled(match == recording_setting::match::sequence || match == recording_setting::match::dwell);
+
+			update_ok_button();
+		};
+
+	connect(&m_match_combobox, &QComboBox::currentIndexChanged, match_changed);
+
+	//Only a start has anything to back-fill
+	auto record_action_changed = [this](int index) -> void
+		{
+			(void)index;	//unused parameter
+			m_pre_roll_spin_box.setEnabled(static_cast<recording_setting::action>(m_record_action_combobox.currentData().toInt()) == recording_setting::action::start);
+		};
+
+	connect(&m_record_action_combobox, &QComboBox::currentIndexChanged, record_action_changed);
 
 	auto save_button_click = [this]() -> void
 		{
 			auto& rec = m_recording_setting.value();
 
-			auto scene_name = m_scene_names_combo_box.itemText(m_scene_names_combo_box.currentIndex());
+			auto match = static_cast<recording_setting::match>(m_match_combobox.currentData().toInt());
 			auto recording_action = static_cast<recording_setting::action>(m_record_action_combobox.currentData().toInt());
 			auto timing = m_timing_spin_box.value();
 
-			rec.set_scene_name(scene_name.toStdString());
+			if (match == recording_setting::match::scene || match == recording_setting::match::nested)
+			{
+				auto scene_name = m_scene_names_combo_box.itemText(m_scene_names_combo_box.currentIndex());
+				auto scene_uuid = m_scene_names_combo_box.currentData().toString();
+
+				rec.set_scene_name(scene_name.toStdString());
+				rec.set_scene_key(source_key::from_uuid(scene_uuid.toStdString()));
+				rec.set_priority(0);
+				rec.set_window(0);
+			}
+			else if (match == recording_setting::match::activate || match == recording_setting::match::deactivate || match == recording_setting::match::audio)
+			{
+				rec.set_scene_name(m_source_names_combo_box.itemText(m_source_names_combo_box.currentIndex()).toStdString());
+				rec.set_scene_key(source_key::from_uuid(m_source_names_combo_box.currentData().toString().toStdString()));
+				rec.set_priority(0);
+				rec.set_window(0);
+			}
+			else
+			{
+				recording_setting pattern{ rec };
+				pattern.set_match(match);
+				pattern.set_scene_name(m_pattern_line_edit.text().trimmed().toStdString());
+
+				pattern.set_window(static_cast<uint32_t>(m_window_spin_box.value()));
+
+				if (!(pattern.is_sequence() ? scene_sequence_set::valid(pattern) : scene_pattern_set::valid(pattern)))
+				{
+					QMessageBox::warning(this, obs_module_text("recording_edit_window.invalid_pattern_title"), obs_module_text("recording_edit_window.invalid_pattern"));
+					return;
+				}
+
+				//Still allowed, but every scene change pays for it
+				if (!pattern.is_sequence() && !scene_pattern_set::anchored(pattern))
+					QMessageBox::information(this, obs_module_text("recording_edit_window.unanchored_pattern_title"), obs_module_text("recording_edit_window.unanchored_pattern"));
+
+				//A scene rule turned into a pattern gives the scene's key back
+				if (!rec.is_pattern() || !rec.get_scene_key().valid())
+					rec.set_scene_key(source_key::generate());
+
+				rec.set_scene_name(pattern.get_scene_name());
+				rec.set_priority(m_priority_spin_box.value());
+				rec.set_window(pattern.is_sequence() ? pattern.get_window() : 0);
+			}
+
+			rec.set_match(match);
 			rec.set_action(recording_action);
 			rec.set_trigger_time(timing);
+			rec.set_pre_roll(recording_action == recording_setting::action::start ? static_cast<uint32_t>(m_pre_roll_spin_box.value()) : 0);
 
 			accept();
 		};
@@ -98,7 +240,7 @@ record_edit_window::record_edit_window(const std::list<recording_setting>& match
 			reject();
 		};
 
-	connect(dialog_button_box->button(QDialogButtonBox::StandardButton::Ok), &QPushButton::pressed, save_button_click);
+	connect(m_ok_button, &QPushButton::pressed, save_button_click);
 	connect(dialog_button_box->button(QDialogButtonBox::StandardButton::Cancel), &QPushButton::pressed, close_button_click);
 	
 	setLayout(grid_layout);
@@ -109,38 +251,75 @@ void record_edit_window::showEvent(QShowEvent* ev)
 {
 	QDialog::showEvent(ev);
 
-	auto scene_list = std::unique_ptr<char*, std::function<void(char**)>>(obs_frontend_get_scene_names(), [](char** ptr)->void { bfree(ptr); });
-	for (size_t i = 0; scene_list.get()[i]; ++i)
-	{
-		auto item = scene_list.get()[i];
+	std::vector<source_key> taken;
+	for (auto& v : *m_match_list)
+		taken.push_back(v.get_scene_key());
 
-		bool item_found = false;
-		for (auto& v : *m_match_list)
+	for (const auto& v : smartstart_recording::get().get_scene_catalog().get_scenes_without_rule(taken))
+		m_scene_names_combo_box.addItem(v.second.c_str(), QString{ v.first.to_string().c_str() });
+
+	//The catalog only follows scenes, the sources are listed once when the window opens
+	std::unordered_set<source_key, source_key_hash> taken_set{ taken.begin(), taken.end() };
+	std::pair<record_edit_window*, const std::unordered_set<source_key, source_key_hash>*> source_param{ this, &taken_set };
+	obs_enum_sources([](void* param, obs_source_t* source) -> bool
 		{
-			if (item == v.get_scene_name())
-			{
-				item_found = true;
-				continue;
-			}
-		}
+			auto value = static_cast<std::pair<record_edit_window*, const std::unordered_set<source_key, source_key_hash>*>*>(param);
+			auto key = source_key::from_source(source);
 
-		if (!item_found)
-			m_scene_names_combo_box.addItem(item);
-	}
+			if (key.valid() && !value->second->count(key))
+				value->first->m_source_names_combo_box.addItem(obs_source_get_name(source), QString{ key.to_string().c_str() });
+
+			return true;
+		}, &source_param);
 
 	if (!m_recording_setting)
 	{
 		m_recording_setting = recording_setting{};
+
+		//Nothing left to bind to a scene, only a pattern can be added
+		if (!m_scene_names_combo_box.count())
+			m_match_combobox.setCurrentIndex(m_match_combobox.findData(static_cast<std::underlying_type_t<recording_setting::match>>(recording_setting::match::wildcard)));
+
+		update_ok_button();
 		return;
 	}
 
 	const auto& rec = m_recording_setting.value();
-	m_scene_names_combo_box.addItem(rec.get_scene_name().c_str());
+	if (rec.is_source())
+		m_source_names_combo_box.addItem(rec.get_scene_name().c_str(), QString{ rec.get_scene_key().to_string().c_str() });
+	else if (!rec.is_pattern())
+		m_scene_names_combo_box.addItem(rec.get_scene_name().c_str(), QString{ rec.get_scene_key().to_string().c_str() });
 	
 
 	setWindowTitle(obs_module_text("edit_recording_setting"));
 
-	m_scene_names_combo_box.setCurrentText(rec.get_scene_name().c_str());
+	m_match_combobox.setCurrentIndex(m_match_combobox.findData(static_cast<std::underlying_type_t<recording_setting::match>>(rec.get_match())));
+
+	if (rec.is_pattern())
+		m_pattern_line_edit.setText(rec.get_scene_name().c_str());
+	else if (rec.is_source())
+		m_source_names_combo_box.setCurrentText(rec.get_scene_name().c_str());
+	else
+		m_scene_names_combo_box.setCurrentText(rec.get_scene_name().c_str());
+
 	m_record_action_combobox.setCurrentIndex(m_record_action_combobox.findData(static_cast<std::underlying_type_t<recording_setting::action>>(rec.get_action())));
 	m_timing_spin_box.setValue(static_cast<int>(rec.get_trigger_time()));
+	m_pre_roll_spin_box.setValue(static_cast<int>(rec.get_pre_roll()));
+	m_priority_spin_box.setValue(static_cast<int>(rec.get_priority()));
+	m_window_spin_box.setValue(static_cast<int>(rec.get_window()));
+
+	update_ok_button();
+}
+
+void record_edit_window::update_ok_button()
+{
+	auto match = static_cast<recording_setting::match>(m_match_combobox.currentData().toInt());
+
+	bool enabled = true;
+	if (match == recording_setting::match::scene || match == recording_setting::match::nested)
+		enabled = m_scene_names_combo_box.currentIndex() >= 0;
+	else if (match == recording_setting::match::activate || match == recording_setting::match::deactivate || match == recording_setting::match::audio)
+		enabled = m_source_names_combo_box.currentIndex() >= 0;
+
+	m_ok_button->setEnabled(enabled);
 }
\ No newline at end of file
@@ -20,12 +20,16 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 #include <QDialog>
 #include <QComboBox>
+#include <QLabel>
+#include <QLineEdit>
 #include <QSpinBox>
 
 #include <optional>
 
 #include "recording_setting.h"
 
+class QPushButton;
+
 class record_edit_window : public QDialog
 {
 public:
@@ -37,9 +41,20 @@ public:
 protected:
 	virtual void showEvent(QShowEvent* ev) override;
 private:
+	//Scene and source rules need something picked, once every scene or source has a rule there is nothing to save
+	void update_ok_button();
+
+	QPushButton* m_ok_button;
+	QComboBox m_match_combobox{ this };
+	QLabel m_scene_label{ this };
 	QComboBox m_scene_names_combo_box{ this };
+	QComboBox m_source_names_combo_box{ this };
+	QLineEdit m_pattern_line_edit{ this };
 	QComboBox m_record_action_combobox{ this };
 	QSpinBox m_timing_spin_box{ this };
+	QSpinBox m_pre_roll_spin_box{ this };
+	QSpinBox m_priority_spin_box{ this };
+	QSpinBox m_window_spin_box{ this };
 
 	std::optional<recording_setting> m_recording_setting;
 
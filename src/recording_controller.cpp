@@ -18,124 +18,996 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 #include "recording_controller.h"
 
-#include <obs-frontend-api.h>
 #include <obs-module.h> 
 
+#include <utility>
+
+#include "constants.h"
+#include "span_tracer.h"
+
 recording_controller::recording_controller()
-	: m_thread{ &recording_controller::work, this }
-	, m_pending_state{ state::stopped }
-	, m_state_change_time{ std::chrono::milliseconds{0} }
-	, m_exit{ false }
-	, m_start_requested{ false }
-	, m_cancel{ false }
-	, m_state_change_pending{ false }
+	: recording_controller{ options{} }
 { }
 
+recording_controller::recording_controller(options opts)
+	: m_frontend{ opts.m_frontend }
+	, m_manual_clock{ opts.m_manual_clock }
+	, m_on_decision{ std::move(opts.m_on_decision) }
+	, m_timing_wheel{ m_manual_clock ? m_manual_clock->now() : clock::now() }
+	, m_pre_arm_timer_action{ INVALID_ACTION }
+	, m_pre_arm_action{ INVALID_ACTION }
+	, m_pre_arm_phase{ pre_arm_phase::none }
+	, m_pre_arm_live{ false }
+	, m_back_fill_pre_roll{ 0 }
+	, m_hold_phase{ hold_phase::none }
+	, m_hold_resume{ false }
+	, m_scene_action{ INVALID_ACTION }
+	, m_logged_samples{ 0 }
+	, m_state{ state::stopped }
+	, m_next_sequence{ INVALID_ACTION + 1 }
+	, m_exit{ false }
+	, m_dequeued_count{ 0 }
+	, m_total_latency{ 0 }
+	, m_max_latency{ 0 }
+	, m_dropped_count{ 0 }
+	, m_suppressed_count{ 0 }
+	, m_pre_armed_count{ 0 }
+	, m_pre_arm_fallback_count{ 0 }
+	, m_pre_arm_lead{ 0 }
+	, m_back_fill_count{ 0 }
+	, m_missed_back_fill_count{ 0 }
+	, m_stop_hysteresis{ 0 }
+	, m_avoided_restart_count{ 0 }
+	, m_promoted_stop_count{ 0 }
+	, m_saved_setup_time{ 0 }
+	, m_split_count{ 0 }
+	, m_coalesced_split_count{ 0 }
+	, m_quiet_window{ 0 }
+	, m_coalesced_scene_count{ 0 }
+	, m_thread{}
+{
+	//Replays drive the controller themselves and have nothing to report to the log
+	if (m_manual_clock)
+		return;
+
+	auto deadline = now() + STATISTICS_LOG_INTERVAL;
+	m_timing_wheel.schedule(deadline, pending_action{ timer_type::statistics, INVALID_ACTION, state::stopped, deadline });
+
+	m_thread = std::thread{ &recording_controller::work, this };
+}
+
 recording_controller::~recording_controller()
 {
 	m_exit = true;
-	m_begin_task.notify_all();
-	m_wait_task.notify_all();
+	m_wake_worker.notify();
+
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+recording_controller::action_id recording_controller::start_recording(std::chrono::milliseconds time, const void* origin_scene, clock::time_point trigger_time, uint32_t pre_roll)
+{
+	if (trigger_time == clock::time_point{})
+		trigger_time = now();
+
+	return schedule(state::started, trigger_time + time, origin_scene, trigger_time, pre_roll);
+}
+
+recording_controller::action_id recording_controller::stop_recording(std::chrono::milliseconds time, const void* origin_scene, clock::time_point trigger_time)
+{
+	if (trigger_time == clock::time_point{})
+		trigger_time = now();
+
+	return schedule(state::stopped, trigger_time + time, origin_scene, trigger_time);
+}
+
+recording_controller::action_id recording_controller::split_recording(std::chrono::milliseconds time, const void* origin_scene, clock::time_point trigger_time)
+{
+	if (trigger_time == clock::time_point{})
+		trigger_time = now();
+
+	return push_command(command{ command_type::schedule, state::started, INVALID_ACTION, INVALID_ACTION, trigger_time + time, clock::time_point{}, trigger_time, origin_scene, 0, true });
+}
+
+recording_controller::action_id recording_controller::request_scene_action(state target_state, bool split, std::chrono::milliseconds time, const void* origin_scene, clock::time_point trigger_time, uint32_t pre_roll)
+{
+	if (trigger_time == clock::time_point{})
+		trigger_time = now();
+
+	return push_command(command{ command_type::scene_request, target_state, INVALID_ACTION, INVALID_ACTION, trigger_time + time, clock::time_point{}, trigger_time, origin_scene, pre_roll, split });
+}
+
+recording_controller::action_id recording_controller::schedule(state target_state, clock::time_point deadline, const void* origin_scene, clock::time_point trigger_time, uint32_t pre_roll)
+{
+	return push_command(command{ command_type::schedule, target_state, INVALID_ACTION, INVALID_ACTION, deadline, clock::time_point{}, trigger_time, origin_scene, pre_roll, false });
+}
+
+void recording_controller::cancel_scene_action()
+{
+	push_command(command{ command_type::scene_cancel, state::stopped, INVALID_ACTION, INVALID_ACTION, clock::time_point{}, clock::time_point{}, clock::time_point{}, nullptr, 0, false });
 }
 
-void recording_controller::start_recording(std::chrono::milliseconds time)
+void recording_controller::cancel(action_id id)
 {
-	//abort if the new state is going to be stopped
-	abort();
+	if (id == INVALID_ACTION)
+		return;
+
+	push_command(command{ command_type::cancel, state::stopped, INVALID_ACTION, id, clock::time_point{}, clock::time_point{}, clock::time_point{}, nullptr, 0, false });
+}
 
-	if (time == std::chrono::milliseconds{ 0 })
+void recording_controller::on_recording_state_changed(state new_state)
+{
+	m_state.store(new_state, std::memory_order_relaxed);
+
+	//Let the worker release anything that waited for the transition to finish
+	push_command(command{ command_type::state_changed, new_state, INVALID_ACTION, INVALID_ACTION, clock::time_point{}, clock::time_point{}, clock::time_point{}, nullptr, 0, false });
+}
+
+void recording_controller::synchronize_state()
+{
+	auto new_state = state::stopped;
+
+	if (m_frontend.m_recording_paused())
+		new_state = state::paused;
+	else if (m_frontend.m_recording_active())
+		new_state = state::started;
+
+	on_recording_state_changed(new_state);
+}
+
+void recording_controller::on_split_confirmed()
+{
+	push_command(command{ command_type::split_confirmed, state::started, INVALID_ACTION, INVALID_ACTION, clock::time_point{}, clock::time_point{}, clock::time_point{}, nullptr, 0, false });
+}
+
+recording_controller::queue_statistics recording_controller::get_queue_statistics() const
+{
+	queue_statistics result;
+
+	result.m_count = m_dequeued_count.load(std::memory_order_relaxed);
+	result.m_total_latency = m_total_latency.load(std::memory_order_relaxed);
+	result.m_max_latency = m_max_latency.load(std::memory_order_relaxed);
+	result.m_dropped = m_dropped_count.load(std::memory_order_relaxed);
+
+	return result;
+}
+
+recording_controller::latency_statistics recording_controller::get_latency_statistics() const
+{
+	latency_statistics result;
+
+	result.m_decision = m_decision_latency.get_summary();
+	result.m_timer_slip = m_timer_slip.get_summary();
+	result.m_start_confirmation = m_start_confirmation_latency.get_summary();
+	result.m_stop_confirmation = m_stop_confirmation_latency.get_summary();
+	result.m_deadline_to_live = m_deadline_to_live.get_summary();
+	result.m_split = m_split_latency.get_summary();
+
+	return result;
+}
+
+recording_controller::action_id recording_controller::push_command(command cmd)
+{
+	cmd.m_sequence = m_next_sequence.fetch_add(1, std::memory_order_relaxed);
+	cmd.m_enqueue_time = now();
+
+	if (cmd.m_trigger_time == clock::time_point{})
+		cmd.m_trigger_time = cmd.m_enqueue_time;
+
+	if (cmd.m_type == command_type::schedule || cmd.m_type == command_type::scene_request)
+		cmd.m_target = cmd.m_sequence;
+
+	if (!m_commands.try_push(cmd))
 	{
-		std::unique_lock lock{ m_state_mutex };
-		obs_frontend_recording_start();
+		m_dropped_count.fetch_add(1, std::memory_order_relaxed);
+		blog(LOG_WARNING, "[%s] command queue full, dropping command %llu", PLUGIN_NAME_SHORT.data(), static_cast<unsigned long long>(cmd.m_sequence));
+
+		return INVALID_ACTION;
+	}
+
+	m_wake_worker.notify();
+
+	return cmd.m_target;
+}
+
+void recording_controller::apply_command(const command& cmd, clock::time_point now)
+{
+	switch (cmd.m_type)
+	{
+		case command_type::schedule:
+		{
+			m_decision_latency.record(now - cmd.m_trigger_time);
+			schedule_action(cmd, now);
+		}
+		break;
+
+		case command_type::cancel:
+		{
+			cancel_action(cmd.m_target);
+		}
+		break;
+
+		case command_type::scene_request:
+		{
+			m_decision_latency.record(now - cmd.m_trigger_time);
+
+			auto window = std::chrono::milliseconds{ m_quiet_window.load(std::memory_order_relaxed) };
+			if (window.count() <= 0)
+				return submit_scene_request(cmd, now);
+
+			//The scene changed again before the window ran out, only the newest request survives the burst.
+			//The first request of a burst already voids whatever the scene before it had scheduled.
+			if (m_scene_request)
+				m_coalesced_scene_count.fetch_add(1, std::memory_order_relaxed);
+			else
+				cancel_action(std::exchange(m_scene_action, INVALID_ACTION));
+
+			m_scene_request = cmd;
+
+			auto deadline = now + window;
+			m_timing_wheel.cancel(m_quiet_timer);
+			m_quiet_timer = m_timing_wheel.schedule(deadline, pending_action{ timer_type::quiet_window, INVALID_ACTION, cmd.m_target_state, deadline });
+		}
+		break;
+
+		case command_type::scene_cancel:
+		{
+			m_timing_wheel.cancel(m_quiet_timer);
+			m_quiet_timer = {};
+			m_scene_request.reset();
+
+			cancel_action(std::exchange(m_scene_action, INVALID_ACTION));
+		}
+		break;
+
+		case command_type::state_changed:
+		{
+			if (cmd.m_target_state == state::starting || cmd.m_target_state == state::stopping)
+				return;
+
+			//The event was queued the moment OBS reported it, that is the time that counts
+			confirm_transition(cmd.m_target_state, cmd.m_enqueue_time);
+
+			if (cmd.m_target_state == state::started && m_live_deadline)
+				m_deadline_to_live.record(cmd.m_enqueue_time - *m_live_deadline);
+
+			if (cmd.m_target_state == state::started && m_back_fill_pre_roll)
+				back_fill();
+
+			if (cmd.m_target_state != state::started)
+			{
+				m_live_deadline.reset();
+				m_back_fill_pre_roll = 0;
+			}
+
+			//The next recording starts with a file of its own
+			if (cmd.m_target_state == state::stopped)
+			{
+				m_split_begin.reset();
+				m_last_split.reset();
+			}
+
+			advance_pre_arm(cmd.m_target_state);
+			advance_hold(cmd.m_target_state);
+
+			m_timing_wheel.cancel(m_state_watchdog);
+			m_state_watchdog = {};
+
+			run_deferred();
+		}
+		break;
+
+		case command_type::split_confirmed:
+		{
+			//Splits triggered by hand or by the output's own size and time limits are none of our business
+			if (!m_split_begin)
+				return;
+
+			m_split_latency.record(cmd.m_enqueue_time - *m_split_begin);
+			m_split_begin.reset();
+		}
+		break;
+	}
+}
+
+void recording_controller::schedule_action(const command& cmd, clock::time_point now)
+{
+	auto handle = m_timing_wheel.schedule(cmd.m_deadline, pending_action{ cmd.m_split ? timer_type::split : timer_type::action, cmd.m_target, cmd.m_target_state, cmd.m_deadline, cmd.m_pre_roll });
+	m_pending_actions[cmd.m_target] = handle;
+
+	if (cmd.m_target_state == state::started && !cmd.m_split)
+		schedule_pre_arm(cmd.m_target, cmd.m_deadline, now);
+}
+
+void recording_controller::cancel_action(action_id id)
+{
+	if (id == INVALID_ACTION)
+		return;
+
+	if (id == m_pre_arm_timer_action || id == m_pre_arm_action)
+		abort_pre_arm();
+
+	auto it = m_pending_actions.find(id);
+	if (it == m_pending_actions.end())
+		return;
+
+	m_timing_wheel.cancel(it->second);
+	m_pending_actions.erase(it);
+}
+
+void recording_controller::submit_scene_request(const command& cmd, clock::time_point now)
+{
+	//A new scene rule replaces whatever the previous scene rule had queued
+	cancel_action(std::exchange(m_scene_action, INVALID_ACTION));
+
+	if (!cmd.m_split && is_redundant(cmd.m_target_state))
+	{
+		m_coalesced_scene_count.fetch_add(1, std::memory_order_relaxed);
+		report(decision::coalesced, cmd.m_target_state);
+		return;
+	}
+
+	schedule_action(cmd, now);
+	m_scene_action = cmd.m_target;
+}
+
+bool recording_controller::is_redundant(state target_state) const
+{
+	//Anything still pending may change the state before this request would fire, then it is not redundant
+	if (!m_pending_actions.empty() || m_deferred_state || m_hold_phase != hold_phase::none || m_pre_arm_phase != pre_arm_phase::none)
+		return false;
+
+	auto current_state = m_state.load(std::memory_order_relaxed);
+
+	if (target_state == state::started)
+		return current_state == state::started || current_state == state::starting;
+
+	return current_state == state::stopped || current_state == state::stopping;
+}
+
+void recording_controller::execute(state target_state)
+{
+	//The newest request always wins over one that waited for a transition
+	m_deferred_state.reset();
+
+	auto current_state = m_state.load(std::memory_order_relaxed);
+
+	if (target_state == state::started)
+	{
+		//The recording already exists, the deadline only makes it live
+		if (m_pre_arm_phase != pre_arm_phase::none)
+			return go_live();
+
+		if (m_hold_phase != hold_phase::none)
+			return resume();
+
+		switch (current_state)
+		{
+			case state::stopped:
+			{
+				if (!begin_transition(current_state, state::starting))
+					return execute(target_state);
+
+				report(decision::start, target_state);
+				m_transition_begin = now();
+
+				span_tracer::scope span{ "obs_frontend_recording_start" };
+				m_frontend.m_start_recording();
+			}
+			break;
+
+			case state::stopping:
+			{
+				//Starting now would race the stop, OBS would simply ignore it
+				m_deferred_state = target_state;
+				report(decision::deferred, target_state);
+			}
+			break;
+
+			default:
+			{
+				m_live_deadline.reset();
+				m_back_fill_pre_roll = 0;
+				m_suppressed_count.fetch_add(1, std::memory_order_relaxed);
+				report(decision::suppressed, target_state);
+			}
+			break;
+		}
 
 		return;
 	}
 
-	if (get_current_state() != state::started)
+	//A stop wins over a pre-armed start, whatever was started early is simply stopped
+	m_pre_arm_phase = pre_arm_phase::none;
+	m_pre_arm_action = INVALID_ACTION;
+
+	//A held recording counts as stopped until the hold runs out
+	if (m_hold_phase != hold_phase::none)
 	{
-		m_start_requested = true;
-		m_state_change_time = time;
-		m_pending_state = state::started;
-		m_begin_task.notify_all();
+		m_suppressed_count.fetch_add(1, std::memory_order_relaxed);
+		report(decision::suppressed, target_state);
+		return;
 	}
+
+	switch (current_state)
+	{
+		case state::started:
+		case state::paused:
+		{
+			if (current_state == state::started && hold())
+			{
+				report(decision::stop, target_state);
+				return;
+			}
+
+			if (!begin_transition(current_state, state::stopping))
+				return execute(target_state);
+
+			report(decision::stop, target_state);
+			m_transition_begin = now();
+
+			span_tracer::scope span{ "obs_frontend_recording_stop" };
+			m_frontend.m_stop_recording();
+		}
+		break;
+
+		case state::starting:
+		{
+			m_deferred_state = target_state;
+			report(decision::deferred, target_state);
+		}
+		break;
+
+		default:
+		{
+			m_suppressed_count.fetch_add(1, std::memory_order_relaxed);
+			report(decision::suppressed, target_state);
+		}
+		break;
+	}
+}
+
+bool recording_controller::begin_transition(state expected, state transitional)
+{
+	//The frontend events may move the state underneath us, in that case the caller decides again
+	if (!m_state.compare_exchange_strong(expected, transitional, std::memory_order_relaxed))
+		return false;
+
+	//If the frontend never confirms (e.g. the output failed to start) we must not stay in the transitional state forever
+	m_timing_wheel.cancel(m_state_watchdog);
+	auto deadline = now() + STATE_CONFIRM_TIMEOUT;
+	m_state_watchdog = m_timing_wheel.schedule(deadline, pending_action{ timer_type::state_watchdog, INVALID_ACTION, transitional, deadline });
+
+	return true;
+}
+
+void recording_controller::confirm_transition(state new_state, clock::time_point time)
+{
+	if (!m_transition_begin)
+		return;
+
+	if (new_state == state::started)
+		m_start_confirmation_latency.record(time - *m_transition_begin);
+	else if (new_state == state::stopped)
+		m_stop_confirmation_latency.record(time - *m_transition_begin);
+
+	m_transition_begin.reset();
 }
 
-void recording_controller::stop_recording(std::chrono::milliseconds time)
+void recording_controller::schedule_pre_arm(action_id id, clock::time_point deadline, clock::time_point now)
 {
-	//abort if the new state is going to be started
-	abort();
+	auto lead = std::chrono::milliseconds{ m_pre_arm_lead.load(std::memory_order_relaxed) };
+	if (lead.count() <= 0 || deadline - now < MIN_PRE_ARM_WINDOW)
+		return;
+
+	//Only the newest start is pre-armed, the dispatcher cancels older scene actions anyway
+	m_timing_wheel.cancel(m_pre_arm_timer);
+
+	auto arm_time = std::max(now, deadline - lead);
+	m_pre_arm_timer = m_timing_wheel.schedule(arm_time, pending_action{ timer_type::pre_arm, id, state::started, arm_time });
+	m_pre_arm_timer_action = id;
+}
 
-	//We dont need our thread to work if the state change is wanted immediatley
-	if (time == std::chrono::milliseconds{ 0 })
+void recording_controller::pre_arm(action_id id)
+{
+	if (m_pre_arm_phase != pre_arm_phase::none || m_deferred_state || m_state.load(std::memory_order_relaxed) != state::stopped)
+		return;
+
+	//Without pause support the deadline starts the recording as if pre-arming was off
+	if (!m_frontend.m_recording_can_pause())
 	{
-		std::unique_lock lock{ m_state_mutex };
-		obs_frontend_recording_stop();
+		m_pre_arm_fallback_count.fetch_add(1, std::memory_order_relaxed);
+		blog(LOG_INFO, "[%s] the recording output cannot pause, starting at the deadline instead", PLUGIN_NAME_SHORT.data());
+		return;
+	}
 
+	if (!begin_transition(state::stopped, state::starting))
 		return;
+
+	m_pre_arm_phase = pre_arm_phase::starting;
+	m_pre_arm_action = id;
+	m_pre_arm_live = false;
+	m_pre_armed_count.fetch_add(1, std::memory_order_relaxed);
+
+	m_transition_begin = now();
+
+	span_tracer::scope span{ "obs_frontend_recording_start" };
+	m_frontend.m_start_recording();
+}
+
+void recording_controller::abort_pre_arm()
+{
+	m_timing_wheel.cancel(m_pre_arm_timer);
+	m_pre_arm_timer = {};
+	m_pre_arm_timer_action = INVALID_ACTION;
+	m_pre_arm_action = INVALID_ACTION;
+
+	switch (m_pre_arm_phase)
+	{
+		case pre_arm_phase::starting:
+		{
+			//OBS ignores a stop while it is still starting, the stop follows the confirmation
+			m_pre_arm_phase = pre_arm_phase::aborting;
+		}
+		break;
+
+		case pre_arm_phase::pausing:
+		case pre_arm_phase::armed:
+		{
+			m_pre_arm_phase = pre_arm_phase::none;
+			stop_running();
+		}
+		break;
+
+		default:
+		{
+
+		}
+		break;
 	}
+}
 
-	if (get_current_state() != state::stopped)
+void recording_controller::advance_pre_arm(state new_state)
+{
+	switch (m_pre_arm_phase)
 	{
-		m_start_requested = true;
-		m_state_change_time = time;
-		m_pending_state = state::stopped;
-		m_begin_task.notify_all();
+		case pre_arm_phase::starting:
+		{
+			if (new_state != state::started || m_pre_arm_live)
+			{
+				//Either the start failed or the deadline already passed and the recording stays live
+				m_pre_arm_phase = pre_arm_phase::none;
+				return;
+			}
+
+			m_pre_arm_phase = pre_arm_phase::pausing;
+
+			span_tracer::scope span{ "obs_frontend_recording_pause" };
+			m_frontend.m_pause_recording(true);
+		}
+		break;
+
+		case pre_arm_phase::pausing:
+		{
+			if (new_state != state::paused)
+			{
+				m_pre_arm_phase = pre_arm_phase::none;
+				return;
+			}
+
+			if (!m_pre_arm_live)
+			{
+				m_pre_arm_phase = pre_arm_phase::armed;
+				return;
+			}
+
+			//The deadline passed while OBS was pausing
+			m_pre_arm_phase = pre_arm_phase::none;
+
+			span_tracer::scope span{ "obs_frontend_recording_unpause" };
+			m_frontend.m_pause_recording(false);
+		}
+		break;
+
+		case pre_arm_phase::aborting:
+		{
+			m_pre_arm_phase = pre_arm_phase::none;
+
+			if (new_state == state::started)
+				stop_running();
+		}
+		break;
+
+		case pre_arm_phase::armed:
+		{
+			//Someone unpaused or stopped the recording by hand, it is no longer ours to flip
+			if (new_state != state::paused)
+				m_pre_arm_phase = pre_arm_phase::none;
+		}
+		break;
+
+		default:
+		{
+
+		}
+		break;
+	}
+}
+
+void recording_controller::go_live()
+{
+	report(decision::start, state::started);
+
+	m_pre_arm_action = INVALID_ACTION;
+
+	switch (m_pre_arm_phase)
+	{
+		case pre_arm_phase::armed:
+		{
+			m_pre_arm_phase = pre_arm_phase::none;
+
+			span_tracer::scope span{ "obs_frontend_recording_unpause" };
+			m_frontend.m_pause_recording(false);
+		}
+		break;
+
+		case pre_arm_phase::aborting:
+		{
+			//A new start arrived before the cancelled one was stopped, keep the recording
+			m_pre_arm_phase = pre_arm_phase::starting;
+			m_pre_arm_live = true;
+		}
+		break;
+
+		default:
+		{
+			//Still starting or pausing, the confirmation takes it live
+			m_pre_arm_live = true;
+		}
+		break;
 	}
 }
 
-void recording_controller::abort()
+void recording_controller::stop_running()
 {
-	if (!m_state_change_pending)
+	auto current_state = m_state.load(std::memory_order_relaxed);
+	if (current_state != state::started && current_state != state::paused)
 		return;
 
-	m_cancel = true;
-	m_wait_task.notify_one();
+	if (!begin_transition(current_state, state::stopping))
+		return stop_running();
+
+	m_transition_begin = now();
+
+	span_tracer::scope span{ "obs_frontend_recording_stop" };
+	m_frontend.m_stop_recording();
 }
 
-recording_controller::state recording_controller::get_current_state()
+void recording_controller::back_fill()
 {
-	std::unique_lock lock{ m_state_mutex };
-	
-	if (obs_frontend_recording_active())
-		return state::started;
+	m_back_fill_pre_roll = 0;
+
+	//Saved right when the recording went live, the clip ends where the recording begins
+	if (!m_frontend.m_replay_buffer_active())
+	{
+		m_missed_back_fill_count.fetch_add(1, std::memory_order_relaxed);
+		blog(LOG_WARNING, "[%s] the replay buffer is not running, the pre-roll of this start is lost", PLUGIN_NAME_SHORT.data());
+		return;
+	}
 
-	if (obs_frontend_recording_paused())
-		return state::paused;
+	m_back_fill_count.fetch_add(1, std::memory_order_relaxed);
 
-	return state::stopped;
+	span_tracer::scope span{ "obs_frontend_replay_buffer_save" };
+	m_frontend.m_save_replay_buffer();
 }
 
-void recording_controller::work()
+bool recording_controller::hold()
 {
-	while (true)
+	auto window = std::chrono::milliseconds{ m_stop_hysteresis.load(std::memory_order_relaxed) };
+	if (window.count() <= 0 || !m_frontend.m_recording_can_pause())
+		return false;
+
+	m_hold_phase = hold_phase::pausing;
+	m_hold_resume = false;
+
+	auto deadline = now() + window;
+	m_timing_wheel.cancel(m_hold_timer);
+	m_hold_timer = m_timing_wheel.schedule(deadline, pending_action{ timer_type::hold_expired, INVALID_ACTION, state::stopped, deadline });
+
+	span_tracer::scope span{ "obs_frontend_recording_pause" };
+	m_frontend.m_pause_recording(true);
+
+	return true;
+}
+
+void recording_controller::resume()
+{
+	m_timing_wheel.cancel(m_hold_timer);
+	m_hold_timer = {};
+
+	report(decision::start, state::started);
+
+	//What a stop followed by a start would have cost us
+	m_avoided_restart_count.fetch_add(1, std::memory_order_relaxed);
+	m_saved_setup_time.fetch_add(m_start_confirmation_latency.get_mean() + m_stop_confirmation_latency.get_mean(), std::memory_order_relaxed);
+
+	if (m_hold_phase == hold_phase::pausing)
 	{
-		std::unique_lock<std::mutex> lock{ m_task_mutex };
-		m_begin_task.wait(lock, [this]() -> bool {return m_start_requested.exchange(false) || m_exit; });
+		//Unpausing before OBS confirmed the pause would be lost, the confirmation takes care of it
+		m_hold_resume = true;
+		return;
+	}
 
-		if (m_exit)
-			break;
+	m_hold_phase = hold_phase::none;
 
-		std::unique_lock<std::mutex> wait_lock{ m_wait_mutex };
-		m_state_change_pending = true;
-		m_wait_task.wait_for(wait_lock, m_state_change_time.load(), [this]() -> bool {return m_cancel || m_exit; });
+	span_tracer::scope span{ "obs_frontend_recording_unpause" };
+	m_frontend.m_pause_recording(false);
+}
 
-		if (m_exit)
-			break;
+void recording_controller::advance_hold(state new_state)
+{
+	switch (m_hold_phase)
+	{
+		case hold_phase::pausing:
+		{
+			if (new_state == state::paused)
+			{
+				if (!m_hold_resume)
+				{
+					m_hold_phase = hold_phase::held;
+					return;
+				}
 
-		if (m_cancel.exchange(false))
+				m_hold_phase = hold_phase::none;
+
+				span_tracer::scope span{ "obs_frontend_recording_unpause" };
+				m_frontend.m_pause_recording(false);
+				return;
+			}
+
+			//Stopped underneath us, nothing left to hold
+			if (new_state == state::stopped)
+			{
+				m_timing_wheel.cancel(m_hold_timer);
+				m_hold_timer = {};
+				m_hold_phase = hold_phase::none;
+			}
+		}
+		break;
+
+		case hold_phase::held:
 		{
-			m_state_change_pending = false;
-			continue;
+			//Someone unpaused or stopped the recording by hand, it is no longer ours to stop
+			if (new_state != state::paused)
+			{
+				m_timing_wheel.cancel(m_hold_timer);
+				m_hold_timer = {};
+				m_hold_phase = hold_phase::none;
+			}
 		}
+		break;
 
+		default:
 		{
-			std::unique_lock lock{ m_state_mutex };
-			if (m_pending_state == state::started)
-				obs_frontend_recording_start();
-			else
-				obs_frontend_recording_stop();
+
+		}
+		break;
+	}
+}
+
+void recording_controller::split()
+{
+	//Only a running recording has a file to split, a held or pre-armed recording counts as stopped
+	if (m_state.load(std::memory_order_relaxed) != state::started || m_hold_phase != hold_phase::none || m_pre_arm_phase != pre_arm_phase::none)
+	{
+		m_suppressed_count.fetch_add(1, std::memory_order_relaxed);
+		report(decision::suppressed, state::started);
+		return;
+	}
+
+	//Only our own requests count here, so replays coalesce exactly like the live plugin
+	auto split_time = now();
+	if (m_last_split && split_time - *m_last_split < SPLIT_COALESCE_WINDOW)
+	{
+		m_coalesced_split_count.fetch_add(1, std::memory_order_relaxed);
+		report(decision::coalesced, state::started);
+		return;
+	}
+
+	report(decision::split, state::started);
+	m_last_split = split_time;
+
+	span_tracer::scope span{ "obs_frontend_recording_split_file" };
+	if (!m_frontend.m_split_recording())
+	{
+		blog(LOG_WARNING, "[%s] the recording output cannot split the file, the recording continues in the current one", PLUGIN_NAME_SHORT.data());
+		return;
+	}
+
+	m_split_count.fetch_add(1, std::memory_order_relaxed);
+	m_split_begin = split_time;
+}
+
+void recording_controller::log_latency_statistics()
+{
+	auto samples = m_decision_latency.get_count() + m_timer_slip.get_count() + m_start_confirmation_latency.get_count() + m_stop_confirmation_latency.get_count() + m_deadline_to_live.get_count() + m_split_latency.get_count();
+	if (samples == m_logged_samples)
+		return;
+
+	m_logged_samples = samples;
+
+	auto log_summary = [](const char* name, const latency_histogram::summary& summary) -> void
+		{
+			if (!summary.m_count)
+				return;
+
+			blog(LOG_INFO, "[%s] %s: count %llu, p50 %.3f ms, p99 %.3f ms, p99.9 %.3f ms, max %.3f ms", PLUGIN_NAME_SHORT.data(), name,
+				static_cast<unsigned long long>(summary.m_count), summary.m_p50 / 1e6, summary.m_p99 / 1e6, summary.m_p999 / 1e6, summary.m_max / 1e6);
+		};
+
+	auto statistics = get_latency_statistics();
+	log_summary("transition to decision", statistics.m_decision);
+	log_summary("timer slip", statistics.m_timer_slip);
+	log_summary("recording start confirmation", statistics.m_start_confirmation);
+	log_summary("recording stop confirmation", statistics.m_stop_confirmation);
+	log_summary("start deadline to live recording", statistics.m_deadline_to_live);
+	log_summary("split request to new file", statistics.m_split);
+
+	if (m_avoided_restart_count.load(std::memory_order_relaxed) || m_promoted_stop_count.load(std::memory_order_relaxed))
+		blog(LOG_INFO, "[%s] avoided restarts: %llu (about %.1f s of setup saved), held stops which ran out: %llu", PLUGIN_NAME_SHORT.data(), static_cast<unsigned long long>(m_avoided_restart_count.load(std::memory_order_relaxed)),
+			static_cast<double>(m_saved_setup_time.load(std::memory_order_relaxed)) / 1e9, static_cast<unsigned long long>(m_promoted_stop_count.load(std::memory_order_relaxed)));
+
+	if (m_coalesced_scene_count.load(std::memory_order_relaxed))
+		blog(LOG_INFO, "[%s] coalesced scene requests: %llu", PLUGIN_NAME_SHORT.data(), static_cast<unsigned long long>(m_coalesced_scene_count.load(std::memory_order_relaxed)));
+
+	if (m_split_count.load(std::memory_order_relaxed) || m_coalesced_split_count.load(std::memory_order_relaxed))
+		blog(LOG_INFO, "[%s] file splits: %llu, coalesced: %llu", PLUGIN_NAME_SHORT.data(), static_cast<unsigned long long>(m_split_count.load(std::memory_order_relaxed)), static_cast<unsigned long long>(m_coalesced_split_count.load(std::memory_order_relaxed)));
+
+	if (m_pre_armed_count.load(std::memory_order_relaxed))
+		blog(LOG_INFO, "[%s] pre-armed starts: %llu, fallbacks: %llu", PLUGIN_NAME_SHORT.data(), static_cast<unsigned long long>(m_pre_armed_count.load(std::memory_order_relaxed)), static_cast<unsigned long long>(m_pre_arm_fallback_count.load(std::memory_order_relaxed)));
+}
+
+void recording_controller::run_deferred()
+{
+	if (!m_deferred_state)
+		return;
+
+	auto target_state = *m_deferred_state;
+	execute(target_state);
+}
+
+std::optional<recording_controller::clock::time_point> recording_controller::process(clock::time_point now)
+{
+	span_tracer::scope span{ "recording_controller::process" };
+
+	//Timers may queue commands of their own (e.g. the watchdog), those are applied in the same round
+	bool busy = true;
+	while (busy)
+	{
+		busy = false;
+
+		command cmd;
+		while (m_commands.try_pop(cmd))
+		{
+			auto latency = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - cmd.m_enqueue_time).count());
+
+			m_dequeued_count.fetch_add(1, std::memory_order_relaxed);
+			m_total_latency.fetch_add(latency, std::memory_order_relaxed);
+			if (latency > m_max_latency.load(std::memory_order_relaxed))
+				m_max_latency.store(latency, std::memory_order_relaxed);
+
+			apply_command(cmd, now);
+			busy = true;
 		}
-		
-		m_state_change_pending = false;
+
+		auto fired = m_timing_wheel.advance(now, [this, now](const pending_action& action) -> void
+			{
+				if (action.m_type == timer_type::statistics)
+				{
+					log_latency_statistics();
+
+					auto deadline = now + STATISTICS_LOG_INTERVAL;
+					m_timing_wheel.schedule(deadline, pending_action{ timer_type::statistics, INVALID_ACTION, state::stopped, deadline });
+
+					return;
+				}
+
+				if (action.m_type == timer_type::pre_arm)
+				{
+					m_pre_arm_timer = {};
+					m_pre_arm_timer_action = INVALID_ACTION;
+
+					pre_arm(action.m_id);
+					return;
+				}
+
+				if (action.m_type == timer_type::quiet_window)
+				{
+					m_quiet_timer = {};
+					if (!m_scene_request)
+						return;
+
+					auto cmd = *m_scene_request;
+					m_scene_request.reset();
+
+					//Delays still count from the scene change, a deadline inside the window fires right away
+					submit_scene_request(cmd, now);
+					return;
+				}
+
+				if (action.m_type == timer_type::hold_expired)
+				{
+					m_hold_timer = {};
+					if (m_hold_phase == hold_phase::none)
+						return;
+
+					//No start came along, now the file gets finalized
+					m_hold_phase = hold_phase::none;
+					m_promoted_stop_count.fetch_add(1, std::memory_order_relaxed);
+					stop_running();
+					return;
+				}
+
+				if (action.m_type == timer_type::state_watchdog)
+				{
+					m_state_watchdog = {};
+					m_transition_begin.reset();
+					m_pre_arm_phase = pre_arm_phase::none;
+
+					auto current_state = m_state.load(std::memory_order_relaxed);
+					if (current_state == state::starting || current_state == state::stopping)
+					{
+						report(decision::watchdog, current_state);
+						synchronize_state();
+					}
+
+					return;
+				}
+
+				m_timer_slip.record(now - action.m_deadline);
+				m_pending_actions.erase(action.m_id);
+
+				if (action.m_type == timer_type::split)
+				{
+					split();
+					return;
+				}
+
+				if (action.m_target_state == state::started)
+				{
+					m_live_deadline = action.m_deadline;
+					m_back_fill_pre_roll = action.m_pre_roll;
+				}
+
+				execute(action.m_target_state);
+			});
+
+		busy = busy || fired;
 	}
-}
\ No newline at end of file
+
+	return m_timing_wheel.next_deadline();
+}
+
+void recording_controller::report(decision value, state target_state)
+{
+	if (m_on_decision)
+		m_on_decision(value, target_state, now());
+}
+
+void recording_controller::work()
+{
+	span_tracer::set_thread_name("recording_controller");
+
+	while (!m_exit)
+	{
+		auto next_deadline = process(clock::now());
+
+		span_tracer::scope span{ "recording_controller::wait" };
+
+		//Sleep until the next timer needs attention or a producer hands us new commands
+		if (next_deadline)
+			m_wake_worker.wait_until(*next_deadline);
+		else
+			m_wake_worker.wait();
+	}
+}
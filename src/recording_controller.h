@@ -20,9 +20,18 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 #include <atomic>
 #include <thread>
-#include <condition_variable>
-#include <queue>
+#include <unordered_map>
 #include <chrono>
+#include <cstdint>
+#include <optional>
+#include <functional>
+
+#include "latency_histogram.h"
+#include "mpsc_queue.h"
+#include "recording_frontend.h"
+#include "timing_wheel.h"
+#include "virtual_clock.h"
+#include "wakeup_event.h"
 
 class recording_controller
 {
@@ -31,43 +40,305 @@ class recording_controller
 		{
 			started,
 			stopped,
-			paused
+			paused,
+			starting,
+			stopping
+		};
+
+		using clock = std::chrono::steady_clock;
+		using action_id = uint64_t;
+
+		static constexpr action_id INVALID_ACTION = 0;
+
+		//What the worker made of a request, reported for tracing and replays
+		enum class decision
+		{
+			start,
+			stop,
+			deferred,
+			suppressed,
+			watchdog,
+			split,
+			coalesced
+		};
+
+		using decision_observer = std::function<void(decision value, state target_state, clock::time_point time)>;
+
+		struct options
+		{
+			recording_frontend m_frontend = recording_frontend::obs();
+
+			//When set there is no worker thread, time only moves with this clock and the owner calls process()
+			virtual_clock* m_manual_clock = nullptr;
+
+			//Called on the worker thread, must not block
+			decision_observer m_on_decision;
+		};
+
+		//Enqueue-to-dequeue latency of the command queue in nanoseconds
+		struct queue_statistics
+		{
+			uint64_t m_count = 0;
+			uint64_t m_total_latency = 0;
+			uint64_t m_max_latency = 0;
+			uint64_t m_dropped = 0;
+		};
+
+		//All values in nanoseconds
+		struct latency_statistics
+		{
+			//Scene change callback until the worker has the request scheduled
+			latency_histogram::summary m_decision;
+			//Scheduled deadline until the timer actually fired
+			latency_histogram::summary m_timer_slip;
+			//Frontend call until OBS confirmed the new recording state
+			latency_histogram::summary m_start_confirmation;
+			latency_histogram::summary m_stop_confirmation;
+			//Deadline of a start until OBS reported the recording as running (started or unpaused)
+			latency_histogram::summary m_deadline_to_live;
+			//Split request until the muxer opened the next file with its first frame
+			latency_histogram::summary m_split;
 		};
 
 		recording_controller();
+		explicit recording_controller(options opts);
 		~recording_controller();
 
 		//No copying
 		recording_controller(const recording_controller& other) = delete;
 		recording_controller& operator = (const recording_controller& other) = delete;
 
-		recording_controller(recording_controller&& other) = default;
-		recording_controller& operator = (recording_controller&& other) = default;
+		recording_controller(recording_controller&& other) = delete;
+		recording_controller& operator = (recording_controller&& other) = delete;
 	public:
-		void start_recording(std::chrono::milliseconds time = std::chrono::milliseconds{ 0 });
-		void stop_recording(std::chrono::milliseconds time = std::chrono::milliseconds{ 0 });
+		//These never block and never lock, they are safe to call from OBS signal threads.
+		//origin_scene only identifies the triggering scene, it is never dereferenced.
+		//trigger_time is when the triggering callback was entered, the delay counts from there. Defaults to now.
+		//pre_roll asks for that many seconds of replay buffer to be saved the moment the recording is live.
+		action_id start_recording(std::chrono::milliseconds time = std::chrono::milliseconds{ 0 }, const void* origin_scene = nullptr, clock::time_point trigger_time = {}, uint32_t pre_roll = 0);
+		action_id stop_recording(std::chrono::milliseconds time = std::chrono::milliseconds{ 0 }, const void* origin_scene = nullptr, clock::time_point trigger_time = {});
+
+		//Continues a running recording in a new file, the output stays up. Splits closer together than SPLIT_COALESCE_WINDOW end up in one file.
+		action_id split_recording(std::chrono::milliseconds time = std::chrono::milliseconds{ 0 }, const void* origin_scene = nullptr, clock::time_point trigger_time = {});
+
+		//Scene rules go through a single slot, every request replaces whatever the previous scene had scheduled.
+		//Requests closer together than the quiet window collapse into the last one. A start or stop the recording already follows is dropped.
+		action_id request_scene_action(state target_state, bool split, std::chrono::milliseconds time, const void* origin_scene = nullptr, clock::time_point trigger_time = {}, uint32_t pre_roll = 0);
+		void cancel_scene_action();
+
+		//Schedules a state change for an absolute point in time. Any number of actions can be pending at once.
+		action_id schedule(state target_state, clock::time_point deadline, const void* origin_scene = nullptr, clock::time_point trigger_time = {}, uint32_t pre_roll = 0);
+		void cancel(action_id id);
+
+		//Fed from the frontend recording events, the frontend itself is only asked by synchronize_state()
+		void on_recording_state_changed(state new_state);
+		void synchronize_state();
+
+		//Fed from the recording output's file_changed signal, the frontend has no event for it
+		void on_split_confirmed();
 
-		state get_current_state();
+		//Delayed starts begin this long before their deadline and wait paused, so the deadline only has to unpause.
+		//Zero disables pre-arming. Outputs which cannot pause are started at the deadline as before.
+		inline void set_pre_arm_lead(std::chrono::milliseconds lead) { m_pre_arm_lead.store(lead.count(), std::memory_order_relaxed); }
+
+		//A stop first only pauses the recording, a start within this window unpauses instead of opening a new file.
+		//Zero disables the hysteresis. Outputs which cannot pause are stopped right away as before.
+		inline void set_stop_hysteresis(std::chrono::milliseconds window) { m_stop_hysteresis.store(window.count(), std::memory_order_relaxed); }
+
+		//Scene requests wait this long for the next one before they are scheduled. Zero schedules right away.
+		inline void set_quiet_window(std::chrono::milliseconds window) { m_quiet_window.store(window.count(), std::memory_order_relaxed); }
+
+		//Applies queued commands and fires due timers. Returns when the controller needs attention next.
+		//Only to be called by the owner of a controller in manual mode, otherwise the worker does this.
+		std::optional<clock::time_point> process(clock::time_point now);
+
+		//The clock requests are measured against, the manual clock in replays
+		inline clock::time_point now() const { return m_manual_clock ? m_manual_clock->now() : clock::now(); }
+
+		inline state get_current_state() const { return m_state.load(std::memory_order_relaxed); }
+		inline uint64_t get_suppressed_requests() const { return m_suppressed_count.load(std::memory_order_relaxed); }
+		inline uint64_t get_pre_armed_starts() const { return m_pre_armed_count.load(std::memory_order_relaxed); }
+		inline uint64_t get_pre_arm_fallbacks() const { return m_pre_arm_fallback_count.load(std::memory_order_relaxed); }
+		inline uint64_t get_back_fills() const { return m_back_fill_count.load(std::memory_order_relaxed); }
+		inline uint64_t get_missed_back_fills() const { return m_missed_back_fill_count.load(std::memory_order_relaxed); }
+		inline uint64_t get_avoided_restarts() const { return m_avoided_restart_count.load(std::memory_order_relaxed); }
+		inline uint64_t get_promoted_stops() const { return m_promoted_stop_count.load(std::memory_order_relaxed); }
+		inline uint64_t get_splits() const { return m_split_count.load(std::memory_order_relaxed); }
+		inline uint64_t get_coalesced_splits() const { return m_coalesced_split_count.load(std::memory_order_relaxed); }
+		inline uint64_t get_coalesced_scene_requests() const { return m_coalesced_scene_count.load(std::memory_order_relaxed); }
+
+		//Estimated from the measured start and stop confirmation times, in nanoseconds
+		inline uint64_t get_saved_setup_time() const { return m_saved_setup_time.load(std::memory_order_relaxed); }
+		queue_statistics get_queue_statistics() const;
+		latency_statistics get_latency_statistics() const;
 
 	protected:
 
 	private:
+		static constexpr size_t COMMAND_QUEUE_SIZE = 1024;
+
+		//Upper bound for the frontend to confirm a start or stop before we ask it directly
+		static constexpr std::chrono::milliseconds STATE_CONFIRM_TIMEOUT{ 5000 };
+
+		//How often the worker writes the latency summary to the log, only if something was measured since
+		static constexpr std::chrono::minutes STATISTICS_LOG_INTERVAL{ 5 };
+
+		//Shorter delays are not worth a start and pause cycle
+		static constexpr std::chrono::milliseconds MIN_PRE_ARM_WINDOW{ 250 };
+
+		//A split this soon after the last one is dropped, the muxer only cuts at the next keyframe anyway
+		static constexpr std::chrono::milliseconds SPLIT_COALESCE_WINDOW{ 1000 };
+
+		enum class command_type
+		{
+			schedule,
+			cancel,
+			state_changed,
+			split_confirmed,
+			scene_request,
+			scene_cancel
+		};
+
+		enum class timer_type
+		{
+			action,
+			state_watchdog,
+			statistics,
+			pre_arm,
+			hold_expired,
+			split,
+			quiet_window
+		};
+
+		//Progress of a recording which was started ahead of its deadline
+		enum class pre_arm_phase
+		{
+			none,
+			starting,	//waiting for OBS to confirm the start
+			pausing,	//started, waiting for the pause
+			armed,		//paused, the deadline unpauses
+			aborting	//the start was cancelled while OBS was still starting
+		};
+
+		//Progress of a stop which only paused the recording
+		enum class hold_phase
+		{
+			none,
+			pausing,	//waiting for OBS to confirm the pause
+			held		//paused, a start unpauses, the hold timer stops for real
+		};
+
+		struct command
+		{
+			command_type m_type;
+			state m_target_state;
+			action_id m_sequence;
+			action_id m_target;
+			clock::time_point m_deadline;
+			clock::time_point m_enqueue_time;
+			clock::time_point m_trigger_time;
+			const void* m_origin_scene;
+			uint32_t m_pre_roll;
+			bool m_split;
+		};
+
+		struct pending_action
+		{
+			timer_type m_type = timer_type::action;
+			action_id m_id = INVALID_ACTION;
+			state m_target_state = state::stopped;
+			clock::time_point m_deadline;
+			uint32_t m_pre_roll = 0;
+		};
+
+		void report(decision value, state target_state);
+
 		void work();
-		void abort();
+		action_id push_command(command cmd);
+		void apply_command(const command& cmd, clock::time_point now);
+		void schedule_action(const command& cmd, clock::time_point now);
+		void cancel_action(action_id id);
+		void submit_scene_request(const command& cmd, clock::time_point now);
+		bool is_redundant(state target_state) const;
+		void execute(state target_state);
+		bool begin_transition(state expected, state transitional);
+		void run_deferred();
+		void confirm_transition(state new_state, clock::time_point time);
+		void schedule_pre_arm(action_id id, clock::time_point deadline, clock::time_point now);
+		void pre_arm(action_id id);
+		void abort_pre_arm();
+		void advance_pre_arm(state new_state);
+		void go_live();
+		void stop_running();
+		void back_fill();
+		bool hold();
+		void resume();
+		void advance_hold(state new_state);
+		void split();
+		void log_latency_statistics();
 
-		std::thread m_thread;
-		std::condition_variable m_begin_task;
-		std::condition_variable m_wait_task;
+		const recording_frontend m_frontend;
+		virtual_clock* const m_manual_clock;
+		const decision_observer m_on_decision;
 
-		mutable std::mutex m_task_mutex;
-		mutable std::mutex m_wait_mutex;
-		mutable std::mutex m_state_mutex;
+		mpsc_queue<command, COMMAND_QUEUE_SIZE> m_commands;
+		wakeup_event m_wake_worker;
 
-		std::atomic<state> m_pending_state;
-		std::atomic<std::chrono::milliseconds> m_state_change_time;
+		//Only touched by the worker thread
+		timing_wheel<pending_action> m_timing_wheel;
+		std::unordered_map<action_id, timing_wheel<pending_action>::handle> m_pending_actions;
+		timing_wheel<pending_action>::handle m_state_watchdog;
+		std::optional<state> m_deferred_state;
+		std::optional<clock::time_point> m_transition_begin;
+		std::optional<clock::time_point> m_live_deadline;
+		timing_wheel<pending_action>::handle m_pre_arm_timer;
+		action_id m_pre_arm_timer_action;
+		action_id m_pre_arm_action;
+		pre_arm_phase m_pre_arm_phase;
+		bool m_pre_arm_live;
+		uint32_t m_back_fill_pre_roll;
+		timing_wheel<pending_action>::handle m_hold_timer;
+		hold_phase m_hold_phase;
+		bool m_hold_resume;
+		std::optional<clock::time_point> m_split_begin;
+		std::optional<clock::time_point> m_last_split;
+		std::optional<command> m_scene_request;
+		timing_wheel<pending_action>::handle m_quiet_timer;
+		action_id m_scene_action;
+		uint64_t m_logged_samples;
 
+		std::atomic<state> m_state;
+
+		std::atomic<action_id> m_next_sequence;
 		std::atomic_bool m_exit;
-		std::atomic_bool m_start_requested;
-		std::atomic_bool m_cancel;
-		std::atomic_bool m_state_change_pending;
+
+		std::atomic<uint64_t> m_dequeued_count;
+		std::atomic<uint64_t> m_total_latency;
+		std::atomic<uint64_t> m_max_latency;
+		std::atomic<uint64_t> m_dropped_count;
+		std::atomic<uint64_t> m_suppressed_count;
+		std::atomic<uint64_t> m_pre_armed_count;
+		std::atomic<uint64_t> m_pre_arm_fallback_count;
+		std::atomic<int64_t> m_pre_arm_lead;
+		std::atomic<uint64_t> m_back_fill_count;
+		std::atomic<uint64_t> m_missed_back_fill_count;
+		std::atomic<int64_t> m_stop_hysteresis;
+		std::atomic<uint64_t> m_avoided_restart_count;
+		std::atomic<uint64_t> m_promoted_stop_count;
+		std::atomic<uint64_t> m_saved_setup_time;
+		std::atomic<uint64_t> m_split_count;
+		std::atomic<uint64_t> m_coalesced_split_count;
+		std::atomic<int64_t> m_quiet_window;
+		std::atomic<uint64_t> m_coalesced_scene_count;
+
+		//Recorded by the worker, read by anyone
+		latency_histogram m_decision_latency;
+		latency_histogram m_timer_slip;
+		latency_histogram m_start_confirmation_latency;
+		latency_histogram m_stop_confirmation_latency;
+		latency_histogram m_deadline_to_live;
+		latency_histogram m_split_latency;
+
+		//Started last, after everything the worker touches has been initialized
+		std::thread m_thread;
 };
\ No newline at end of file
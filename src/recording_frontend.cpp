@@ -0,0 +1,36 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "recording_frontend.h"
+
+#include <obs-frontend-api.h>
+
+#include <functional>
+#include <memory>
+
+static bool recording_can_pause()
+{
+	auto output_ptr = std::unique_ptr<obs_output_t, std::function<void(obs_output_t*)>>(obs_frontend_get_recording_output(), [](obs_output_t* ptr) -> void {obs_output_release(ptr); });
+
+	return output_ptr && obs_output_can_pause(output_ptr.get());
+}
+
+recording_frontend recording_frontend::obs()
+{
+	return recording_frontend{ obs_frontend_recording_start, obs_frontend_recording_stop, obs_frontend_recording_active, obs_frontend_recording_paused, obs_frontend_recording_pause, recording_can_pause, obs_frontend_replay_buffer_active, obs_frontend_replay_buffer_save, obs_frontend_recording_split_file };
+}
@@ -0,0 +1,41 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+//The frontend calls the recording controller depends on.
+//By default these are the OBS frontend API, replacing them lets the controller run without OBS (e.g. for benchmarks or replays).
+struct recording_frontend
+{
+	void (*m_start_recording)();
+	void (*m_stop_recording)();
+	bool (*m_recording_active)();
+	bool (*m_recording_paused)();
+	void (*m_pause_recording)(bool pause);
+
+	//Whether the recording output would accept a pause, checked before pre-arming
+	bool (*m_recording_can_pause)();
+
+	bool (*m_replay_buffer_active)();
+	void (*m_save_replay_buffer)();
+
+	//Continues the recording in a new file without restarting the output, false if the output cannot split
+	bool (*m_split_recording)();
+
+	static recording_frontend obs();
+};
@@ -23,13 +23,31 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <unordered_map>
 #include <string>
 
+#include "source_key.h"
+
 class recording_setting
 {
 	public:
 		enum class action
 		{
 			start,
-			stop
+			stop,
+			split	//keeps the recording running and continues it in a new file
+		};
+
+		//How m_scene_name is compared against a scene, everything but scene, nested and the source matches treats it as a pattern
+		enum class match
+		{
+			scene,
+			wildcard,	//'*' and '?' on the whole name
+			regex,		//ECMAScript, searched anywhere in the name
+			tag,		//"#tag" as a word in the name
+			sequence,	//"A > B > C", the scenes in this order within m_window
+			dwell,		//the scene stays on air for m_window, leaving it earlier withdraws the action
+			nested,		//the scene becomes visible anywhere in the program output, also as a nested scene or group
+			activate,	//the source (camera, media, ...) starts being shown in the program output
+			deactivate,	//the source stops being shown in the program output
+			audio		//the source's audio gets loud (see audio_gate), a start rule stops again once it is quiet
 		};
 
 		recording_setting()
@@ -41,10 +59,25 @@ class recording_setting
 			, m_trigger_time(trigger_time)
 		{ } 
 
+		recording_setting(const source_key& key, std::string name, action action, uint32_t trigger_time, uint32_t pre_roll = 0, match match = match::scene, int32_t priority = 0, uint32_t window = 0)
+			: m_scene_key(key)
+			, m_scene_name(name)
+			, m_action(action)
+			, m_trigger_time(trigger_time)
+			, m_pre_roll(pre_roll)
+			, m_match(match)
+			, m_priority(priority)
+			, m_window(window)
+		{ }
+
 		friend bool operator==(const recording_setting& lhs, const recording_setting& rhs);
 		friend bool operator!=(const recording_setting& lhs, const recording_setting& rhs);
 
 	public:
+		//The key identifies the scene, the name is only kept for display and for older scene collections
+		inline void set_scene_key(const source_key& key) { m_scene_key = key; }
+		inline const source_key& get_scene_key() const { return m_scene_key; }
+
 		inline void set_scene_name(const std::string& name) { m_scene_name = name; } 
 		inline const std::string& get_scene_name() const { return m_scene_name; }
 
@@ -54,24 +87,62 @@ class recording_setting
 		inline void set_trigger_time(uint32_t trigger_time) { m_trigger_time = trigger_time; }
 		inline uint32_t get_trigger_time() const { return m_trigger_time; }
 
+		//Seconds of replay buffer saved next to the recording when a start rule makes it live, 0 disables it
+		inline void set_pre_roll(uint32_t pre_roll) { m_pre_roll = pre_roll; }
+		inline uint32_t get_pre_roll() const { return m_pre_roll; }
+
+		//Pattern rules carry a generated key of their own, the scene name holds the pattern
+		inline void set_match(match match) { m_match = match; }
+		inline match get_match() const { return m_match; }
+		inline bool is_pattern() const { return m_match != match::scene && m_match != match::nested && !is_source(); }
+
+		//Source rules are bound to a single source instead of a scene, m_scene_name holds the source's name
+		inline bool is_source() const { return m_match == match::activate || m_match == match::deactivate || m_match == match::audio; }
+
+		//Sequence and dwell rules look at the history of scene changes, not at a single scene
+		inline bool is_sequence() const { return m_match == match::sequence || m_match == match::dwell; }
+
+		//Decides between patterns matching the same scene, higher wins. Literal scene rules always win.
+		inline void set_priority(int32_t priority) { m_priority = priority; }
+		inline int32_t get_priority() const { return m_priority; }
+
+		//Milliseconds, the time a sequence has to complete in (0 for no limit) or a dwell rule's scene has to stay on air
+		inline void set_window(uint32_t window) { m_window = window; }
+		inline uint32_t get_window() const { return m_window; }
+
 	protected:
 
 	private:
+		source_key m_scene_key;
 		std::string m_scene_name;
 		action m_action = action::start;
 		uint32_t m_trigger_time = 0;
+		uint32_t m_pre_roll = 0;
+		match m_match = match::scene;
+		int32_t m_priority = 0;
+		uint32_t m_window = 0;
 };
 
 inline bool operator==(const recording_setting& lhs, const recording_setting& rhs)
 {
-	return lhs.get_scene_name() == rhs.get_scene_name() 
+	return lhs.get_scene_key() == rhs.get_scene_key()
+		&& lhs.get_scene_name() == rhs.get_scene_name() 
 		&& lhs.get_action() == rhs.get_action() 
-		&& lhs.get_trigger_time() == rhs.get_trigger_time();
+		&& lhs.get_trigger_time() == rhs.get_trigger_time()
+		&& lhs.get_pre_roll() == rhs.get_pre_roll()
+		&& lhs.get_match() == rhs.get_match()
+		&& lhs.get_priority() == rhs.get_priority()
+		&& lhs.get_window() == rhs.get_window();
 }
 
 inline bool operator!=(const recording_setting& lhs, const recording_setting& rhs)
 {
-	return lhs.get_scene_name() != rhs.get_scene_name()
+	return lhs.get_scene_key() != rhs.get_scene_key()
+		|| lhs.get_scene_name() != rhs.get_scene_name()
 		|| lhs.get_action() != rhs.get_action()
-		|| lhs.get_trigger_time() != rhs.get_trigger_time();
+		|| lhs.get_trigger_time() != rhs.get_trigger_time()
+		|| lhs.get_pre_roll() != rhs.get_pre_roll()
+		|| lhs.get_match() != rhs.get_match()
+		|| lhs.get_priority() != rhs.get_priority()
+		|| lhs.get_window() != rhs.get_window();
 }
\ No newline at end of file
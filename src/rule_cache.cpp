@@ -0,0 +1,122 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "rule_cache.h"
+
+#include <algorithm>
+
+rule_cache::rule_cache(size_t memory_limit)
+	: m_memory_usage{ 0 }
+	, m_memory_limit{ memory_limit }
+	, m_hits{ 0 }
+	, m_misses{ 0 }
+	, m_evictions{ 0 }
+{ }
+
+void rule_cache::insert(const std::string& collection, entry value)
+{
+	if (!value.m_snapshot)
+		return;
+
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	auto it = m_index.find(collection);
+	if (it != m_index.end())
+		remove(it);
+
+	auto memory_usage = value.m_snapshot->get_memory_usage();
+
+	//A single collection too large for the cache is not worth pushing everything else out
+	if (memory_usage > m_memory_limit)
+		return;
+
+	m_nodes.push_front(node{ collection, std::move(value), memory_usage });
+	m_index.emplace(collection, m_nodes.begin());
+	m_memory_usage += memory_usage;
+
+	evict();
+}
+
+void rule_cache::erase(const std::string& collection)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	auto it = m_index.find(collection);
+	if (it != m_index.end())
+		remove(it);
+}
+
+void rule_cache::retain(const std::vector<std::string>& collections)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	for (auto it = m_index.begin(); it != m_index.end();)
+	{
+		auto current = it++;
+
+		if (std::find(collections.begin(), collections.end(), current->first) == collections.end())
+			remove(current);
+	}
+}
+
+void rule_cache::clear()
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	m_index.clear();
+	m_nodes.clear();
+	m_memory_usage = 0;
+}
+
+void rule_cache::set_memory_limit(size_t memory_limit)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	m_memory_limit = memory_limit;
+	evict();
+}
+
+size_t rule_cache::size() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	return m_nodes.size();
+}
+
+size_t rule_cache::get_memory_usage() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	return m_memory_usage;
+}
+
+void rule_cache::remove(node_index::iterator it)
+{
+	m_memory_usage -= it->second->m_memory_usage;
+	m_nodes.erase(it->second);
+	m_index.erase(it);
+}
+
+void rule_cache::evict()
+{
+	while (m_memory_usage > m_memory_limit && !m_nodes.empty())
+	{
+		remove(m_index.find(m_nodes.back().m_collection));
+		++m_evictions;
+	}
+}
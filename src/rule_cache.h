@@ -0,0 +1,124 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rule_snapshot.h"
+
+//Least recently used cache of rule snapshots of inactive scene collections, keyed by collection name.
+//Switching back to a cached collection hands the snapshot out again instead of parsing and building it anew.
+class rule_cache
+{
+	public:
+		//Everything needed to tell whether the snapshot still matches what is stored for the collection
+		struct entry
+		{
+			std::unique_ptr<const rule_snapshot> m_snapshot;
+			uint64_t m_revision = 0;
+			uint64_t m_journal_size = 0;
+			size_t m_journal_entries = 0;
+			bool m_rule_store_current = false;
+		};
+
+		explicit rule_cache(size_t memory_limit);
+
+		//No copying
+		rule_cache(const rule_cache& other) = delete;
+		rule_cache& operator = (const rule_cache& other) = delete;
+
+	public:
+		void insert(const std::string& collection, entry value);
+
+		//Removes the entry and returns it if validate accepts it. Counts as hit or miss.
+		template <typename F>
+		std::optional<entry> take(const std::string& collection, F&& validate)
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+
+			auto it = m_index.find(collection);
+			if (it == m_index.end())
+			{
+				++m_misses;
+				return std::nullopt;
+			}
+
+			entry result = std::move(it->second->m_value);
+			remove(it);
+
+			if (!validate(static_cast<const entry&>(result)))
+			{
+				++m_misses;
+				return std::nullopt;
+			}
+
+			++m_hits;
+			return result;
+		}
+
+		void erase(const std::string& collection);
+		void retain(const std::vector<std::string>& collections);
+		void clear();
+
+		void set_memory_limit(size_t memory_limit);
+		inline size_t get_memory_limit() const { return m_memory_limit; }
+
+		size_t size() const;
+		size_t get_memory_usage() const;
+
+		inline uint64_t get_hits() const { return m_hits; }
+		inline uint64_t get_misses() const { return m_misses; }
+		inline uint64_t get_evictions() const { return m_evictions; }
+
+	protected:
+
+	private:
+		struct node
+		{
+			std::string m_collection;
+			entry m_value;
+			size_t m_memory_usage;
+		};
+
+		using node_list = std::list<node>;
+		using node_index = std::unordered_map<std::string, node_list::iterator>;
+
+		void remove(node_index::iterator it);
+		void evict();
+
+		mutable std::mutex m_mutex;
+
+		//Most recently used first
+		node_list m_nodes;
+		node_index m_index;
+		size_t m_memory_usage;
+
+		std::atomic<size_t> m_memory_limit;
+		std::atomic<uint64_t> m_hits;
+		std::atomic<uint64_t> m_misses;
+		std::atomic<uint64_t> m_evictions;
+};
@@ -0,0 +1,375 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "rule_journal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <system_error>
+
+constexpr uint32_t JOURNAL_MAGIC = 0x4A525353;	//"SSRJ"
+constexpr uint32_t JOURNAL_VERSION = 1;
+
+//Header: magic, version, base revision
+constexpr size_t HEADER_SIZE = 16;
+
+//Entry: payload size, payload checksum, payload (operation, action, match, pre roll, trigger time, priority, window, key, name)
+constexpr size_t ENTRY_HEADER_SIZE = 8;
+constexpr size_t PAYLOAD_FIXED_SIZE = 40;
+
+template <typename T>
+static void put(std::string& buffer, T value)
+{
+	buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+static T get(const uint8_t* data)
+{
+	T value;
+	std::memcpy(&value, data, sizeof(value));
+
+	return value;
+}
+
+rule_journal::rule_journal()
+	: m_entry_count{ 0 }
+	, m_size{ 0 }
+{ }
+
+size_t rule_journal::open(const std::filesystem::path& path, uint64_t base_revision, std::vector<recording_setting>& settings)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	m_stream.close();
+	m_path = path;
+	m_entry_count = 0;
+	m_size = 0;
+
+	std::vector<uint8_t> data;
+	{
+		std::ifstream stream{ path, std::ios::binary };
+		if (stream)
+			data.assign(std::istreambuf_iterator<char>{ stream }, std::istreambuf_iterator<char>{});
+	}
+
+	bool matching = data.size() >= HEADER_SIZE
+		&& get<uint32_t>(data.data()) == JOURNAL_MAGIC
+		&& get<uint32_t>(data.data() + 4) == JOURNAL_VERSION
+		&& get<uint64_t>(data.data() + 8) == base_revision;
+
+	if (!matching)
+	{
+		reset_locked(base_revision);
+		return 0;
+	}
+
+	size_t offset = HEADER_SIZE;
+	while (data.size() - offset >= ENTRY_HEADER_SIZE)
+	{
+		auto payload_size = get<uint32_t>(data.data() + offset);
+		auto payload_checksum = get<uint32_t>(data.data() + offset + 4);
+		auto payload = data.data() + offset + ENTRY_HEADER_SIZE;
+
+		//A torn write at the end is expected after a crash, everything before it is still good
+		if (payload_size < PAYLOAD_FIXED_SIZE || data.size() - offset - ENTRY_HEADER_SIZE < payload_size || checksum(payload, payload_size) != payload_checksum)
+			break;
+
+		auto op = static_cast<operation>(payload[0]);
+		auto action = static_cast<recording_setting::action>(payload[1]);
+		auto match = static_cast<recording_setting::match>(payload[2]);
+		auto pre_roll = get<uint32_t>(payload + 4);
+		auto trigger_time = get<uint32_t>(payload + 8);
+		auto priority = get<int32_t>(payload + 12);
+		auto window = get<uint32_t>(payload + 16);
+		source_key key{ get<uint64_t>(payload + 20), get<uint64_t>(payload + 28) };
+		auto name_length = get<uint32_t>(payload + 36);
+
+		if (PAYLOAD_FIXED_SIZE + static_cast<size_t>(name_length) != payload_size)
+			break;
+
+		std::string name{ reinterpret_cast<const char*>(payload + PAYLOAD_FIXED_SIZE), name_length };
+		apply(op, recording_setting{ key, std::move(name), action, trigger_time, pre_roll, match, priority, window }, settings);
+
+		offset += ENTRY_HEADER_SIZE + payload_size;
+		++m_entry_count;
+	}
+
+	std::error_code error;
+	if (offset < data.size())
+		std::filesystem::resize_file(path, offset, error);
+
+	m_size = offset;
+	m_stream.open(path, std::ios::binary | std::ios::app);
+
+	return m_entry_count;
+}
+
+bool rule_journal::attach(const std::filesystem::path& path, uint64_t base_revision, uint64_t size, size_t entry_count)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	m_stream.close();
+	m_path = path;
+	m_entry_count = 0;
+	m_size = 0;
+
+	std::error_code error;
+	if (std::filesystem::file_size(path, error) != size || error || size < HEADER_SIZE)
+		return false;
+
+	uint8_t header[HEADER_SIZE];
+	{
+		std::ifstream stream{ path, std::ios::binary };
+		if (!stream.read(reinterpret_cast<char*>(header), HEADER_SIZE))
+			return false;
+	}
+
+	if (get<uint32_t>(header) != JOURNAL_MAGIC || get<uint32_t>(header + 4) != JOURNAL_VERSION || get<uint64_t>(header + 8) != base_revision)
+		return false;
+
+	m_stream.open(path, std::ios::binary | std::ios::app);
+	if (!m_stream.is_open())
+		return false;
+
+	m_entry_count = entry_count;
+	m_size = size;
+
+	return true;
+}
+
+void rule_journal::close()
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	m_stream.close();
+	m_path.clear();
+	m_entry_count = 0;
+	m_size = 0;
+}
+
+bool rule_journal::append(operation op, const recording_setting& setting)
+{
+	std::string payload;
+	payload.reserve(PAYLOAD_FIXED_SIZE + setting.get_scene_name().size());
+
+	put<uint8_t>(payload, static_cast<uint8_t>(op));
+	put<uint8_t>(payload, static_cast<uint8_t>(setting.get_action()));
+	put<uint8_t>(payload, static_cast<uint8_t>(setting.get_match()));
+	put<uint8_t>(payload, 0);
+	put<uint32_t>(payload, setting.get_pre_roll());
+	put<uint32_t>(payload, setting.get_trigger_time());
+	put<int32_t>(payload, setting.get_priority());
+	put<uint32_t>(payload, setting.get_window());
+	put<uint64_t>(payload, setting.get_scene_key().get_high());
+	put<uint64_t>(payload, setting.get_scene_key().get_low());
+	put<uint32_t>(payload, static_cast<uint32_t>(setting.get_scene_name().size()));
+	payload += setting.get_scene_name();
+
+	std::string entry;
+	entry.reserve(ENTRY_HEADER_SIZE + payload.size());
+
+	put<uint32_t>(entry, static_cast<uint32_t>(payload.size()));
+	put<uint32_t>(entry, checksum(reinterpret_cast<const uint8_t*>(payload.data()), payload.size()));
+	entry += payload;
+
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	if (!m_stream.is_open())
+		return false;
+
+	m_stream.write(entry.data(), static_cast<std::streamsize>(entry.size()));
+	if (!m_stream.flush())
+	{
+		m_stream.clear();
+		return false;
+	}
+
+	++m_entry_count;
+	m_size += entry.size();
+
+	return true;
+}
+
+bool rule_journal::reset(uint64_t base_revision)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	return reset_locked(base_revision);
+}
+
+bool rule_journal::rebase(uint64_t base_revision, uint64_t size, size_t entry_count)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	if (!m_stream.is_open() || size < HEADER_SIZE || size > m_size || entry_count > m_entry_count)
+		return reset_locked(base_revision);
+
+	//Nothing came in since the save, which is the common case
+	if (size == m_size)
+		return reset_locked(base_revision);
+
+	m_stream.close();
+
+	std::vector<char> kept;
+	{
+		std::ifstream stream{ m_path, std::ios::binary };
+		stream.seekg(static_cast<std::streamoff>(size));
+		kept.assign(std::istreambuf_iterator<char>{ stream }, std::istreambuf_iterator<char>{});
+	}
+
+	auto kept_entries = m_entry_count - entry_count;
+	if (kept.size() != m_size - size || !reset_locked(base_revision))
+		return false;
+
+	m_stream.write(kept.data(), static_cast<std::streamsize>(kept.size()));
+	if (!m_stream.flush())
+	{
+		m_stream.clear();
+		return false;
+	}
+
+	m_entry_count = kept_entries;
+	m_size += kept.size();
+
+	return true;
+}
+
+bool rule_journal::relocate(const std::filesystem::path& path)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	if (m_path.empty() || m_path == path)
+		return true;
+
+	m_stream.close();
+
+	std::error_code error;
+	std::filesystem::rename(m_path, path, error);
+
+	//Without the old entries the next compaction has to start over at the new place
+	m_path = path;
+	if (error)
+		return false;
+
+	m_stream.open(m_path, std::ios::binary | std::ios::app);
+
+	return m_stream.is_open();
+}
+
+size_t rule_journal::get_entry_count() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	return m_entry_count;
+}
+
+uint64_t rule_journal::get_size() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	return m_size;
+}
+
+bool rule_journal::reset_locked(uint64_t base_revision)
+{
+	m_stream.close();
+	m_entry_count = 0;
+	m_size = 0;
+
+	if (m_path.empty())
+		return false;
+
+	std::error_code error;
+	std::filesystem::create_directories(m_path.parent_path(), error);
+
+	std::string header;
+	put<uint32_t>(header, JOURNAL_MAGIC);
+	put<uint32_t>(header, JOURNAL_VERSION);
+	put<uint64_t>(header, base_revision);
+
+	m_stream.open(m_path, std::ios::binary | std::ios::trunc);
+	m_stream.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+	if (!m_stream.flush())
+	{
+		m_stream.close();
+		return false;
+	}
+
+	m_size = header.size();
+
+	return true;
+}
+
+void rule_journal::apply(operation op, const recording_setting& setting, std::vector<recording_setting>& settings)
+{
+	auto it = std::find_if(settings.begin(), settings.end(), [&setting](const recording_setting& v) -> bool
+		{
+			return v.get_scene_key() == setting.get_scene_key();
+		});
+
+	switch (op)
+	{
+		case operation::add:
+		case operation::update:
+		{
+			if (it != settings.end())
+				*it = setting;
+			else
+				settings.push_back(setting);
+		}
+		break;
+
+		case operation::remove:
+		{
+			if (it != settings.end())
+				settings.erase(it);
+		}
+		break;
+
+		case operation::rename:
+		{
+			if (it != settings.end())
+				it->set_scene_name(setting.get_scene_name());
+		}
+		break;
+
+		default:
+		{
+
+		}
+		break;
+	}
+}
+
+uint32_t rule_journal::checksum(const uint8_t* data, size_t size)
+{
+	//FNV-1a
+	uint32_t hash = 0x811C9DC5u;
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= data[i];
+		hash *= 0x01000193u;
+	}
+
+	return hash;
+}
@@ -0,0 +1,85 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include "recording_setting.h"
+
+//Write-ahead log of rule edits on top of a saved rule table (identified by its revision).
+//Every edit is appended and flushed right away, so a crash between two saves loses nothing.
+//The owner compacts by saving the full table under a new revision and calling rebase() once that save is on disk.
+class rule_journal
+{
+	public:
+		enum class operation : uint8_t
+		{
+			add = 1,
+			update,
+			remove,
+			rename
+		};
+
+		rule_journal();
+
+		//No copying
+		rule_journal(const rule_journal& other) = delete;
+		rule_journal& operator = (const rule_journal& other) = delete;
+
+	public:
+		//Replays whatever was logged on top of base_revision into settings and keeps the file open for appending.
+		//A journal belonging to another revision is discarded. Returns the number of replayed entries.
+		size_t open(const std::filesystem::path& path, uint64_t base_revision, std::vector<recording_setting>& settings);
+		void close();
+
+		//Continues a journal known to be in the given state without replaying it. Fails if the file differs.
+		bool attach(const std::filesystem::path& path, uint64_t base_revision, uint64_t size, size_t entry_count);
+
+		bool append(operation op, const recording_setting& setting);
+		bool reset(uint64_t base_revision);
+
+		//Moves the journal onto a newer revision which already contains its first entry_count entries (the first size bytes).
+		//Entries appended after that are kept.
+		bool rebase(uint64_t base_revision, uint64_t size, size_t entry_count);
+
+		//Moves the file along, e.g. when the scene collection was renamed
+		bool relocate(const std::filesystem::path& path);
+
+		size_t get_entry_count() const;
+		uint64_t get_size() const;
+
+	protected:
+
+	private:
+		static void apply(operation op, const recording_setting& setting, std::vector<recording_setting>& settings);
+		static uint32_t checksum(const uint8_t* data, size_t size);
+
+		bool reset_locked(uint64_t base_revision);
+
+		mutable std::mutex m_mutex;
+
+		std::filesystem::path m_path;
+		std::ofstream m_stream;
+		size_t m_entry_count;
+		uint64_t m_size;
+};
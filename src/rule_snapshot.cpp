@@ -0,0 +1,118 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "rule_snapshot.h"
+
+rule_snapshot::rule_snapshot(std::vector<recording_setting> settings, uint64_t version)
+	: m_settings{ std::move(settings) }
+	, m_version{ version }
+{
+	m_table.reserve(m_settings.size());
+
+	for (auto& v : m_settings)
+	{
+		if (!v.get_scene_key().valid())
+			v.set_scene_key(v.is_pattern() ? source_key::generate() : source_key::from_name(v.get_scene_name().c_str()));
+
+		//Patterns name no scene, their keys only identify the rule
+		if (v.get_match() == recording_setting::match::nested)
+			m_nested_table.insert(v.get_scene_key(), &v);
+		else if (v.is_source())
+			m_source_table.insert(v.get_scene_key(), &v);
+		else if (!v.is_pattern())
+			m_table.insert(v.get_scene_key(), &v);
+	}
+
+	m_patterns.build(m_settings);
+	m_sequences.build(m_settings);
+
+	if (!m_patterns.empty() && m_settings.size() < (size_t{ 1 } << MEMO_VALUE_BITS))
+	{
+		m_memo = std::make_unique<std::atomic<uint64_t>[]>(MEMO_SLOTS);
+		for (size_t i = 0; i < MEMO_SLOTS; ++i)
+			m_memo[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+const recording_setting* rule_snapshot::resolve(const source_key& key, std::string_view name) const
+{
+	if (auto result = m_table.find(key))
+		return result;
+
+	if (m_patterns.empty() || name.empty())
+		return nullptr;
+
+	if (!m_memo)
+		return m_patterns.match(name);
+
+	//FNV-1a over the name, mixed with the key so equally named scenes do not share a slot
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (auto c : name)
+	{
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 0x100000001B3ull;
+	}
+
+	hash ^= key.hash() * 0x9E3779B97F4A7C15ull;
+
+	constexpr uint64_t VALUE_MASK = (uint64_t{ 1 } << MEMO_VALUE_BITS) - 1;
+
+	auto& slot = m_memo[hash % MEMO_SLOTS];
+	auto tag = hash & ~VALUE_MASK;
+
+	auto entry = slot.load(std::memory_order_relaxed);
+	if (entry && (entry & ~VALUE_MASK) == tag)
+	{
+		auto value = entry & VALUE_MASK;
+		return value ? &m_settings[value - 1] : nullptr;
+	}
+
+	auto result = m_patterns.match(name);
+	uint64_t value = result ? static_cast<uint64_t>(result - m_settings.data()) + 1 : 0;
+	slot.store(tag | value, std::memory_order_relaxed);
+
+	return result;
+}
+
+std::vector<source_key> rule_snapshot::get_keys() const
+{
+	std::vector<source_key> result;
+	result.reserve(m_settings.size());
+
+	for (const auto& v : m_settings)
+	{
+		//Only scenes, the catalog knows no other sources
+		if (!v.is_pattern() && !v.is_source())
+			result.push_back(v.get_scene_key());
+	}
+
+	return result;
+}
+
+size_t rule_snapshot::get_memory_usage() const
+{
+	size_t result = sizeof(*this) + m_settings.capacity() * sizeof(recording_setting) + m_table.memory_usage() + m_nested_table.memory_usage() + m_source_table.memory_usage() + m_patterns.memory_usage() + m_sequences.memory_usage();
+
+	if (m_memo)
+		result += MEMO_SLOTS * sizeof(std::atomic<uint64_t>);
+
+	for (const auto& v : m_settings)
+		result += v.get_scene_name().capacity();
+
+	return result;
+}
@@ -0,0 +1,84 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "recording_setting.h"
+#include "scene_pattern_set.h"
+#include "scene_rule_table.h"
+#include "scene_sequence_set.h"
+
+//Immutable, versioned set of rules together with its lookup table.
+//Published through an rcu_cell, so it is never modified once readers can see it.
+class rule_snapshot
+{
+	public:
+		rule_snapshot(std::vector<recording_setting> settings, uint64_t version);
+
+		//No copying, the table points into m_settings
+		rule_snapshot(const rule_snapshot& other) = delete;
+		rule_snapshot& operator = (const rule_snapshot& other) = delete;
+
+	public:
+		inline const recording_setting* find(const source_key& key) const { return m_table.find(key); }
+
+		//Rules firing when the scene becomes visible anywhere in the program output, kept out of resolve() which only knows program scenes
+		inline const recording_setting* find_nested(const source_key& key) const { return m_nested_table.find(key); }
+
+		//Activate, deactivate and audio rules by source, one rule per source. Every source activation in OBS asks here, most get no rule.
+		inline const recording_setting* find_source(const source_key& key) const { return m_source_table.find(key); }
+		inline bool has_source_rules() const { return !m_source_table.empty(); }
+
+		//The scene's own rule if it has one, otherwise the pattern rule winning for its name.
+		//Pattern results are memoized per snapshot, so edits (new snapshot) and renames (new name) never see stale ones.
+		const recording_setting* resolve(const source_key& key, std::string_view name) const;
+
+		//Sequence and dwell rules, matched against the history of scene changes by the dispatcher
+		inline const scene_sequence_set& get_sequences() const { return m_sequences; }
+
+		inline const std::vector<recording_setting>& get_settings() const { return m_settings; }
+		std::vector<source_key> get_keys() const;
+		inline uint64_t get_version() const { return m_version; }
+
+		//Rough heap footprint, used to keep caches of snapshots within limits
+		size_t get_memory_usage() const;
+
+	protected:
+
+	private:
+		//Slot layout: upper 44 bits tag, lower 20 bits index + 1 of the winning rule, 0 if no pattern matched
+		static constexpr size_t MEMO_SLOTS = 1024;
+		static constexpr uint32_t MEMO_VALUE_BITS = 20;
+
+		std::vector<recording_setting> m_settings;
+		scene_rule_table m_table;
+		scene_rule_table m_nested_table;
+		scene_rule_table m_source_table;
+		scene_pattern_set m_patterns;
+		scene_sequence_set m_sequences;
+		uint64_t m_version;
+
+		//Only allocated when there are pattern rules. Racing writers may overwrite each other, a lost entry is just computed again.
+		std::unique_ptr<std::atomic<uint64_t>[]> m_memo;
+};
@@ -0,0 +1,96 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "rule_table_json.h"
+
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
+constexpr std::string_view SETTING_ARRAY_NAME = "recording_settings";
+constexpr std::string_view SCENE_NAME = "scene_name";
+constexpr std::string_view SCENE_UUID = "scene_uuid";
+constexpr std::string_view ACTION = "action";
+constexpr std::string_view TRIGGER_TIME = "trigger_time";
+constexpr std::string_view PRE_ROLL = "pre_roll";
+constexpr std::string_view MATCH = "match";
+constexpr std::string_view PRIORITY = "priority";
+constexpr std::string_view WINDOW = "window";
+
+bool rule_table_json::contains(obs_data_t* obj)
+{
+	return obs_data_has_user_value(obj, SETTING_ARRAY_NAME.data());
+}
+
+void rule_table_json::write(obs_data_t* obj, const std::vector<recording_setting>& settings)
+{
+	auto array_ptr = std::unique_ptr<obs_data_array_t, std::function<void(obs_data_array_t*)>>(obs_data_array_create(), [](obs_data_array_t* ptr) -> void {obs_data_array_release(ptr); });
+
+	for (auto& v : settings)
+	{
+		auto recording_setting_obj_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_data_create(), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
+
+		obs_data_set_string(recording_setting_obj_ptr.get(), SCENE_NAME.data(), v.get_scene_name().c_str());
+		obs_data_set_string(recording_setting_obj_ptr.get(), SCENE_UUID.data(), v.get_scene_key().to_string().c_str());
+		obs_data_set_int(recording_setting_obj_ptr.get(), ACTION.data(), static_cast<std::underlying_type_t<recording_setting::action>>(v.get_action()));
+		obs_data_set_int(recording_setting_obj_ptr.get(), TRIGGER_TIME.data(), v.get_trigger_time());
+		obs_data_set_int(recording_setting_obj_ptr.get(), PRE_ROLL.data(), v.get_pre_roll());
+		obs_data_set_int(recording_setting_obj_ptr.get(), MATCH.data(), static_cast<std::underlying_type_t<recording_setting::match>>(v.get_match()));
+		obs_data_set_int(recording_setting_obj_ptr.get(), PRIORITY.data(), v.get_priority());
+		obs_data_set_int(recording_setting_obj_ptr.get(), WINDOW.data(), v.get_window());
+		obs_data_array_push_back(array_ptr.get(), recording_setting_obj_ptr.get());
+	}
+
+	obs_data_set_array(obj, SETTING_ARRAY_NAME.data(), array_ptr.get());
+}
+
+std::vector<recording_setting> rule_table_json::read(obs_data_t* obj)
+{
+	std::vector<recording_setting> settings;
+
+	auto settings_array_ptr = std::unique_ptr<obs_data_array_t, std::function<void(obs_data_array_t*)>>(obs_data_get_array(obj, SETTING_ARRAY_NAME.data()), [](obs_data_array_t* ptr) -> void {obs_data_array_release(ptr); });
+	if (!settings_array_ptr)
+		return settings;
+
+	size_t count = obs_data_array_count(settings_array_ptr.get());
+	settings.reserve(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto recording_setting_obj_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_data_array_item(settings_array_ptr.get(), i), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
+		auto setting = recording_setting_obj_ptr.get();
+
+		auto scene_name = obs_data_get_string(setting, SCENE_NAME.data());
+		auto scene_key = source_key::from_uuid(obs_data_get_string(setting, SCENE_UUID.data()));
+		auto action = static_cast<recording_setting::action>(obs_data_get_int(setting, ACTION.data()));
+		auto trigger_time = static_cast<uint32_t>(obs_data_get_int(setting, TRIGGER_TIME.data()));
+		auto pre_roll = static_cast<uint32_t>(obs_data_get_int(setting, PRE_ROLL.data()));
+		auto match = static_cast<recording_setting::match>(obs_data_get_int(setting, MATCH.data()));
+		auto priority = static_cast<int32_t>(obs_data_get_int(setting, PRIORITY.data()));
+		auto window = static_cast<uint32_t>(obs_data_get_int(setting, WINDOW.data()));
+
+		auto& value = settings.emplace_back(recording_setting{ scene_key, scene_name, action, trigger_time, pre_roll, match, priority, window });
+
+		//Collections saved before rules were keyed by UUID only know the scene name, a pattern names no scene at all
+		if (!scene_key.valid())
+			value.set_scene_key(value.is_pattern() ? source_key::generate() : source_key::from_name(scene_name));
+	}
+
+	return settings;
+}
@@ -0,0 +1,36 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+#include <vector>
+
+#include "recording_setting.h"
+
+//The rules of a scene collection as an array of objects inside the collection JSON, one object per rule
+class rule_table_json
+{
+	public:
+		static void write(obs_data_t* obj, const std::vector<recording_setting>& settings);
+		static std::vector<recording_setting> read(obs_data_t* obj);
+
+		//An inline table, as opposed to a collection keeping its rules in the binary rule store
+		static bool contains(obs_data_t* obj);
+};
@@ -0,0 +1,160 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "scene_catalog.h"
+
+#include <algorithm>
+
+scene_catalog::scene_catalog()
+	: m_scenes_with_rule{ 0 }
+{ }
+
+void scene_catalog::reset()
+{
+	std::unique_lock lock{ m_mutex };
+
+	m_scenes.clear();
+	m_scenes_with_rule = 0;
+
+	auto enum_scene = [](void* param, obs_source_t* source) -> bool
+		{
+			auto self = static_cast<scene_catalog*>(param);
+			self->insert_locked(source_key::from_source(source), obs_source_get_name(source));
+
+			return true;
+		};
+
+	obs_enum_scenes(enum_scene, this);
+}
+
+void scene_catalog::add(const obs_source_t* source)
+{
+	if (!is_catalog_scene(source))
+		return;
+
+	auto key = source_key::from_source(source);
+	auto name = obs_source_get_name(source);
+
+	std::unique_lock lock{ m_mutex };
+	insert_locked(key, name ? name : "");
+}
+
+void scene_catalog::remove(const obs_source_t* source)
+{
+	if (!is_catalog_scene(source))
+		return;
+
+	auto key = source_key::from_source(source);
+
+	std::unique_lock lock{ m_mutex };
+
+	if (!m_scenes.erase(key))
+		return;
+
+	if (m_rule_keys.count(key))
+		--m_scenes_with_rule;
+}
+
+void scene_catalog::rename(const obs_source_t* source, const char* new_name)
+{
+	if (!is_catalog_scene(source))
+		return;
+
+	auto key = source_key::from_source(source);
+
+	std::unique_lock lock{ m_mutex };
+
+	auto it = m_scenes.find(key);
+	if (it != m_scenes.end())
+		it->second = new_name ? new_name : "";
+}
+
+void scene_catalog::set_rule_keys(const std::vector<source_key>& keys)
+{
+	std::unique_lock lock{ m_mutex };
+
+	m_rule_keys.clear();
+	m_rule_keys.insert(keys.begin(), keys.end());
+
+	m_scenes_with_rule = 0;
+	for (const auto& v : m_rule_keys)
+	{
+		if (m_scenes.count(v))
+			++m_scenes_with_rule;
+	}
+}
+
+bool scene_catalog::contains(const source_key& key) const
+{
+	std::unique_lock lock{ m_mutex };
+	return m_scenes.count(key) != 0;
+}
+
+size_t scene_catalog::scene_count() const
+{
+	std::unique_lock lock{ m_mutex };
+	return m_scenes.size();
+}
+
+size_t scene_catalog::scenes_without_rule_count() const
+{
+	std::unique_lock lock{ m_mutex };
+	return m_scenes.size() - m_scenes_with_rule;
+}
+
+size_t scene_catalog::missing_rule_count() const
+{
+	std::unique_lock lock{ m_mutex };
+	return m_rule_keys.size() - m_scenes_with_rule;
+}
+
+scene_catalog::scene_list scene_catalog::get_scenes_without_rule(const std::vector<source_key>& taken) const
+{
+	std::unordered_set<source_key, source_key_hash> taken_set{ taken.begin(), taken.end() };
+	scene_list result;
+
+	{
+		std::unique_lock lock{ m_mutex };
+
+		result.reserve(m_scenes.size());
+		for (const auto& v : m_scenes)
+		{
+			if (!taken_set.count(v.first))
+				result.emplace_back(v.first, v.second);
+		}
+	}
+
+	std::sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) -> bool {return lhs.second < rhs.second; });
+
+	return result;
+}
+
+bool scene_catalog::is_catalog_scene(const obs_source_t* source)
+{
+	return source && obs_source_get_type(source) == OBS_SOURCE_TYPE_SCENE && !obs_source_is_group(source);
+}
+
+void scene_catalog::insert_locked(const source_key& key, std::string name)
+{
+	if (!key.valid())
+		return;
+
+	auto result = m_scenes.insert_or_assign(key, std::move(name));
+	if (result.second && m_rule_keys.count(key))
+		++m_scenes_with_rule;
+}
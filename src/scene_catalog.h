@@ -0,0 +1,77 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "source_key.h"
+
+//All scenes of the current collection, kept up to date from the global source signals instead of rescanning the scene list.
+//Also tracks which scenes have a rule, so "is there a scene left without a rule" and
+//"does a rule point to a scene that is gone" are answered without nested loops.
+class scene_catalog
+{
+	public:
+		using scene_list = std::vector<std::pair<source_key, std::string>>;
+
+		scene_catalog();
+
+		//No copying
+		scene_catalog(const scene_catalog& other) = delete;
+		scene_catalog& operator = (const scene_catalog& other) = delete;
+
+	public:
+		//Full scan, only used once the frontend has finished loading
+		void reset();
+
+		void add(const obs_source_t* source);
+		void remove(const obs_source_t* source);
+		void rename(const obs_source_t* source, const char* new_name);
+
+		void set_rule_keys(const std::vector<source_key>& keys);
+
+		bool contains(const source_key& key) const;
+		size_t scene_count() const;
+		size_t scenes_without_rule_count() const;
+		size_t missing_rule_count() const;
+
+		//Checks against a set of rules which is not published yet (e.g. the one being edited)
+		scene_list get_scenes_without_rule(const std::vector<source_key>& taken) const;
+
+	protected:
+
+	private:
+		static bool is_catalog_scene(const obs_source_t* source);
+
+		void insert_locked(const source_key& key, std::string name);
+
+		mutable std::mutex m_mutex;
+
+		std::unordered_map<source_key, std::string, source_key_hash> m_scenes;
+		std::unordered_set<source_key, source_key_hash> m_rule_keys;
+
+		size_t m_scenes_with_rule;
+};
@@ -0,0 +1,151 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "scene_dispatcher.h"
+
+#include <chrono>
+
+scene_dispatcher::scene_dispatcher(recording_controller& controller)
+	: m_controller{ controller }
+	, m_last_handeled_scene{ 0 }
+	, m_last_sequence_scene{ 0 }
+{ }
+
+void scene_dispatcher::on_scene_changed(const source_key& scene_key, std::string_view scene_name, const rule_snapshot& rules, bool transition, const void* origin, recording_controller::clock::time_point trigger_time)
+{
+	//scene change can happen directly after the transition. Lets remember which scene was handeled last
+	bool handeled = m_last_handeled_scene.exchange(scene_key.hash()) == scene_key.hash();
+
+	//Sequence and dwell rules see every scene change once. OBS reports each one on the UI thread, so the matcher only advances there:
+	//it allocates while partial matches come and go, which must not happen on the transition path.
+	scene_sequence_matcher::result sequence;
+	if (!transition && m_last_sequence_scene != scene_key.hash())
+	{
+		m_last_sequence_scene = scene_key.hash();
+
+		if (!rules.get_sequences().empty())
+			sequence = m_sequence_matcher.advance(rules.get_sequences(), rules.get_version(), scene_name, trigger_time == recording_controller::clock::time_point{} ? m_controller.now() : trigger_time);
+	}
+
+	//The transition already took care of the scene's own rule
+	if (handeled && !sequence.m_rule && !sequence.m_withdraw)
+		return;
+
+	//A completed sequence or dwell rule matched more than this scene alone, so it wins over the scene's rule
+	auto rec_setting = sequence.m_rule ? sequence.m_rule : rules.resolve(scene_key, scene_name);
+
+	//Without any setting, there is nothgin to do
+	if (!rec_setting)
+	{
+		//Unless a dwell rule's scene was left too early, then its action must not run anymore
+		if (sequence.m_withdraw)
+			m_controller.cancel_scene_action();
+
+		return;
+	}
+
+	//A withdrawn dwell rule was already replaced by the request the transition made for this scene
+	if (handeled && !sequence.m_rule)
+		return;
+	
+	//The controller replaces whatever the previous scene rule had queued and collapses bursts of scene changes.
+	//Sequence and dwell rules are about transitions anyway, they always take the delayed way.
+	if (transition || sequence.m_rule)
+	{
+		auto delay = std::chrono::milliseconds{ rec_setting->get_trigger_time() };
+
+		//A dwell rule fires once its scene was on air long enough, leaving it earlier withdraws the request
+		if (rec_setting->get_match() == recording_setting::match::dwell)
+			delay += std::chrono::milliseconds{ rec_setting->get_window() };
+
+		request(*rec_setting, delay, origin, trigger_time);
+		return;
+	}
+
+	//Without transition we want to immediatley start the recording if requested (probably we are here, because OBS crashed)
+	if (rec_setting->get_action() == recording_setting::action::start)
+		m_controller.request_scene_action(recording_controller::state::started, false, std::chrono::milliseconds{ 0 }, origin, trigger_time, rec_setting->get_pre_roll());
+}
+
+void scene_dispatcher::on_scene_visible(const source_key& scene_key, const rule_snapshot& rules, const void* origin, recording_controller::clock::time_point trigger_time)
+{
+	auto rec_setting = rules.find_nested(scene_key);
+	if (!rec_setting)
+		return;
+
+	//Nested scenes never see a transition of their own, the request always takes the delayed way
+	request(*rec_setting, std::chrono::milliseconds{ rec_setting->get_trigger_time() }, origin, trigger_time);
+}
+
+void scene_dispatcher::on_source_activity(const source_key& key, bool active, const rule_snapshot& rules, const void* origin, recording_controller::clock::time_point trigger_time)
+{
+	auto rec_setting = rules.find_source(key);
+	if (!rec_setting || rec_setting->get_match() != (active ? recording_setting::match::activate : recording_setting::match::deactivate))
+		return;
+
+	request(*rec_setting, std::chrono::milliseconds{ rec_setting->get_trigger_time() }, origin, trigger_time);
+}
+
+void scene_dispatcher::on_audio_activity(const source_key& key, bool active, const rule_snapshot& rules, const void* origin, recording_controller::clock::time_point trigger_time)
+{
+	auto rec_setting = rules.find_source(key);
+	if (!rec_setting || rec_setting->get_match() != recording_setting::match::audio)
+		return;
+
+	auto delay = std::chrono::milliseconds{ rec_setting->get_trigger_time() };
+
+	if (active)
+	{
+		request(*rec_setting, delay, origin, trigger_time);
+		return;
+	}
+
+	//Silence undoes a start, stops and splits happened already
+	if (rec_setting->get_action() == recording_setting::action::start)
+		m_controller.request_scene_action(recording_controller::state::stopped, false, delay, origin, trigger_time);
+}
+
+void scene_dispatcher::request(const recording_setting& rec_setting, std::chrono::milliseconds delay, const void* origin, recording_controller::clock::time_point trigger_time)
+{
+	switch (rec_setting.get_action())
+	{
+		case recording_setting::action::start:
+		{
+			m_controller.request_scene_action(recording_controller::state::started, false, delay, origin, trigger_time, rec_setting.get_pre_roll());
+		}
+		break;
+
+		case recording_setting::action::stop:
+		{
+			m_controller.request_scene_action(recording_controller::state::stopped, false, delay, origin, trigger_time);
+		}
+		break;
+
+		case recording_setting::action::split:
+		{
+			m_controller.request_scene_action(recording_controller::state::started, true, delay, origin, trigger_time);
+		}
+		break;
+
+		default:
+		{
+
+		}
+		break;
+	}
+}
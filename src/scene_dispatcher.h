@@ -0,0 +1,70 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+#include "recording_controller.h"
+#include "rule_snapshot.h"
+#include "scene_sequence_set.h"
+#include "source_key.h"
+
+//Turns scene changes into controller requests according to the rules.
+//Shared by the live plugin and trace replays, so both take exactly the same decisions.
+class scene_dispatcher
+{
+	public:
+		explicit scene_dispatcher(recording_controller& controller);
+
+		//No copying
+		scene_dispatcher(const scene_dispatcher& other) = delete;
+		scene_dispatcher& operator = (const scene_dispatcher& other) = delete;
+
+	public:
+		//origin only identifies the scene for the controller, it is never dereferenced.
+		//trigger_time is when the OBS callback was entered, delays and latency statistics count from there.
+		//Without a scene_name only rules bound to the scene itself can match, pattern rules need the name.
+		//Sequence and dwell rules only advance with the calls without transition, those must all come from the same thread.
+		void on_scene_changed(const source_key& scene_key, std::string_view scene_name, const rule_snapshot& rules, bool transition, const void* origin, recording_controller::clock::time_point trigger_time = {});
+
+		//The scene became visible somewhere in the program output, nested in another scene or as a group. Only nested rules react to it.
+		void on_scene_visible(const source_key& scene_key, const rule_snapshot& rules, const void* origin, recording_controller::clock::time_point trigger_time = {});
+
+		//A source started (active) or stopped being shown in the program output. Only source rules react to it.
+		void on_source_activity(const source_key& key, bool active, const rule_snapshot& rules, const void* origin, recording_controller::clock::time_point trigger_time = {});
+
+		//The audio gate of a source opened (active) or closed. Only audio rules react to it.
+		void on_audio_activity(const source_key& key, bool active, const rule_snapshot& rules, const void* origin, recording_controller::clock::time_point trigger_time = {});
+
+	protected:
+
+	private:
+		void request(const recording_setting& rec_setting, std::chrono::milliseconds delay, const void* origin, recording_controller::clock::time_point trigger_time);
+
+		recording_controller& m_controller;
+
+		std::atomic<uint64_t> m_last_handeled_scene;
+
+		//Only touched by scene changes without transition, which OBS reports on the UI thread
+		uint64_t m_last_sequence_scene;
+		scene_sequence_matcher m_sequence_matcher;
+};
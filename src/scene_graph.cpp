@@ -0,0 +1,245 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "scene_graph.h"
+
+#include <unordered_set>
+
+scene_graph::scene_graph()
+{ }
+
+void scene_graph::reset(obs_source_t* const* scenes, size_t count, delta_list& deltas)
+{
+	std::unique_lock lock{ m_mutex };
+
+	std::unordered_set<source_key, source_key_hash> was_on_air;
+	for (const auto& v : m_nodes)
+	{
+		if (v.second.m_on_air)
+			was_on_air.insert(v.first);
+	}
+
+	m_nodes.clear();
+
+	auto enum_item = [](obs_scene_t* scene, obs_sceneitem_t* scene_item, void* param) -> bool
+		{
+			(void)scene;	//unused parameter
+
+			auto child = obs_sceneitem_get_source(scene_item);
+			if (is_container(child))
+				static_cast<node*>(param)->m_items[obs_sceneitem_get_id(scene_item)] = item{ source_key::from_source(child), obs_sceneitem_visible(scene_item) };
+
+			return true;
+		};
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto source = scenes[i];
+		auto key = source_key::from_source(source);
+		if (!key.valid() || !is_container(source))
+			continue;
+
+		auto scene = obs_source_is_group(source) ? obs_group_from_source(source) : obs_scene_from_source(source);
+		if (scene)
+			obs_scene_enum_items(scene, enum_item, &m_nodes[key]);
+	}
+
+	//Counting starts over, only the difference to before is reported
+	delta_list ignored;
+	if (m_program.valid())
+		raise(m_program, ignored);
+
+	for (const auto& v : m_nodes)
+	{
+		if (v.second.m_on_air && !was_on_air.count(v.first))
+			deltas.emplace_back(v.first, true);
+	}
+
+	for (const auto& v : was_on_air)
+	{
+		auto it = m_nodes.find(v);
+		if (it == m_nodes.end() || !it->second.m_on_air)
+			deltas.emplace_back(v, false);
+	}
+}
+
+void scene_graph::clear()
+{
+	std::unique_lock lock{ m_mutex };
+
+	m_nodes.clear();
+	m_program = source_key{};
+}
+
+void scene_graph::set_program(const source_key& key, delta_list& deltas)
+{
+	std::unique_lock lock{ m_mutex };
+
+	if (key == m_program)
+		return;
+
+	//Raising first keeps scenes shown by both the old and the new program on air, they never flicker off and on
+	auto previous = m_program;
+	m_program = key;
+
+	if (m_program.valid())
+		raise(m_program, deltas);
+
+	if (previous.valid())
+		lower(previous, deltas);
+}
+
+void scene_graph::add_item(const source_key& parent, int64_t item_id, const source_key& child, bool visible, delta_list& deltas)
+{
+	if (!parent.valid() || !child.valid())
+		return;
+
+	std::unique_lock lock{ m_mutex };
+
+	auto& parent_node = m_nodes[parent];
+	auto& value = parent_node.m_items[item_id];
+
+	//Replacing an item we already know, e.g. after a reset raced with the signal
+	if (value.m_visible && parent_node.m_on_air)
+		lower(value.m_child, deltas);
+
+	value = item{ child, visible };
+
+	if (visible && parent_node.m_on_air)
+		raise(child, deltas);
+}
+
+void scene_graph::remove_item(const source_key& parent, int64_t item_id, delta_list& deltas)
+{
+	std::unique_lock lock{ m_mutex };
+
+	auto parent_it = m_nodes.find(parent);
+	if (parent_it == m_nodes.end())
+		return;
+
+	auto& parent_node = parent_it->second;
+	auto it = parent_node.m_items.find(item_id);
+	if (it == parent_node.m_items.end())
+		return;
+
+	auto value = it->second;
+	parent_node.m_items.erase(it);
+
+	if (value.m_visible && parent_node.m_on_air)
+		lower(value.m_child, deltas);
+}
+
+void scene_graph::set_item_visible(const source_key& parent, int64_t item_id, bool visible, delta_list& deltas)
+{
+	std::unique_lock lock{ m_mutex };
+
+	//Most items show plain sources, they are rejected here
+	auto parent_it = m_nodes.find(parent);
+	if (parent_it == m_nodes.end())
+		return;
+
+	auto& parent_node = parent_it->second;
+	auto it = parent_node.m_items.find(item_id);
+	if (it == parent_node.m_items.end() || it->second.m_visible == visible)
+		return;
+
+	it->second.m_visible = visible;
+
+	if (!parent_node.m_on_air)
+		return;
+
+	auto child = it->second.m_child;
+	if (visible)
+		raise(child, deltas);
+	else
+		lower(child, deltas);
+}
+
+void scene_graph::remove_scene(const source_key& key, delta_list& deltas)
+{
+	std::unique_lock lock{ m_mutex };
+
+	auto it = m_nodes.find(key);
+	if (it == m_nodes.end())
+		return;
+
+	if (it->second.m_on_air)
+	{
+		for (const auto& v : it->second.m_items)
+		{
+			if (v.second.m_visible)
+				lower(v.second.m_child, deltas);
+		}
+
+		deltas.emplace_back(key, false);
+	}
+
+	m_nodes.erase(key);
+
+	if (m_program == key)
+		m_program = source_key{};
+}
+
+bool scene_graph::is_on_air(const source_key& key) const
+{
+	std::unique_lock lock{ m_mutex };
+
+	auto it = m_nodes.find(key);
+	return it != m_nodes.end() && it->second.m_on_air;
+}
+
+size_t scene_graph::size() const
+{
+	std::unique_lock lock{ m_mutex };
+	return m_nodes.size();
+}
+
+void scene_graph::raise(const source_key& key, delta_list& deltas)
+{
+	auto& value = m_nodes[key];
+	if (value.m_on_air++)
+		return;
+
+	deltas.emplace_back(key, true);
+
+	for (const auto& v : value.m_items)
+	{
+		if (v.second.m_visible)
+			raise(v.second.m_child, deltas);
+	}
+}
+
+void scene_graph::lower(const source_key& key, delta_list& deltas)
+{
+	//Gone already, e.g. a removed scene still shown by an item that is removed after it
+	auto it = m_nodes.find(key);
+	if (it == m_nodes.end() || !it->second.m_on_air)
+		return;
+
+	auto& value = it->second;
+	if (--value.m_on_air)
+		return;
+
+	deltas.emplace_back(key, false);
+
+	for (const auto& v : value.m_items)
+	{
+		if (v.second.m_visible)
+			lower(v.second.m_child, deltas);
+	}
+}
@@ -0,0 +1,93 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "source_key.h"
+
+//Which scenes are visible anywhere in the program output, nested scenes and groups included.
+//Every scene counts the visible items showing it inside scenes which are on air themselves (the program scene counts one extra),
+//so "is it on air" is a single lookup and a change only walks the part of the tree whose visibility actually flips.
+//Kept up to date from the scenes' item signals, the scene tree is only walked in full by reset().
+class scene_graph
+{
+	public:
+		//A scene which became visible (true) or invisible (false) in the program output
+		using delta = std::pair<source_key, bool>;
+		using delta_list = std::vector<delta>;
+
+		scene_graph();
+
+		//No copying
+		scene_graph(const scene_graph& other) = delete;
+		scene_graph& operator = (const scene_graph& other) = delete;
+
+	public:
+		//Rebuilds the items of all given scenes and groups, the program scene stays
+		void reset(obs_source_t* const* scenes, size_t count, delta_list& deltas);
+		void clear();
+
+		void set_program(const source_key& key, delta_list& deltas);
+
+		//Items showing anything but a scene or group are ignored
+		void add_item(const source_key& parent, int64_t item, const source_key& child, bool visible, delta_list& deltas);
+		void remove_item(const source_key& parent, int64_t item, delta_list& deltas);
+		void set_item_visible(const source_key& parent, int64_t item, bool visible, delta_list& deltas);
+
+		//The scene is gone, so are its items
+		void remove_scene(const source_key& key, delta_list& deltas);
+
+		bool is_on_air(const source_key& key) const;
+		size_t size() const;
+
+		//Scenes and groups are the only sources with items of their own
+		static inline bool is_container(const obs_source_t* source) { return source && (obs_source_is_scene(source) || obs_source_is_group(source)); }
+
+	protected:
+
+	private:
+		struct item
+		{
+			source_key m_child;
+			bool m_visible = false;
+		};
+
+		struct node
+		{
+			//Visible items in on air scenes showing this one, plus one for the program scene
+			uint32_t m_on_air = 0;
+			std::unordered_map<int64_t, item> m_items;
+		};
+
+		//OBS refuses to nest a scene in itself, so the recursion always ends
+		void raise(const source_key& key, delta_list& deltas);
+		void lower(const source_key& key, delta_list& deltas);
+
+		mutable std::mutex m_mutex;
+
+		std::unordered_map<source_key, node, source_key_hash> m_nodes;
+		source_key m_program;
+};
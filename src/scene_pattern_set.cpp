@@ -0,0 +1,664 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "scene_pattern_set.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <deque>
+#include <limits>
+
+#include "recording_setting.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+constexpr uint32_t NO_STATE = std::numeric_limits<uint32_t>::max();
+
+//Anchors are compared ASCII case-insensitive, verification decides whether case matters
+static inline uint8_t fold(uint8_t c)
+{
+	return c >= 'A' && c <= 'Z' ? static_cast<uint8_t>(c - 'A' + 'a') : c;
+}
+
+static std::string fold(std::string_view text)
+{
+	std::string result;
+	result.reserve(text.size());
+
+	for (auto c : text)
+		result.push_back(static_cast<char>(fold(static_cast<uint8_t>(c))));
+
+	return result;
+}
+
+static inline uint32_t lowest_bit(uint64_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return static_cast<uint32_t>(index);
+#else
+	return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+}
+
+//UTF-8 continuation bytes belong to the code point before them
+static inline size_t next_code_point(std::string_view text, size_t index)
+{
+	++index;
+	while (index < text.size() && (static_cast<uint8_t>(text[index]) & 0xC0) == 0x80)
+		++index;
+
+	return index;
+}
+
+//'*' matches any run, '?' exactly one code point, everything else itself
+static bool wildcard_match(std::string_view pattern, std::string_view name)
+{
+	size_t p = 0;
+	size_t n = 0;
+	size_t star = std::string_view::npos;
+	size_t mark = 0;
+
+	while (n < name.size())
+	{
+		if (p < pattern.size() && pattern[p] == '?')
+		{
+			++p;
+			n = next_code_point(name, n);
+		}
+		else if (p < pattern.size() && pattern[p] == '*')
+		{
+			star = p++;
+			mark = n;
+		}
+		else if (p < pattern.size() && pattern[p] == name[n])
+		{
+			++p;
+			++n;
+		}
+		else if (star != std::string_view::npos)
+		{
+			//Let the last star swallow one more code point and try again from there
+			p = star + 1;
+			mark = next_code_point(name, mark);
+			n = mark;
+		}
+		else
+			return false;
+	}
+
+	while (p < pattern.size() && pattern[p] == '*')
+		++p;
+
+	return p == pattern.size();
+}
+
+static inline bool is_word(uint8_t c)
+{
+	return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '-' || c >= 0x80;
+}
+
+//"#tag" somewhere in the name, not followed by further word characters
+static bool tag_match(std::string_view tag, std::string_view name)
+{
+	for (size_t i = 0; i + tag.size() < name.size(); ++i)
+	{
+		if (name[i] != '#')
+			continue;
+
+		if (i > 0 && is_word(static_cast<uint8_t>(name[i - 1])))
+			continue;
+
+		bool equal = true;
+		for (size_t j = 0; j < tag.size() && equal; ++j)
+			equal = fold(static_cast<uint8_t>(name[i + 1 + j])) == static_cast<uint8_t>(tag[j]);
+
+		auto end = i + 1 + tag.size();
+		if (equal && (end == name.size() || !is_word(static_cast<uint8_t>(name[end]))))
+			return true;
+	}
+
+	return false;
+}
+
+//Skips a bracket expression starting at index, returns the index behind it
+static size_t skip_class(std::string_view text, size_t index)
+{
+	++index;
+	if (index < text.size() && text[index] == '^')
+		++index;
+
+	while (index < text.size() && text[index] != ']')
+		index += text[index] == '\\' ? 2 : 1;
+
+	return std::min(index + 1, text.size());
+}
+
+//Skips a group starting at index including everything nested in it, returns the index behind it
+static size_t skip_group(std::string_view text, size_t index)
+{
+	size_t depth = 0;
+
+	while (index < text.size())
+	{
+		switch (text[index])
+		{
+			case '\\':
+			{
+				index += 2;
+			}
+			continue;
+
+			case '[':
+			{
+				index = skip_class(text, index);
+			}
+			continue;
+
+			case '(':
+			{
+				++depth;
+			}
+			break;
+
+			case ')':
+			{
+				if (--depth == 0)
+					return index + 1;
+			}
+			break;
+
+			default:
+			{
+
+			}
+			break;
+		}
+
+		++index;
+	}
+
+	return index;
+}
+
+//The longest run of literal characters every match of an ECMAScript expression has to contain, empty if there is none.
+//Anything the scan does not understand ends the current run, so a run it returns is always required.
+static std::string regex_literal(std::string_view text)
+{
+	//An alternative on the top level may match without any of the literals
+	for (size_t i = 0; i < text.size(); ++i)
+	{
+		if (text[i] == '\\')
+			++i;
+		else if (text[i] == '[')
+			i = skip_class(text, i) - 1;
+		else if (text[i] == '(')
+			i = skip_group(text, i) - 1;
+		else if (text[i] == '|')
+			return {};
+	}
+
+	//Literal bytes collected since the last thing which was not one, escaped punctuation is copied without its backslash
+	std::string run;
+	std::string best;
+
+	auto end_run = [&run, &best]() -> void
+		{
+			if (run.size() > best.size())
+				best = run;
+
+			run.clear();
+		};
+
+	size_t i = 0;
+	while (i < text.size())
+	{
+		char literal = 0;
+		bool is_literal = false;
+
+		switch (text[i])
+		{
+			case '\\':
+			{
+				//Escaped letters and digits are classes, assertions or back references
+				if (i + 1 < text.size() && !std::isalnum(static_cast<unsigned char>(text[i + 1])))
+				{
+					literal = text[i + 1];
+					is_literal = true;
+				}
+
+				i = std::min(i + 2, text.size());
+			}
+			break;
+
+			case '[':
+			{
+				i = skip_class(text, i);
+			}
+			break;
+
+			case '(':
+			{
+				i = skip_group(text, i);
+			}
+			break;
+
+			case '.':
+			case '^':
+			case '$':
+			case ')':
+			case '*':
+			case '+':
+			case '?':
+			{
+				++i;
+			}
+			break;
+
+			case '{':
+			{
+				auto close = text.find('}', i);
+				i = close == std::string_view::npos ? text.size() : close + 1;
+			}
+			break;
+
+			default:
+			{
+				literal = text[i];
+				is_literal = true;
+				++i;
+			}
+			break;
+		}
+
+		if (!is_literal)
+		{
+			end_run();
+			continue;
+		}
+
+		//A quantifier belongs to the character in front of it
+		auto next = i < text.size() ? text[i] : '\0';
+		bool optional = next == '?' || next == '*' || (next == '{' && i + 1 < text.size() && text[i + 1] == '0');
+		bool repeated = next == '+' || next == '{';
+
+		if (optional)
+		{
+			end_run();
+			continue;
+		}
+
+		run.push_back(literal);
+
+		if (repeated)
+			end_run();
+	}
+
+	end_run();
+
+	return best;
+}
+
+static std::string_view tag_text(std::string_view text)
+{
+	if (!text.empty() && text.front() == '#')
+		text.remove_prefix(1);
+
+	return text;
+}
+
+scene_pattern_set::scene_pattern_set()
+	: m_class_count{ 1 }
+{
+	std::memset(m_byte_class, 0, sizeof(m_byte_class));
+}
+
+bool scene_pattern_set::valid(const recording_setting& setting)
+{
+	switch (setting.get_match())
+	{
+		case recording_setting::match::wildcard:
+		{
+			return !setting.get_scene_name().empty();
+		}
+
+		case recording_setting::match::regex:
+		{
+			if (setting.get_scene_name().empty())
+				return false;
+
+			try
+			{
+				std::regex regex{ setting.get_scene_name(), std::regex::ECMAScript };
+			}
+			catch (const std::regex_error&)
+			{
+				return false;
+			}
+
+			return true;
+		}
+
+		case recording_setting::match::tag:
+		{
+			auto tag = tag_text(setting.get_scene_name());
+
+			return !tag.empty() && std::none_of(tag.begin(), tag.end(), [](char c) -> bool {return !is_word(static_cast<uint8_t>(c)); });
+		}
+
+		default:
+		{
+
+		}
+		break;
+	}
+
+	return true;
+}
+
+std::string scene_pattern_set::anchor_of(const recording_setting& setting, const std::string& text)
+{
+	switch (setting.get_match())
+	{
+		case recording_setting::match::wildcard:
+		{
+			//The longest literal run, every name matching the pattern contains it
+			std::string_view best;
+			size_t start = 0;
+
+			for (size_t i = 0; i <= text.size(); ++i)
+			{
+				if (i < text.size() && text[i] != '*' && text[i] != '?')
+					continue;
+
+				if (i - start > best.size())
+					best = std::string_view{ text }.substr(start, i - start);
+
+				start = i + 1;
+			}
+
+			return fold(best);
+		}
+
+		case recording_setting::match::regex:
+		{
+			return fold(regex_literal(text));
+		}
+
+		case recording_setting::match::tag:
+		{
+			return "#" + text;
+		}
+
+		default:
+		{
+
+		}
+		break;
+	}
+
+	return {};
+}
+
+bool scene_pattern_set::anchored(const recording_setting& setting)
+{
+	auto text = setting.get_match() == recording_setting::match::tag ? fold(tag_text(setting.get_scene_name())) : setting.get_scene_name();
+
+	return !anchor_of(setting, text).empty();
+}
+
+void scene_pattern_set::build(const std::vector<recording_setting>& settings)
+{
+	m_patterns.clear();
+
+	for (const auto& v : settings)
+	{
+		if (!v.is_pattern() || v.is_sequence() || !valid(v))
+			continue;
+
+		pattern p;
+		p.m_setting = &v;
+		p.m_text = v.get_match() == recording_setting::match::tag ? fold(tag_text(v.get_scene_name())) : v.get_scene_name();
+		p.m_anchor = anchor_of(v, p.m_text);
+
+		if (v.get_match() == recording_setting::match::regex)
+			p.m_regex = std::regex{ p.m_text, std::regex::ECMAScript | std::regex::optimize };
+
+		m_patterns.push_back(std::move(p));
+	}
+
+	//Equal priorities prefer the more specific pattern, then the rule listed first
+	std::stable_sort(m_patterns.begin(), m_patterns.end(), [](const pattern& lhs, const pattern& rhs) -> bool
+		{
+			if (lhs.m_setting->get_priority() != rhs.m_setting->get_priority())
+				return lhs.m_setting->get_priority() > rhs.m_setting->get_priority();
+
+			return lhs.m_anchor.size() > rhs.m_anchor.size();
+		});
+
+	compile();
+}
+
+void scene_pattern_set::compile()
+{
+	m_unanchored.clear();
+	m_transitions.clear();
+	m_output_offsets.clear();
+	m_outputs.clear();
+	std::memset(m_byte_class, 0, sizeof(m_byte_class));
+	m_class_count = 1;
+
+	uint8_t folded_class[256] = {};
+	for (const auto& p : m_patterns)
+	{
+		for (auto c : p.m_anchor)
+		{
+			auto& cls = folded_class[static_cast<uint8_t>(c)];
+			if (!cls)
+				cls = static_cast<uint8_t>(m_class_count++);
+		}
+	}
+
+	//Folding is baked into the class table, matching never folds
+	for (size_t c = 0; c < 256; ++c)
+		m_byte_class[c] = folded_class[fold(static_cast<uint8_t>(c))];
+
+	//Trie of all anchors
+	std::vector<uint32_t> transitions(m_class_count, NO_STATE);
+	std::vector<std::vector<uint32_t>> outputs(1);
+
+	for (uint32_t rank = 0; rank < m_patterns.size(); ++rank)
+	{
+		const auto& anchor = m_patterns[rank].m_anchor;
+		if (anchor.empty())
+		{
+			m_unanchored.push_back(rank);
+			continue;
+		}
+
+		uint32_t state = 0;
+		for (auto c : anchor)
+		{
+			auto& next = transitions[state * m_class_count + folded_class[static_cast<uint8_t>(c)]];
+			if (next == NO_STATE)
+			{
+				next = static_cast<uint32_t>(outputs.size());
+				outputs.emplace_back();
+				transitions.resize(transitions.size() + m_class_count, NO_STATE);
+			}
+
+			state = transitions[state * m_class_count + folded_class[static_cast<uint8_t>(c)]];
+		}
+
+		outputs[state].push_back(rank);
+	}
+
+	//Breadth first, so the failure state of every state is complete before the state itself
+	std::vector<uint32_t> failure(outputs.size(), 0);
+	std::deque<uint32_t> queue;
+
+	for (uint32_t c = 0; c < m_class_count; ++c)
+	{
+		auto& next = transitions[c];
+		if (next == NO_STATE)
+			next = 0;
+		else
+			queue.push_back(next);
+	}
+
+	while (!queue.empty())
+	{
+		auto state = queue.front();
+		queue.pop_front();
+
+		const auto& inherited = outputs[failure[state]];
+		outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+
+		for (uint32_t c = 0; c < m_class_count; ++c)
+		{
+			auto& next = transitions[state * m_class_count + c];
+			auto fallback = transitions[failure[state] * m_class_count + c];
+
+			if (next == NO_STATE)
+				next = fallback;
+			else
+			{
+				failure[next] = fallback;
+				queue.push_back(next);
+			}
+		}
+	}
+
+	if (outputs.size() > 1)
+		m_transitions = std::move(transitions);
+
+	m_output_offsets.reserve(outputs.size() + 1);
+	for (const auto& v : outputs)
+	{
+		m_output_offsets.push_back(static_cast<uint32_t>(m_outputs.size()));
+		m_outputs.insert(m_outputs.end(), v.begin(), v.end());
+	}
+
+	m_output_offsets.push_back(static_cast<uint32_t>(m_outputs.size()));
+}
+
+const recording_setting* scene_pattern_set::match(std::string_view name) const
+{
+	if (m_patterns.empty())
+		return nullptr;
+
+	//One bit per rank, reused by every set matching on this thread. Only the words in between first and last get set,
+	//and they are all zero again when we leave, so there is nothing to clear up front and nothing to sort.
+	thread_local std::vector<uint64_t> candidates;
+	if (candidates.size() < (m_patterns.size() + 63) / 64)
+		candidates.resize((m_patterns.size() + 63) / 64);
+
+	size_t first = candidates.size();
+	size_t last = 0;
+
+	auto add = [&first, &last](uint32_t rank) -> void
+		{
+			candidates[rank / 64] |= uint64_t{ 1 } << (rank % 64);
+			first = std::min<size_t>(first, rank / 64);
+			last = std::max<size_t>(last, rank / 64);
+		};
+
+	for (auto rank : m_unanchored)
+		add(rank);
+
+	if (!m_transitions.empty())
+	{
+		uint32_t state = 0;
+
+		for (auto c : name)
+		{
+			state = m_transitions[state * m_class_count + m_byte_class[static_cast<uint8_t>(c)]];
+
+			for (auto i = m_output_offsets[state]; i < m_output_offsets[state + 1]; ++i)
+				add(m_outputs[i]);
+		}
+	}
+
+	//Lower rank wins, so the first verified candidate is the answer
+	const recording_setting* result = nullptr;
+
+	for (auto word = first; word <= last && word < candidates.size(); ++word)
+	{
+		auto bits = candidates[word];
+		candidates[word] = 0;
+
+		while (bits && !result)
+		{
+			auto rank = static_cast<uint32_t>(word * 64 + lowest_bit(bits));
+			bits &= bits - 1;
+
+			const auto& p = m_patterns[rank];
+			if (verify(p, name))
+				result = p.m_setting;
+		}
+	}
+
+	return result;
+}
+
+bool scene_pattern_set::verify(const pattern& p, std::string_view name) const
+{
+	switch (p.m_setting->get_match())
+	{
+		case recording_setting::match::wildcard:
+		{
+			return wildcard_match(p.m_text, name);
+		}
+
+		case recording_setting::match::regex:
+		{
+			return std::regex_search(name.begin(), name.end(), p.m_regex);
+		}
+
+		case recording_setting::match::tag:
+		{
+			return tag_match(p.m_text, name);
+		}
+
+		default:
+		{
+
+		}
+		break;
+	}
+
+	return false;
+}
+
+size_t scene_pattern_set::memory_usage() const
+{
+	size_t result = m_patterns.capacity() * sizeof(pattern)
+		+ m_unanchored.capacity() * sizeof(uint32_t)
+		+ m_transitions.capacity() * sizeof(uint32_t)
+		+ m_output_offsets.capacity() * sizeof(uint32_t)
+		+ m_outputs.capacity() * sizeof(uint32_t);
+
+	for (const auto& v : m_patterns)
+		result += v.m_text.capacity() + v.m_anchor.capacity();
+
+	return result;
+}
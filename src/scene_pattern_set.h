@@ -0,0 +1,89 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class recording_setting;
+
+//All pattern rules of a snapshot compiled into one Aho-Corasick automaton over their literal anchors.
+//A single pass over the scene name yields every candidate, candidates are then verified in precedence order
+//(priority, then the longer anchor, then rule order) until the first one actually matches.
+//Immutable after build(), so any number of threads may match concurrently.
+class scene_pattern_set
+{
+	public:
+		scene_pattern_set();
+
+		//No copying, the patterns point into the owner's settings
+		scene_pattern_set(const scene_pattern_set& other) = delete;
+		scene_pattern_set& operator = (const scene_pattern_set& other) = delete;
+
+	public:
+		//Takes every wildcard, regex and tag rule out of settings, which have to outlive the set. Invalid patterns are skipped.
+		void build(const std::vector<recording_setting>& settings);
+
+		const recording_setting* match(std::string_view name) const;
+
+		inline bool empty() const { return m_patterns.empty(); }
+		inline size_t size() const { return m_patterns.size(); }
+		size_t memory_usage() const;
+
+		//Checks a pattern the way build() would, so editors can refuse it up front
+		static bool valid(const recording_setting& setting);
+		//Whether the pattern has a literal every match contains. Patterns without one are verified against every name.
+		static bool anchored(const recording_setting& setting);
+
+	protected:
+
+	private:
+		struct pattern
+		{
+			const recording_setting* m_setting = nullptr;
+			std::string m_text;		//without a leading '#' for tags
+			std::string m_anchor;	//folded literal every match has to contain, empty if there is none
+			std::regex m_regex;
+		};
+
+		static std::string anchor_of(const recording_setting& setting, const std::string& text);
+		bool verify(const pattern& p, std::string_view name) const;
+
+		void compile();
+
+		//Sorted by precedence, the index is the rank
+		std::vector<pattern> m_patterns;
+
+		//Ranks without an anchor are candidates for every name
+		std::vector<uint32_t> m_unanchored;
+
+		//Bytes never seen in an anchor share class 0, so a state only needs one column per distinct byte
+		uint8_t m_byte_class[256];
+		uint32_t m_class_count;
+
+		//Complete transition function, m_transitions[state * m_class_count + class]
+		std::vector<uint32_t> m_transitions;
+
+		//Ranks whose anchor ends in a state, including those reached through failure links
+		std::vector<uint32_t> m_output_offsets;
+		std::vector<uint32_t> m_outputs;
+};
@@ -0,0 +1,137 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "scene_rule_table.h"
+
+constexpr size_t MIN_CAPACITY = 16;
+
+scene_rule_table::scene_rule_table()
+	: m_entries(MIN_CAPACITY)
+	, m_size{ 0 }
+{ }
+
+void scene_rule_table::clear()
+{
+	m_entries.assign(MIN_CAPACITY, entry{});
+	m_size = 0;
+}
+
+void scene_rule_table::reserve(size_t count)
+{
+	size_t capacity = MIN_CAPACITY;
+	while (capacity < count * 2)
+		capacity <<= 1;
+
+	if (capacity > m_entries.size())
+		grow(capacity);
+}
+
+void scene_rule_table::insert(const source_key& key, const recording_setting* value)
+{
+	//An invalid key marks an empty slot, it can not be stored
+	if (!key.valid())
+		return;
+
+	if ((m_size + 1) * 2 > m_entries.size())
+		grow(m_entries.size() * 2);
+
+	for (size_t i = key.hash() & mask();; i = (i + 1) & mask())
+	{
+		auto& v = m_entries[i];
+
+		if (!v.m_key.valid())
+		{
+			v.m_key = key;
+			v.m_value = value;
+			++m_size;
+
+			return;
+		}
+
+		if (v.m_key == key)
+		{
+			v.m_value = value;
+			return;
+		}
+	}
+}
+
+bool scene_rule_table::erase(const source_key& key)
+{
+	if (!key.valid())
+		return false;
+
+	size_t i = key.hash() & mask();
+	while (m_entries[i].m_key != key)
+	{
+		if (!m_entries[i].m_key.valid())
+			return false;
+
+		i = (i + 1) & mask();
+	}
+
+	//Backward shift deletion, so no tombstones pile up and probe chains stay short
+	for (size_t j = (i + 1) & mask(); m_entries[j].m_key.valid(); j = (j + 1) & mask())
+	{
+		size_t home = m_entries[j].m_key.hash() & mask();
+
+		//Move j into the hole at i unless its home lies cyclically in (i, j]
+		bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+		if (stays)
+			continue;
+
+		m_entries[i] = m_entries[j];
+		i = j;
+	}
+
+	m_entries[i] = entry{};
+	--m_size;
+
+	return true;
+}
+
+const recording_setting* scene_rule_table::find(const source_key& key) const
+{
+	if (!key.valid())
+		return nullptr;
+
+	for (size_t i = key.hash() & mask();; i = (i + 1) & mask())
+	{
+		const auto& v = m_entries[i];
+
+		if (v.m_key == key)
+			return v.m_value;
+
+		if (!v.m_key.valid())
+			return nullptr;
+	}
+}
+
+void scene_rule_table::grow(size_t capacity)
+{
+	auto old_entries = std::move(m_entries);
+
+	m_entries.assign(capacity, entry{});
+	m_size = 0;
+
+	for (const auto& v : old_entries)
+	{
+		if (v.m_key.valid())
+			insert(v.m_key, v.m_value);
+	}
+}
@@ -0,0 +1,61 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "source_key.h"
+
+class recording_setting;
+
+//Open addressing table from scene identity to rule.
+//Linear probing over a power of two sized array, kept at most half full. Lookups never allocate.
+class scene_rule_table
+{
+	public:
+		scene_rule_table();
+
+	public:
+		void clear();
+		void reserve(size_t count);
+
+		void insert(const source_key& key, const recording_setting* value);
+		bool erase(const source_key& key);
+		const recording_setting* find(const source_key& key) const;
+
+		inline size_t size() const { return m_size; }
+		inline bool empty() const { return m_size == 0; }
+		inline size_t memory_usage() const { return m_entries.capacity() * sizeof(entry); }
+
+	protected:
+
+	private:
+		struct entry
+		{
+			source_key m_key;
+			const recording_setting* m_value = nullptr;
+		};
+
+		inline size_t mask() const { return m_entries.size() - 1; }
+		void grow(size_t capacity);
+
+		std::vector<entry> m_entries;
+		size_t m_size;
+};
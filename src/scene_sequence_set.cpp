@@ -0,0 +1,384 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "scene_sequence_set.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "recording_setting.h"
+
+static std::string_view trim(std::string_view text)
+{
+	while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+		text.remove_prefix(1);
+
+	while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+		text.remove_suffix(1);
+
+	return text;
+}
+
+scene_sequence_set::scene_sequence_set()
+	: m_slot_count{ 0 }
+{ }
+
+std::vector<std::string_view> scene_sequence_set::split_steps(std::string_view text)
+{
+	std::vector<std::string_view> result;
+
+	for (;;)
+	{
+		auto end = text.find('>');
+		result.push_back(trim(text.substr(0, end)));
+
+		if (end == std::string_view::npos)
+			break;
+
+		text.remove_prefix(end + 1);
+	}
+
+	return result;
+}
+
+bool scene_sequence_set::rename(recording_setting& setting, std::string_view old_name, std::string_view new_name)
+{
+	if (!setting.is_sequence() || old_name.empty())
+		return false;
+
+	std::vector<std::string_view> steps;
+	if (setting.get_match() == recording_setting::match::dwell)
+		steps.push_back(trim(setting.get_scene_name()));
+	else
+		steps = split_steps(setting.get_scene_name());
+
+	if (std::find(steps.begin(), steps.end(), old_name) == steps.end())
+		return false;
+
+	std::string text;
+	for (auto v : steps)
+	{
+		if (!text.empty())
+			text += " > ";
+
+		text += v == old_name ? new_name : v;
+	}
+
+	setting.set_scene_name(text);
+
+	return true;
+}
+
+bool scene_sequence_set::valid(const recording_setting& setting)
+{
+	switch (setting.get_match())
+	{
+		case recording_setting::match::sequence:
+		{
+			auto steps = split_steps(setting.get_scene_name());
+			return std::none_of(steps.begin(), steps.end(), [](std::string_view v) -> bool {return v.empty(); });
+		}
+
+		case recording_setting::match::dwell:
+		{
+			return !trim(setting.get_scene_name()).empty();
+		}
+
+		default:
+		{
+
+		}
+		break;
+	}
+
+	return false;
+}
+
+void scene_sequence_set::build(const std::vector<recording_setting>& settings)
+{
+	m_patterns.clear();
+	m_steps.clear();
+	m_symbols.clear();
+	m_start_offsets.clear();
+	m_starts.clear();
+	m_slot_count = 0;
+
+	std::vector<std::vector<std::string_view>> step_names;
+
+	for (const auto& v : settings)
+	{
+		if (!v.is_sequence() || !valid(v))
+			continue;
+
+		pattern p;
+		p.m_setting = &v;
+		p.m_dwell = v.get_match() == recording_setting::match::dwell;
+
+		//A dwell rule is a single step, its name may contain anything
+		if (p.m_dwell)
+			step_names.push_back({ trim(v.get_scene_name()) });
+		else
+			step_names.push_back(split_steps(v.get_scene_name()));
+
+		m_patterns.push_back(p);
+
+		for (auto name : step_names.back())
+			m_symbols.emplace_back(std::string{ name }, 0);
+	}
+
+	std::sort(m_symbols.begin(), m_symbols.end());
+	m_symbols.erase(std::unique(m_symbols.begin(), m_symbols.end()), m_symbols.end());
+
+	for (uint32_t i = 0; i < m_symbols.size(); ++i)
+		m_symbols[i].second = i;
+
+	std::vector<std::vector<uint32_t>> starts(m_symbols.size());
+
+	for (uint32_t i = 0; i < m_patterns.size(); ++i)
+	{
+		auto& p = m_patterns[i];
+		p.m_first_step = static_cast<uint32_t>(m_steps.size());
+		p.m_step_count = static_cast<uint32_t>(step_names[i].size());
+		p.m_slot_offset = m_slot_count;
+		m_slot_count += p.m_step_count;
+
+		for (auto name : step_names[i])
+			m_steps.push_back(symbol(name));
+
+		starts[m_steps[p.m_first_step]].push_back(i);
+	}
+
+	for (const auto& v : starts)
+	{
+		m_start_offsets.push_back(static_cast<uint32_t>(m_starts.size()));
+		m_starts.insert(m_starts.end(), v.begin(), v.end());
+	}
+
+	m_start_offsets.push_back(static_cast<uint32_t>(m_starts.size()));
+}
+
+uint32_t scene_sequence_set::symbol(std::string_view name) const
+{
+	auto it = std::lower_bound(m_symbols.begin(), m_symbols.end(), name, [](const std::pair<std::string, uint32_t>& lhs, std::string_view rhs) -> bool
+		{
+			return std::string_view{ lhs.first } < rhs;
+		});
+
+	if (it == m_symbols.end() || it->first != name)
+		return NO_SYMBOL;
+
+	return it->second;
+}
+
+size_t scene_sequence_set::memory_usage() const
+{
+	size_t result = m_patterns.capacity() * sizeof(pattern)
+		+ m_steps.capacity() * sizeof(uint32_t)
+		+ m_symbols.capacity() * sizeof(std::pair<std::string, uint32_t>)
+		+ m_start_offsets.capacity() * sizeof(uint32_t)
+		+ m_starts.capacity() * sizeof(uint32_t);
+
+	for (const auto& v : m_symbols)
+		result += v.first.capacity();
+
+	return result;
+}
+
+scene_sequence_matcher::scene_sequence_matcher()
+	: m_version{ std::numeric_limits<uint64_t>::max() }
+{ }
+
+void scene_sequence_matcher::reset()
+{
+	m_partials.clear();
+	m_slots.clear();
+	m_deferred.clear();
+	m_version = std::numeric_limits<uint64_t>::max();
+}
+
+scene_sequence_matcher::result scene_sequence_matcher::advance(const scene_sequence_set& set, uint64_t version, std::string_view name, clock::time_point time)
+{
+	if (version != m_version)
+	{
+		m_partials.clear();
+		m_slots.assign(set.m_slot_count, NO_PARTIAL);
+		m_version = version;
+	}
+
+	result result;
+	auto symbol = set.symbol(name);
+
+	//Highest priority wins, then the rule listed first
+	constexpr uint32_t NO_PATTERN = std::numeric_limits<uint32_t>::max();
+
+	uint32_t winner = NO_PATTERN;
+	auto complete = [&set, &winner](uint32_t pattern) -> void
+		{
+			if (winner == NO_PATTERN)
+			{
+				winner = pattern;
+				return;
+			}
+
+			auto priority = set.m_patterns[pattern].m_setting->get_priority();
+			auto winner_priority = set.m_patterns[winner].m_setting->get_priority();
+
+			if (priority > winner_priority || (priority == winner_priority && pattern < winner))
+				winner = pattern;
+		};
+
+	//New partials are only added after this loop and blocked moves wait for the partial ahead, so none advances twice with the same scene change
+	for (size_t i = 0; i < m_partials.size();)
+	{
+		auto& p = m_partials[i];
+		const auto& pattern = set.m_patterns[p.m_pattern];
+		auto window = std::chrono::milliseconds{ pattern.m_setting->get_window() };
+
+		if (pattern.m_dwell)
+		{
+			//Every scene change leaves the dwelling scene, the action is withdrawn unless it ran already
+			auto deadline = p.m_start + window + std::chrono::milliseconds{ pattern.m_setting->get_trigger_time() };
+			if (time < deadline)
+				result.m_withdraw = true;
+
+			remove(set, i);
+			continue;
+		}
+
+		if (window.count() && time - p.m_start > window)
+		{
+			remove(set, i);
+			continue;
+		}
+
+		if (symbol == scene_sequence_set::NO_SYMBOL || set.m_steps[pattern.m_first_step + p.m_state] != symbol)
+		{
+			++i;
+			continue;
+		}
+
+		auto next = p.m_state + 1;
+		if (next == pattern.m_step_count)
+		{
+			complete(p.m_pattern);
+			remove(set, i);
+			continue;
+		}
+
+		auto& target = m_slots[pattern.m_slot_offset + next];
+
+		//With two equal steps in a row the partial ahead takes this scene as well. Merging now would let it advance twice,
+		//so this one waits until every partial of the scene change moved.
+		if (target != NO_PARTIAL && set.m_steps[pattern.m_first_step + next] == symbol)
+		{
+			m_deferred.push_back(static_cast<uint32_t>(i));
+			++i;
+			continue;
+		}
+
+		if (target != NO_PARTIAL)
+		{
+			auto& other = m_partials[target];
+			other.m_start = std::max(other.m_start, p.m_start);
+
+			remove(set, i);
+			continue;
+		}
+
+		m_slots[pattern.m_slot_offset + p.m_state] = NO_PARTIAL;
+		target = static_cast<uint32_t>(i);
+		p.m_state = next;
+		++i;
+	}
+
+	//Highest state first, each one frees the slot the one behind it moves into. Nothing is removed here, so the indices hold.
+	if (!m_deferred.empty())
+	{
+		std::sort(m_deferred.begin(), m_deferred.end(), [this](uint32_t lhs, uint32_t rhs) -> bool {return m_partials[lhs].m_state > m_partials[rhs].m_state; });
+
+		for (auto index : m_deferred)
+		{
+			auto& p = m_partials[index];
+			const auto& pattern = set.m_patterns[p.m_pattern];
+
+			m_slots[pattern.m_slot_offset + p.m_state] = NO_PARTIAL;
+			++p.m_state;
+			m_slots[pattern.m_slot_offset + p.m_state] = index;
+		}
+
+		m_deferred.clear();
+	}
+
+	if (symbol != scene_sequence_set::NO_SYMBOL)
+	{
+		for (auto index = set.m_start_offsets[symbol]; index < set.m_start_offsets[symbol + 1]; ++index)
+		{
+			auto pattern_index = set.m_starts[index];
+			const auto& pattern = set.m_patterns[pattern_index];
+
+			if (pattern.m_step_count == 1)
+			{
+				complete(pattern_index);
+				continue;
+			}
+
+			auto& slot = m_slots[pattern.m_slot_offset + 1];
+			if (slot != NO_PARTIAL)
+			{
+				m_partials[slot].m_start = time;
+				continue;
+			}
+
+			slot = static_cast<uint32_t>(m_partials.size());
+			m_partials.push_back(partial{ pattern_index, 1, time });
+		}
+	}
+
+	if (winner == NO_PATTERN)
+		return result;
+
+	//Only the winning dwell rule has an action to withdraw later
+	const auto& pattern = set.m_patterns[winner];
+	if (pattern.m_dwell)
+	{
+		m_slots[pattern.m_slot_offset] = static_cast<uint32_t>(m_partials.size());
+		m_partials.push_back(partial{ winner, 0, time });
+	}
+
+	result.m_rule = pattern.m_setting;
+
+	return result;
+}
+
+void scene_sequence_matcher::remove(const scene_sequence_set& set, size_t index)
+{
+	auto slot_of = [&set](const partial& p) -> uint32_t
+		{
+			return set.m_patterns[p.m_pattern].m_slot_offset + p.m_state;
+		};
+
+	m_slots[slot_of(m_partials[index])] = NO_PARTIAL;
+
+	if (index + 1 != m_partials.size())
+	{
+		m_partials[index] = m_partials.back();
+		m_slots[slot_of(m_partials[index])] = static_cast<uint32_t>(index);
+	}
+
+	m_partials.pop_back();
+}
@@ -0,0 +1,142 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class recording_setting;
+
+//Sequence and dwell rules of a snapshot compiled into small NFAs over the scene names they mention.
+//Each step of a rule is one state, names are interned once, so a scene change costs one lookup
+//plus the partial matches it touches. Immutable after build(), the matching state lives in scene_sequence_matcher.
+class scene_sequence_set
+{
+	public:
+		static constexpr uint32_t NO_SYMBOL = UINT32_MAX;
+
+		scene_sequence_set();
+
+		//No copying, the patterns point into the owner's settings
+		scene_sequence_set(const scene_sequence_set& other) = delete;
+		scene_sequence_set& operator = (const scene_sequence_set& other) = delete;
+
+	public:
+		//Takes every sequence and dwell rule out of settings, which have to outlive the set. Invalid rules are skipped.
+		void build(const std::vector<recording_setting>& settings);
+
+		//The interned scene name, NO_SYMBOL if no rule mentions it
+		uint32_t symbol(std::string_view name) const;
+
+		inline bool empty() const { return m_patterns.empty(); }
+		inline size_t size() const { return m_patterns.size(); }
+		size_t memory_usage() const;
+
+		static bool valid(const recording_setting& setting);
+
+		//"A > B > C" into its scene names, scene names containing '>' can not be part of a sequence
+		static std::vector<std::string_view> split_steps(std::string_view text);
+
+		//Steps name scenes, so they follow the scene when it is renamed. Returns whether the rule changed.
+		static bool rename(recording_setting& setting, std::string_view old_name, std::string_view new_name);
+
+	protected:
+
+	private:
+		friend class scene_sequence_matcher;
+
+		struct pattern
+		{
+			const recording_setting* m_setting = nullptr;
+			uint32_t m_first_step = 0;
+			uint32_t m_step_count = 0;
+			uint32_t m_slot_offset = 0;	//one slot per state in the matcher
+			bool m_dwell = false;
+		};
+
+		std::vector<pattern> m_patterns;
+
+		//Symbols of all steps, a pattern owns m_steps[m_first_step] .. m_steps[m_first_step + m_step_count - 1]
+		std::vector<uint32_t> m_steps;
+
+		//Sorted by name, so lookups need no allocation
+		std::vector<std::pair<std::string, uint32_t>> m_symbols;
+
+		//Patterns whose first step is a symbol, m_starts[m_start_offsets[symbol]] .. m_starts[m_start_offsets[symbol + 1] - 1]
+		std::vector<uint32_t> m_start_offsets;
+		std::vector<uint32_t> m_starts;
+
+		uint32_t m_slot_count;
+};
+
+//Partial matches of one scene_sequence_set, advanced by every scene change.
+//Of two partial matches of the same rule in the same state the newer one can do everything the older one can,
+//so there is at most one per state. Not thread safe.
+class scene_sequence_matcher
+{
+	public:
+		using clock = std::chrono::steady_clock;
+
+		struct result
+		{
+			const recording_setting* m_rule = nullptr;	//completed rule that won, if any
+			bool m_withdraw = false;					//a dwell rule's scene was left before its action ran
+		};
+
+		scene_sequence_matcher();
+
+		//No copying
+		scene_sequence_matcher(const scene_sequence_matcher& other) = delete;
+		scene_sequence_matcher& operator = (const scene_sequence_matcher& other) = delete;
+
+	public:
+		//A set with another version than the last one starts over
+		result advance(const scene_sequence_set& set, uint64_t version, std::string_view name, clock::time_point time);
+		void reset();
+
+		inline size_t get_active() const { return m_partials.size(); }
+
+	protected:
+
+	private:
+		static constexpr uint32_t NO_PARTIAL = UINT32_MAX;
+
+		struct partial
+		{
+			uint32_t m_pattern;
+			uint32_t m_state;	//index of the step expected next, the dwelling step for dwell rules
+			clock::time_point m_start;
+		};
+
+		void remove(const scene_sequence_set& set, size_t index);
+
+		std::vector<partial> m_partials;
+
+		//Index into m_partials per pattern and state
+		std::vector<uint32_t> m_slots;
+
+		//Partials waiting for the one ahead of them to move, only used within advance()
+		std::vector<uint32_t> m_deferred;
+
+		uint64_t m_version;
+};
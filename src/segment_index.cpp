@@ -0,0 +1,477 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "segment_index.h"
+
+#include <obs-module.h>
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+
+#include "constants.h"
+
+static_assert(sizeof(segment_index::file_header) == 32 && sizeof(segment_index::file_record) == 40, "the file layout must not depend on padding");
+
+segment_index::segment_index()
+	: m_header{ nullptr }
+	, m_records{ nullptr }
+	, m_pool{ nullptr }
+{ }
+
+bool segment_index::open(const std::filesystem::path& path)
+{
+	close();
+
+	if (!m_file.open(path))
+		return false;
+
+	auto data = m_file.data();
+	auto file_size = m_file.size();
+
+	if (file_size < sizeof(file_header))
+	{
+		close();
+		return false;
+	}
+
+	auto header = reinterpret_cast<const file_header*>(data);
+
+	//An unfinished index (e.g. OBS crashed while recording) still has a record count of 0 and no pool
+	bool valid = header->m_magic == MAGIC
+		&& header->m_version >= 1
+		&& header->m_record_size >= sizeof(file_record)
+		&& file_size == sizeof(file_header) + static_cast<uint64_t>(header->m_record_count) * header->m_record_size + header->m_pool_size;
+
+	if (!valid)
+	{
+		close();
+		return false;
+	}
+
+	m_header = header;
+	m_records = data + sizeof(file_header);
+	m_pool = reinterpret_cast<const char*>(m_records + static_cast<size_t>(header->m_record_count) * header->m_record_size);
+
+	//find() relies on the order
+	for (size_t i = 0; i < size(); ++i)
+	{
+		const auto& r = record(i);
+		if (static_cast<uint64_t>(r.m_name_offset) + r.m_name_length > header->m_pool_size || (i && r.m_time < record(i - 1).m_time))
+		{
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void segment_index::close()
+{
+	m_file.close();
+
+	m_header = nullptr;
+	m_records = nullptr;
+	m_pool = nullptr;
+}
+
+size_t segment_index::size() const
+{
+	return m_header ? m_header->m_record_count : 0;
+}
+
+std::chrono::nanoseconds segment_index::get_duration() const
+{
+	return std::chrono::nanoseconds{ m_header ? m_header->m_duration : 0 };
+}
+
+std::chrono::nanoseconds segment_index::get_time(size_t index) const
+{
+	return std::chrono::nanoseconds{ record(index).m_time };
+}
+
+source_key segment_index::get_key(size_t index) const
+{
+	const auto& r = record(index);
+	return source_key{ r.m_key_high, r.m_key_low };
+}
+
+std::string_view segment_index::get_name(size_t index) const
+{
+	const auto& r = record(index);
+	return std::string_view{ m_pool + r.m_name_offset, r.m_name_length };
+}
+
+std::optional<recording_setting::action> segment_index::get_action(size_t index) const
+{
+	auto action = record(index).m_action;
+	if (action == NO_RULE)
+		return std::nullopt;
+
+	return static_cast<recording_setting::action>(action);
+}
+
+uint32_t segment_index::get_trigger_time(size_t index) const
+{
+	return record(index).m_trigger_time;
+}
+
+uint8_t segment_index::get_flags(size_t index) const
+{
+	return record(index).m_flags;
+}
+
+size_t segment_index::find(std::chrono::nanoseconds time) const
+{
+	//First entry after the time, the one before it was on air
+	size_t first = 0;
+	size_t count = size();
+
+	while (count)
+	{
+		auto step = count / 2;
+		if (record(first + step).m_time <= time.count())
+		{
+			first += step + 1;
+			count -= step + 1;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+
+	return first ? first - 1 : size();
+}
+
+const segment_index::file_record& segment_index::record(size_t index) const
+{
+	return *reinterpret_cast<const file_record*>(m_records + index * m_header->m_record_size);
+}
+
+segment_index_writer::segment_index_writer(chapter_function add_chapter)
+	: m_add_chapter{ add_chapter }
+	, m_sidecar{ false }
+	, m_chapters{ false }
+	, m_recording{ false }
+	, m_exit{ false }
+	, m_written{ 0 }
+	, m_dropped{ 0 }
+	, m_record_count{ 0 }
+	, m_file_start{ 0 }
+	, m_paused_total{ 0 }
+	, m_last_time{ 0 }
+	, m_running{ false }
+	, m_add_chapters{ false }
+	, m_thread{ &segment_index_writer::work, this }
+{ }
+
+segment_index_writer::~segment_index_writer()
+{
+	m_exit = true;
+	m_wake_writer.notify();
+
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+void segment_index_writer::set_enabled(bool sidecar, bool chapters)
+{
+	m_sidecar = sidecar;
+	m_chapters = chapters;
+}
+
+void segment_index_writer::begin_file(clock::time_point time, const std::string& recording_path)
+{
+	entry e{};
+	e.m_time = to_nanoseconds(time);
+	e.m_type = entry_type::begin_file;
+
+	//Held across the push, so the paths line up with the entries even if two threads begin a file at once
+	{
+		std::lock_guard<std::mutex> lock{ m_path_mutex };
+
+		m_pending_paths.push_back(recording_path);
+		if (!push(e))
+			m_pending_paths.pop_back();
+	}
+
+	m_recording = m_sidecar || m_chapters;
+}
+
+void segment_index_writer::end_file(clock::time_point time)
+{
+	m_recording = false;
+
+	entry e{};
+	e.m_time = to_nanoseconds(time);
+	e.m_type = entry_type::end_file;
+
+	push(e);
+}
+
+void segment_index_writer::pause(clock::time_point time)
+{
+	entry e{};
+	e.m_time = to_nanoseconds(time);
+	e.m_type = entry_type::pause;
+
+	push(e);
+}
+
+void segment_index_writer::unpause(clock::time_point time)
+{
+	entry e{};
+	e.m_time = to_nanoseconds(time);
+	e.m_type = entry_type::unpause;
+
+	push(e);
+}
+
+int64_t segment_index_writer::to_nanoseconds(clock::time_point time)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+bool segment_index_writer::push(const entry& e)
+{
+	if (!m_queue.try_push(e))
+	{
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	m_wake_writer.notify();
+
+	return true;
+}
+
+void segment_index_writer::push_scene(clock::time_point time, const source_key& key, std::string_view name, const recording_setting* rule, bool transition)
+{
+	entry e{};
+	e.m_time = to_nanoseconds(time);
+	e.m_type = entry_type::scene;
+	e.m_action = rule ? static_cast<uint8_t>(rule->get_action()) : segment_index::NO_RULE;
+	e.m_flags = transition ? segment_index::TRANSITION : 0;
+	e.m_trigger_time = rule ? rule->get_trigger_time() : 0;
+	e.m_key_high = key.get_high();
+	e.m_key_low = key.get_low();
+
+	size_t length = name.size();
+	if (length > NAME_CAPACITY)
+	{
+		//Never cut a UTF-8 sequence in half
+		length = NAME_CAPACITY;
+		while (length && (static_cast<uint8_t>(name[length]) & 0xC0) == 0x80)
+			--length;
+	}
+
+	std::memcpy(e.m_name, name.data(), length);
+	e.m_name_length = static_cast<uint8_t>(length);
+
+	push(e);
+}
+
+void segment_index_writer::work()
+{
+	while (!m_exit)
+	{
+		drain();
+		m_wake_writer.wait();
+	}
+
+	drain();
+	finish_file(to_nanoseconds(clock::now()));
+}
+
+void segment_index_writer::drain()
+{
+	entry e;
+	while (m_queue.try_pop(e))
+		apply(e);
+}
+
+void segment_index_writer::apply(const entry& e)
+{
+	switch (e.m_type)
+	{
+		case entry_type::begin_file:
+		{
+			std::string recording_path;
+			{
+				std::lock_guard<std::mutex> lock{ m_path_mutex };
+
+				recording_path = std::move(m_pending_paths.front());
+				m_pending_paths.pop_front();
+			}
+
+			//A file change of a running recording is a split, the scene on air simply continues in the new file
+			bool continuation = m_running;
+			if (!continuation)
+				m_last_scene.reset();
+
+			finish_file(e.m_time);
+
+			m_running = true;
+			m_add_chapters = m_chapters && m_add_chapter;
+			m_file_start = e.m_time;
+			m_paused_total = 0;
+			m_last_time = 0;
+
+			if (m_paused_since)
+				m_paused_since = e.m_time;
+
+			if (m_sidecar)
+				open_file(recording_path);
+
+			if (continuation && m_last_scene)
+				write_record(*m_last_scene, 0, m_last_scene->m_flags | segment_index::CONTINUATION);
+		}
+		break;
+
+		case entry_type::end_file:
+		{
+			finish_file(e.m_time);
+
+			m_running = false;
+			m_paused_since.reset();
+			m_last_scene.reset();
+		}
+		break;
+
+		case entry_type::pause:
+		{
+			if (!m_paused_since)
+				m_paused_since = e.m_time;
+		}
+		break;
+
+		case entry_type::unpause:
+		{
+			if (!m_paused_since)
+				return;
+
+			m_paused_total += e.m_time - *m_paused_since;
+			m_paused_since.reset();
+		}
+		break;
+
+		case entry_type::scene:
+		{
+			if (!m_running)
+				return;
+
+			//A transition start and the frontend event report the same scene change
+			if (m_last_scene && m_last_scene->m_key_high == e.m_key_high && m_last_scene->m_key_low == e.m_key_low)
+				return;
+
+			m_last_scene = e;
+
+			//Transition handlers run on several threads, the queue may hand us their entries slightly out of order
+			m_last_time = std::max(m_last_time, recording_time(e.m_time));
+			write_record(e, m_last_time, e.m_flags);
+
+			if (m_add_chapters && !m_add_chapter(std::string{ e.m_name, e.m_name_length }.c_str()))
+			{
+				m_add_chapters = false;
+				blog(LOG_INFO, "[%s] The recording output does not support chapter markers", PLUGIN_NAME_SHORT.data());
+			}
+		}
+		break;
+	}
+}
+
+void segment_index_writer::open_file(const std::string& recording_path)
+{
+	if (recording_path.empty())
+		return;
+
+	m_path = std::filesystem::u8path(recording_path + std::string{ segment_index::EXTENSION });
+	m_pool.clear();
+	m_pool_offsets.clear();
+	m_record_count = 0;
+
+	m_stream.open(m_path, std::ios::binary | std::ios::trunc);
+	if (!m_stream)
+	{
+		blog(LOG_WARNING, "[%s] Could not create the scene index %s", PLUGIN_NAME_SHORT.data(), m_path.u8string().c_str());
+		return;
+	}
+
+	//Finished with the real counts in finish_file()
+	segment_index::file_header header{ segment_index::MAGIC, segment_index::VERSION, sizeof(segment_index::file_record), 0, 0, 0, 0 };
+	m_stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void segment_index_writer::finish_file(int64_t time)
+{
+	if (!m_stream.is_open())
+		return;
+
+	m_stream.write(m_pool.data(), static_cast<std::streamsize>(m_pool.size()));
+
+	segment_index::file_header header{ segment_index::MAGIC, segment_index::VERSION, sizeof(segment_index::file_record), m_record_count, static_cast<uint32_t>(m_pool.size()), std::max(m_last_time, recording_time(time)), 0 };
+	m_stream.seekp(0);
+	m_stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	m_stream.close();
+
+	if (m_stream.fail())
+		blog(LOG_WARNING, "[%s] Could not write the scene index %s", PLUGIN_NAME_SHORT.data(), m_path.u8string().c_str());
+	else
+		blog(LOG_INFO, "[%s] Scene index with %u entries written to %s", PLUGIN_NAME_SHORT.data(), m_record_count, m_path.u8string().c_str());
+
+	m_stream.clear();
+}
+
+void segment_index_writer::write_record(const entry& e, int64_t recording_time, uint8_t flags)
+{
+	if (!m_stream.is_open())
+		return;
+
+	//Scene names repeat a lot, each one is stored once
+	std::string name{ e.m_name, e.m_name_length };
+	auto it = m_pool_offsets.find(name);
+	if (it == m_pool_offsets.end())
+	{
+		it = m_pool_offsets.emplace(name, static_cast<uint32_t>(m_pool.size())).first;
+		m_pool += name;
+	}
+
+	segment_index::file_record r{};
+	r.m_time = recording_time;
+	r.m_key_high = e.m_key_high;
+	r.m_key_low = e.m_key_low;
+	r.m_name_offset = it->second;
+	r.m_name_length = e.m_name_length;
+	r.m_action = e.m_action;
+	r.m_flags = flags;
+	r.m_trigger_time = e.m_trigger_time;
+
+	m_stream.write(reinterpret_cast<const char*>(&r), sizeof(r));
+
+	++m_record_count;
+	m_written.fetch_add(1, std::memory_order_relaxed);
+}
+
+int64_t segment_index_writer::recording_time(int64_t time) const
+{
+	auto paused = m_paused_total + (m_paused_since ? time - *m_paused_since : 0);
+
+	return std::max<int64_t>(0, time - m_file_start - paused);
+}
@@ -0,0 +1,227 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include "mapped_file.h"
+#include "mpsc_queue.h"
+#include "recording_setting.h"
+#include "source_key.h"
+#include "wakeup_event.h"
+
+//Sidecar file next to a recording with one entry per scene change, e.g. "2025-01-01 20-00-00.mkv.scenes".
+//Layout: header, fixed-size records sorted by recording time, string pool. Records are appended while the recording runs,
+//the pool and the record count follow once the file is finished. The file is memory mapped, find() is a binary search.
+class segment_index
+{
+	public:
+		static constexpr uint32_t MAGIC = 0x49535353;	//"SSSI"
+		static constexpr uint16_t VERSION = 1;
+
+		static constexpr std::string_view EXTENSION = ".scenes";
+
+		//Action of a scene change without a rule
+		static constexpr uint8_t NO_RULE = 0xFF;
+
+		//Record flags
+		static constexpr uint8_t TRANSITION = 0x01;		//taken from a transition start, not from the frontend event
+		static constexpr uint8_t CONTINUATION = 0x02;	//the scene was already on air when a split opened this file
+
+		struct file_header
+		{
+			uint32_t m_magic;
+			uint16_t m_version;
+			uint16_t m_record_size;
+			uint32_t m_record_count;
+			uint32_t m_pool_size;
+			int64_t m_duration;		//recording time in nanoseconds
+			uint64_t m_reserved;
+		};
+
+		struct file_record
+		{
+			int64_t m_time;		//recording time in nanoseconds, paused time does not count
+			uint64_t m_key_high;
+			uint64_t m_key_low;
+			uint32_t m_name_offset;
+			uint16_t m_name_length;
+			uint8_t m_action;	//recording_setting::action of the rule that fired or NO_RULE
+			uint8_t m_flags;
+			uint32_t m_trigger_time;	//delay of the rule in milliseconds
+			uint32_t m_reserved;
+		};
+
+		segment_index();
+
+	public:
+		bool open(const std::filesystem::path& path);
+		void close();
+
+		inline bool is_open() const { return m_header != nullptr; }
+
+		size_t size() const;
+		std::chrono::nanoseconds get_duration() const;
+
+		std::chrono::nanoseconds get_time(size_t index) const;
+		source_key get_key(size_t index) const;
+		std::string_view get_name(size_t index) const;
+		std::optional<recording_setting::action> get_action(size_t index) const;
+		uint32_t get_trigger_time(size_t index) const;
+		uint8_t get_flags(size_t index) const;
+
+		//Entry of the scene which was on air at the given recording time, size() if the time lies before the first entry
+		size_t find(std::chrono::nanoseconds time) const;
+
+	protected:
+
+	private:
+		const file_record& record(size_t index) const;
+
+		mapped_file m_file;
+		const file_header* m_header;
+		const uint8_t* m_records;
+		const char* m_pool;
+};
+
+//Writes the segment index of the running recording and optionally adds chapter markers (hybrid MP4 only).
+//The producers only push into a lock-free queue, a writer thread does the file I/O and talks to the output.
+class segment_index_writer
+{
+	public:
+		using clock = std::chrono::steady_clock;
+		using chapter_function = bool (*)(const char* name);
+
+		explicit segment_index_writer(chapter_function add_chapter = nullptr);
+		~segment_index_writer();
+
+		//No copying
+		segment_index_writer(const segment_index_writer& other) = delete;
+		segment_index_writer& operator = (const segment_index_writer& other) = delete;
+
+	public:
+		//Takes effect with the next recording file
+		void set_enabled(bool sidecar, bool chapters);
+
+		//Fed from the frontend recording events and the output's file_changed signal.
+		//begin_file() hands the path over under a mutex, the others never lock.
+		void begin_file(clock::time_point time, const std::string& recording_path);
+		void end_file(clock::time_point time);
+		void pause(clock::time_point time);
+		void unpause(clock::time_point time);
+
+		//Costs a single relaxed load while nothing is recorded. rule may be null.
+		inline void record_scene(clock::time_point time, const source_key& key, std::string_view name, const recording_setting* rule, bool transition)
+		{
+			if (!m_recording.load(std::memory_order_relaxed))
+				return;
+
+			push_scene(time, key, name, rule, transition);
+		}
+
+		inline uint64_t get_written() const { return m_written.load(std::memory_order_relaxed); }
+		inline uint64_t get_dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+	protected:
+
+	private:
+		static constexpr size_t QUEUE_SIZE = 1024;
+
+		//Longer scene names are cut, on a character boundary
+		static constexpr size_t NAME_CAPACITY = 128;
+
+		enum class entry_type : uint8_t
+		{
+			begin_file,
+			end_file,
+			pause,
+			unpause,
+			scene
+		};
+
+		struct entry
+		{
+			int64_t m_time;		//steady clock, nanoseconds
+			entry_type m_type;
+			uint8_t m_action;
+			uint8_t m_flags;
+			uint8_t m_name_length;
+			uint32_t m_trigger_time;
+			uint64_t m_key_high;
+			uint64_t m_key_low;
+			char m_name[NAME_CAPACITY];
+		};
+
+		static int64_t to_nanoseconds(clock::time_point time);
+
+		bool push(const entry& e);
+		void push_scene(clock::time_point time, const source_key& key, std::string_view name, const recording_setting* rule, bool transition);
+
+		void work();
+		void drain();
+		void apply(const entry& e);
+		void open_file(const std::string& recording_path);
+		void finish_file(int64_t time);
+		void write_record(const entry& e, int64_t recording_time, uint8_t flags);
+		int64_t recording_time(int64_t time) const;
+
+		const chapter_function m_add_chapter;
+
+		mpsc_queue<entry, QUEUE_SIZE> m_queue;
+		wakeup_event m_wake_writer;
+
+		std::atomic_bool m_sidecar;
+		std::atomic_bool m_chapters;
+		std::atomic_bool m_recording;
+		std::atomic_bool m_exit;
+		std::atomic<uint64_t> m_written;
+		std::atomic<uint64_t> m_dropped;
+
+		//Paths of begin_file entries the writer has not seen yet, in queue order
+		std::mutex m_path_mutex;
+		std::deque<std::string> m_pending_paths;
+
+		//Only touched by the writer thread
+		std::ofstream m_stream;
+		std::filesystem::path m_path;
+		std::string m_pool;
+		std::unordered_map<std::string, uint32_t> m_pool_offsets;
+		uint32_t m_record_count;
+		int64_t m_file_start;
+		int64_t m_paused_total;
+		std::optional<int64_t> m_paused_since;
+		int64_t m_last_time;
+		std::optional<entry> m_last_scene;
+		bool m_running;
+		bool m_add_chapters;
+
+		//Started last, after everything the writer touches has been initialized
+		std::thread m_thread;
+};
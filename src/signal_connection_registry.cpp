@@ -0,0 +1,148 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "signal_connection_registry.h"
+
+#include <functional>
+#include <unordered_set>
+
+signal_connection_registry::signal_connection_registry(std::string signal, signal_callback_t callback)
+	: m_signal{ std::move(signal) }
+	, m_callback{ callback }
+	, m_connects{ 0 }
+	, m_disconnects{ 0 }
+	, m_stale_invocations{ 0 }
+{ }
+
+signal_connection_registry::~signal_connection_registry()
+{
+	clear();
+}
+
+void signal_connection_registry::synchronize(obs_source_t* const* sources, size_t count)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	std::unordered_set<source_key, source_key_hash> wanted;
+	wanted.reserve(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto key = source_key::from_source(sources[i]);
+		if (!key.valid())
+			continue;
+
+		wanted.insert(key);
+
+		if (!m_connections.count(key))
+			connect(sources[i], key);
+	}
+
+	for (auto it = m_connections.begin(); it != m_connections.end();)
+	{
+		if (wanted.count(it->first))
+		{
+			++it;
+			continue;
+		}
+
+		disconnect(std::move(it->second));
+		it = m_connections.erase(it);
+	}
+}
+
+void signal_connection_registry::clear()
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	for (auto& v : m_connections)
+		disconnect(std::move(v.second));
+
+	m_connections.clear();
+	m_retired.clear();
+}
+
+size_t signal_connection_registry::size() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	return m_connections.size();
+}
+
+std::vector<signal_connection_registry::connection_statistics> signal_connection_registry::get_statistics() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	std::vector<connection_statistics> result;
+	result.reserve(m_connections.size());
+
+	for (const auto& v : m_connections)
+	{
+		auto source_ptr = std::unique_ptr<obs_source_t, std::function<void(obs_source_t*)>>(obs_weak_source_get_source(v.second->m_source), [](obs_source_t* ptr) -> void {obs_source_release(ptr); });
+		auto name = source_ptr ? obs_source_get_name(source_ptr.get()) : nullptr;
+
+		result.push_back(connection_statistics{ name ? name : "", v.second->m_invocations.load() });
+	}
+
+	return result;
+}
+
+void signal_connection_registry::signal_callback(void* data, calldata_t* call_data)
+{
+	auto c = static_cast<connection*>(data);
+
+	++c->m_invocations;
+
+	if (c->m_retired)
+	{
+		++c->m_owner->m_stale_invocations;
+		return;
+	}
+
+	c->m_owner->m_callback(c->m_emitter, call_data);
+}
+
+void signal_connection_registry::connect(obs_source_t* source, const source_key& key)
+{
+	auto c = std::make_unique<connection>();
+	c->m_owner = this;
+	c->m_source = obs_source_get_weak_source(source);
+	c->m_emitter = source;
+
+	signal_handler_connect(obs_source_get_signal_handler(source), m_signal.c_str(), signal_callback, c.get());
+
+	m_connections.emplace(key, std::move(c));
+	++m_connects;
+}
+
+void signal_connection_registry::disconnect(std::unique_ptr<connection> value)
+{
+	value->m_retired = true;
+
+	//A source which is gone took its signal handler along
+	auto source_ptr = std::unique_ptr<obs_source_t, std::function<void(obs_source_t*)>>(obs_weak_source_get_source(value->m_source), [](obs_source_t* ptr) -> void {obs_source_release(ptr); });
+	if (source_ptr)
+		signal_handler_disconnect(obs_source_get_signal_handler(source_ptr.get()), m_signal.c_str(), signal_callback, value.get());
+
+	obs_weak_source_release(value->m_source);
+	value->m_source = nullptr;
+	value->m_emitter = nullptr;
+
+	m_retired.push_back(std::move(value));
+	++m_disconnects;
+}
@@ -0,0 +1,95 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "source_key.h"
+
+//Keeps exactly one connection of a signal per source.
+//synchronize() diffs the wanted sources against the connected ones, so only the change is (dis)connected.
+//The callback receives the source the signal is connected to as data, just like connecting it directly with the source as data.
+//Not every signal carries a "source" (scene item signals only carry "scene" and "item"), so it is kept in the connection.
+class signal_connection_registry
+{
+	public:
+		struct connection_statistics
+		{
+			std::string m_name;
+			uint64_t m_invocations;
+		};
+
+		signal_connection_registry(std::string signal, signal_callback_t callback);
+		~signal_connection_registry();
+
+		//No copying
+		signal_connection_registry(const signal_connection_registry& other) = delete;
+		signal_connection_registry& operator = (const signal_connection_registry& other) = delete;
+
+	public:
+		void synchronize(obs_source_t* const* sources, size_t count);
+		void clear();
+
+		size_t size() const;
+		std::vector<connection_statistics> get_statistics() const;
+
+		inline uint64_t get_connects() const { return m_connects; }
+		inline uint64_t get_disconnects() const { return m_disconnects; }
+		//Callbacks which arrived through a connection we already dropped, should stay 0
+		inline uint64_t get_stale_invocations() const { return m_stale_invocations; }
+
+	protected:
+
+	private:
+		struct connection
+		{
+			signal_connection_registry* m_owner = nullptr;
+			obs_weak_source_t* m_source = nullptr;
+			//Only passed on while connected, a source emitting a signal is alive
+			obs_source_t* m_emitter = nullptr;
+			std::atomic<uint64_t> m_invocations{ 0 };
+			std::atomic_bool m_retired{ false };
+		};
+
+		static void signal_callback(void* data, calldata_t* call_data);
+
+		void connect(obs_source_t* source, const source_key& key);
+		void disconnect(std::unique_ptr<connection> value);
+
+		const std::string m_signal;
+		const signal_callback_t m_callback;
+
+		mutable std::mutex m_mutex;
+		std::unordered_map<source_key, std::unique_ptr<connection>, source_key_hash> m_connections;
+
+		//A signal being emitted right now may still call into a connection we dropped, so they are freed on clear() only
+		std::vector<std::unique_ptr<connection>> m_retired;
+
+		std::atomic<uint64_t> m_connects;
+		std::atomic<uint64_t> m_disconnects;
+		std::atomic<uint64_t> m_stale_invocations;
+};
@@ -18,147 +18,382 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 #include "smartstart_recording.h"
 
-#include <QAction>     
-#include <QMenu>
-#include <QMessageBox>
-
 #include <chrono>
+#include <filesystem>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
-#include "plugin_window.h"
+#include "binary_rule_store.h"
+#include "rule_table_json.h"
+#include "span_tracer.h"
 #include "constants.h"
 
-smartstart_recording::smartstart_recording()
-	: m_dirty{ false }
-{ }
+constexpr std::string_view SETTING_NAME = "recording_setting_table";
+constexpr std::string_view RULE_REVISION = "revision";
+constexpr std::string_view BINARY_RULE_STORE = "binary_rule_store";
 
-smartstart_recording& smartstart_recording::get()
+//Beyond this the journal is folded into the binary rule store with the next save
+constexpr size_t JOURNAL_COMPACT_ENTRIES = 256;
+constexpr uint64_t JOURNAL_COMPACT_SIZE = 64 * 1024;
+
+static std::string current_collection_name()
 {
-	static smartstart_recording instance{};
+	auto name_ptr = std::unique_ptr<char, std::function<void(char*)>>(obs_frontend_get_current_scene_collection(), [](char* ptr) -> void {bfree(ptr); });
 
-	return instance;
+	return name_ptr ? std::string{ name_ptr.get() } : std::string{};
 }
 
-bool smartstart_recording::load()
+static std::filesystem::path collection_file_path(std::string_view extension)
 {
-	auto* action = static_cast<QAction*>(obs_frontend_add_tools_menu_qaction(obs_module_text(PLUGIN_NAME.data())));
+	return plugin_config::collection_file_path(current_collection_name().c_str(), extension);
+}
 
-	auto cb = []
-		{
-			//Code for opening window for plugin here
-			obs_frontend_push_ui_translation(obs_module_get_string);
+static std::filesystem::path rule_store_path()
+{
+	return collection_file_path(".rules");
+}
+
+static std::filesystem::path rule_journal_path()
+{
+	return collection_file_path(".journal");
+}
+
+//Where the recording output writes to, the FFmpeg muxer takes a path and a custom FFmpeg output a URL
+static std::string recording_output_path(obs_output_t* output)
+{
+	if (!output)
+		return {};
 
-			auto my_window = new plugin_window(static_cast<QMainWindow*>(obs_frontend_get_main_window()));
+	auto settings_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_output_get_settings(output), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
+	if (!settings_ptr)
+		return {};
 
-			my_window->setAttribute(Qt::WA_DeleteOnClose);
-			my_window->show();
+	std::string path = obs_data_get_string(settings_ptr.get(), "path");
+	if (path.empty())
+		path = obs_data_get_string(settings_ptr.get(), "url");
 
-			obs_frontend_pop_ui_translation();
-		};
+	return path;
+}
+
+smartstart_recording::smartstart_recording()
+	: m_segment_index{ obs_frontend_recording_add_chapter }
+	, m_recording_controller{ recording_controller::options{ recording_frontend::obs(), nullptr, [this](recording_controller::decision value, recording_controller::state target_state, recording_controller::clock::time_point time) -> void
+		{
+			m_trace_recorder.record_at(time, trace_event::decision, static_cast<uint8_t>(value), static_cast<uint32_t>(target_state));
+		} } }
+	, m_scene_dispatcher{ m_recording_controller }
+	, m_recording_settings{ std::make_unique<const rule_snapshot>(std::vector<recording_setting>{}, 0) }
+	, m_recording_settings_version{ 0 }
+	, m_collection_changing{ false }
+	, m_rule_revision{ 0 }
+	, m_rule_store_current{ false }
+	, m_journal_failed{ false }
+	, m_rule_cache{ static_cast<size_t>(plugin_config::DEFAULT_RULE_CACHE_LIMIT) * 1024 * 1024 }
+	, m_transition_connections{ "transition_start", obs_source_transistion_start_handler }
+	, m_item_add_connections{ "item_add", obs_scene_item_add_handler }
+	, m_item_remove_connections{ "item_remove", obs_scene_item_remove_handler }
+	, m_item_visible_connections{ "item_visible", obs_scene_item_visible_handler }
+	, m_audio_monitor{ [this](const source_key& key, bool active, audio_monitor::clock::time_point time) -> void
+		{
+			on_audio_activity(key, active, time);
+		} }
+	, m_dirty{ false }
+	, m_frontend_loaded{ false }
+	, m_replay_buffer_owned{ false }
+	, m_logged_back_fills{ 0 }
+	, m_replay_cancel{ false }
+	, m_replay_running{ false }
+{ }
+
+smartstart_recording& smartstart_recording::get()
+{
+	static smartstart_recording instance{};
 
-	QAction::connect(action, &QAction::triggered, cb);
+	return instance;
+}
+
+void smartstart_recording::attach()
+{
+	m_rule_cache.set_memory_limit(static_cast<size_t>(m_config.get_rule_cache_limit()) * 1024 * 1024);
+	m_recording_controller.set_pre_arm_lead(std::chrono::milliseconds{ m_config.get_pre_arm_recording() ? m_config.get_pre_arm_lead() : 0 });
+	m_recording_controller.set_stop_hysteresis(std::chrono::milliseconds{ m_config.get_stop_hysteresis() });
+	m_recording_controller.set_quiet_window(std::chrono::milliseconds{ m_config.get_scene_quiet_window() });
+	m_segment_index.set_enabled(m_config.get_segment_index(), m_config.get_recording_chapters());
+	m_audio_monitor.set_options(audio_gate::options{ m_config.get_audio_gate_threshold(), m_config.get_audio_gate_attack(), m_config.get_audio_gate_hold(), m_config.get_audio_gate_release() });
 
 	obs_frontend_add_save_callback(obs_frontend_save_load_handler, nullptr);
 	obs_frontend_add_event_callback(obs_frontend_event_handler, nullptr);
 	signal_handler_connect(obs_get_signal_handler(), "source_rename", obs_source_rename_handler, nullptr);
+	signal_handler_connect(obs_get_signal_handler(), "source_create", obs_source_create_handler, nullptr);
+	signal_handler_connect(obs_get_signal_handler(), "source_remove", obs_source_remove_handler, nullptr);
+	signal_handler_connect(obs_get_signal_handler(), "source_destroy", obs_source_remove_handler, nullptr);
 
-	return true;
+	//One subscription for all sources instead of one per source, the rules are looked up per call
+	signal_handler_connect(obs_get_signal_handler(), "source_activate", obs_source_activate_handler, nullptr);
+	signal_handler_connect(obs_get_signal_handler(), "source_deactivate", obs_source_deactivate_handler, nullptr);
 }
 
 void smartstart_recording::unload()
 {
-	
+	//Everything attach() subscribed to, so the plugin can be attached again
+	obs_frontend_remove_save_callback(obs_frontend_save_load_handler, nullptr);
+	obs_frontend_remove_event_callback(obs_frontend_event_handler, nullptr);
+	signal_handler_disconnect(obs_get_signal_handler(), "source_rename", obs_source_rename_handler, nullptr);
+	signal_handler_disconnect(obs_get_signal_handler(), "source_create", obs_source_create_handler, nullptr);
+	signal_handler_disconnect(obs_get_signal_handler(), "source_remove", obs_source_remove_handler, nullptr);
+	signal_handler_disconnect(obs_get_signal_handler(), "source_destroy", obs_source_remove_handler, nullptr);
+	signal_handler_disconnect(obs_get_signal_handler(), "source_activate", obs_source_activate_handler, nullptr);
+	signal_handler_disconnect(obs_get_signal_handler(), "source_deactivate", obs_source_deactivate_handler, nullptr);
+
+	if (m_transition_connections.get_stale_invocations())
+		blog(LOG_WARNING, "[%s] %llu transition signals arrived through dropped connections", PLUGIN_NAME_SHORT.data(), static_cast<unsigned long long>(m_transition_connections.get_stale_invocations()));
+
+	m_transition_connections.clear();
+	m_item_add_connections.clear();
+	m_item_remove_connections.clear();
+	m_item_visible_connections.clear();
+	m_scene_graph.clear();
+	m_audio_monitor.clear();
+	disconnect_recording_output();
+
+	stop_trace();
+	span_tracer::get().set_enabled(false);
+
+	m_replay_cancel = true;
+	if (m_replay_thread.joinable())
+		m_replay_thread.join();
 }
 
-void smartstart_recording::update_recording_settings(const std::list<recording_setting>& new_list)
+std::optional<recording_controller::state> smartstart_recording::recording_state_for_event(obs_frontend_event event)
 {
-	m_recording_setting_list = new_list;
-	build_recording_table();
+	switch (event)
+	{
+		case OBS_FRONTEND_EVENT_RECORDING_STARTING:
+			return recording_controller::state::starting;
 
-	m_dirty = true;
+		case OBS_FRONTEND_EVENT_RECORDING_STARTED:
+		case OBS_FRONTEND_EVENT_RECORDING_UNPAUSED:
+			return recording_controller::state::started;
+
+		case OBS_FRONTEND_EVENT_RECORDING_STOPPING:
+			return recording_controller::state::stopping;
+
+		case OBS_FRONTEND_EVENT_RECORDING_STOPPED:
+			return recording_controller::state::stopped;
+
+		case OBS_FRONTEND_EVENT_RECORDING_PAUSED:
+			return recording_controller::state::paused;
+
+		default:
+			return std::nullopt;
+	}
 }
 
-void smartstart_recording::remove_recording_setting(std::string_view name)
+void smartstart_recording::update_recording_settings(const std::list<recording_setting>& new_list)
 {
-	m_recording_setting_map.erase(name.data());
-	m_recording_setting_list.remove_if([&name](const recording_setting& item) -> bool {return item.get_scene_name() == name.data(); });
+	m_recording_settings.update([this, &new_list](const rule_snapshot& current) -> std::unique_ptr<const rule_snapshot>
+		{
+			std::vector<recording_setting> settings{ new_list.begin(), new_list.end() };
+			std::unordered_set<source_key, source_key_hash> keys;
+
+			//Pattern rules are not in the scene table, look every rule up by its own key
+			std::unordered_map<source_key, const recording_setting*, source_key_hash> previous_rules;
+			for (const auto& v : current.get_settings())
+				previous_rules.emplace(v.get_scene_key(), &v);
+
+			//Only what actually changed goes into the journal
+			for (const auto& v : settings)
+			{
+				auto it = previous_rules.find(v.get_scene_key());
+				auto previous = it != previous_rules.end() ? it->second : nullptr;
+
+				if (!previous)
+					log_rule_edit(rule_journal::operation::add, v);
+				else if (*previous != v)
+					log_rule_edit(rule_journal::operation::update, v);
+
+				keys.insert(v.get_scene_key());
+			}
+
+			for (const auto& v : current.get_settings())
+			{
+				if (!keys.count(v.get_scene_key()))
+					log_rule_edit(rule_journal::operation::remove, v);
+			}
+
+			return std::make_unique<const rule_snapshot>(std::move(settings), ++m_recording_settings_version);
+		});
+
+	on_recording_settings_published();
+	m_dirty = true;
 }
 
-const std::list<recording_setting>& smartstart_recording::get_recording_setting_list() const
+void smartstart_recording::remove_recording_setting(const source_key& key)
 {
-	return m_recording_setting_list;
+	m_recording_settings.update([this, &key](const rule_snapshot& current) -> std::unique_ptr<const rule_snapshot>
+		{
+			std::vector<recording_setting> settings;
+			for (const auto& v : current.get_settings())
+			{
+				if (v.get_scene_key() != key)
+					settings.push_back(v);
+				else
+					log_rule_edit(rule_journal::operation::remove, v);
+			}
+
+			return std::make_unique<const rule_snapshot>(std::move(settings), ++m_recording_settings_version);
+		});
+
+	on_recording_settings_published();
+	m_dirty = true;
 }
 
-const recording_setting* smartstart_recording::get_recording_setting(const std::string_view scene_name) const
+std::list<recording_setting> smartstart_recording::get_recording_setting_list() const
 {
-	auto it = m_recording_setting_map.find(scene_name.data());
-
-	if (it != m_recording_setting_map.end())
-		return it->second;
+	auto snapshot = m_recording_settings.read();
 
-	return nullptr;
+	return std::list<recording_setting>{ snapshot->get_settings().begin(), snapshot->get_settings().end() };
 }
 
 void smartstart_recording::save_load_handler(obs_data_t* save_data, bool saving, void* user_data)
 {
-	constexpr std::string_view SETTING_NAME = "recording_setting_table";
-	constexpr std::string_view SETTING_ARRAY_NAME = "recording_settings";
-	constexpr std::string_view SCENE_NAME = "scene_name";
-	constexpr std::string_view ACTION = "action";
-	constexpr std::string_view TRIGGER_TIME = "trigger_time";
-
 	(void)user_data;	//unused parameter
 
 	if (saving)
 	{
-		if (m_dirty)
-		{
-			auto obj_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_data_create(), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
-			auto array_ptr = std::unique_ptr<obs_data_array_t, std::function<void(obs_data_array_t*)>>(obs_data_array_create(), [](obs_data_array_t* ptr) -> void {obs_data_array_release(ptr); });
+		auto obj_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_data_create(), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
+		auto obj = obj_ptr.get();
 
-			obs_data_set_obj(save_data, SETTING_NAME.data(), obj_ptr.get());
+		//OBS hands us a fresh object on every save, the table has to be written even if nothing changed
+		obs_data_set_obj(save_data, SETTING_NAME.data(), obj);
 
-			for (auto& v : m_recording_setting_list)
+		//Running as an update keeps edits from slipping in between writing the table and marking what the journal may drop
+		m_recording_settings.update([this, obj](const rule_snapshot& current) -> std::unique_ptr<const rule_snapshot>
 			{
-				auto recording_setting_obj_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_data_create(), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
+				bool stored = false;
+				if (m_config.get_binary_rule_store())
+				{
+					//As long as the journal is healthy and small, saving costs nothing beyond the edits already appended
+					bool compact = !m_rule_store_current
+						|| m_journal_failed
+						|| m_rule_journal.get_entry_count() >= JOURNAL_COMPACT_ENTRIES
+						|| m_rule_journal.get_size() >= JOURNAL_COMPACT_SIZE;
 
-				obs_data_set_string(recording_setting_obj_ptr.get(), SCENE_NAME.data(), v.get_scene_name().c_str());
-				obs_data_set_int(recording_setting_obj_ptr.get(), ACTION.data(), static_cast<std::underlying_type_t<recording_setting::action>>(v.get_action()));
-				obs_data_set_int(recording_setting_obj_ptr.get(), TRIGGER_TIME.data(), v.get_trigger_time());
-				obs_data_array_push_back(array_ptr.get(), recording_setting_obj_ptr.get());
-			}
-			obs_data_set_array(obj_ptr.get(), SETTING_ARRAY_NAME.data(), array_ptr.get());
-		
-			m_dirty = false;
-		}
+					stored = !compact || binary_rule_store::write(rule_store_path(), current.get_settings(), m_rule_revision + 1);
+
+					if (!stored)
+						blog(LOG_WARNING, "[%s] Could not write the binary rule store, falling back to the scene collection", PLUGIN_NAME_SHORT.data());
+
+					if (compact)
+						compact_rule_journal();
+				}
+				else if (m_dirty || m_journal_failed || m_rule_journal.get_entry_count())
+				{
+					compact_rule_journal();
+				}
+
+				m_rule_store_current = stored;
+
+				obs_data_set_int(obj, RULE_REVISION.data(), static_cast<long long>(m_rule_revision));
+
+				if (stored)
+					obs_data_set_bool(obj, BINARY_RULE_STORE.data(), true);
+				else
+					rule_table_json::write(obj, current.get_settings());
+
+				m_dirty = false;
+
+				return nullptr;
+			});
 	}
 	else
 	{
-		m_recording_setting_list.clear();
+		//OBS saved the outgoing collection before loading this one
+		finish_rule_journal_compaction();
+
 		auto obj_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_data_get_obj(save_data, SETTING_NAME.data()), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
-		if (obj_ptr)
+		auto collection = current_collection_name();
+		auto revision = obj_ptr ? static_cast<uint64_t>(obs_data_get_int(obj_ptr.get(), RULE_REVISION.data())) : 0;
+
+		//Remember in which state we leave the outgoing collection, a cached snapshot is only as good as this
+		rule_cache::entry outgoing;
+		outgoing.m_revision = m_rule_revision;
+		outgoing.m_journal_size = m_rule_journal.get_size();
+		outgoing.m_journal_entries = m_rule_journal.get_entry_count();
+		outgoing.m_rule_store_current = m_rule_store_current;
+
+		bool cacheable = !m_collection_name.empty() && m_collection_name != collection && !m_journal_failed;
+
+		auto journal_path = rule_journal_path();
+		auto cached = m_rule_cache.take(collection, [this, revision, &journal_path](const rule_cache::entry& v) -> bool
+			{
+				return v.m_revision == revision && m_rule_journal.attach(journal_path, revision, v.m_journal_size, v.m_journal_entries);
+			});
+
+		std::unique_ptr<const rule_snapshot> next;
+		m_journal_failed = false;
+
+		if (cached)
 		{
-			auto settings_array_ptr = std::unique_ptr<obs_data_array_t, std::function<void(obs_data_array_t*)>>(obs_data_get_array(obj_ptr.get(), SETTING_ARRAY_NAME.data()), [](obs_data_array_t* ptr) -> void {obs_data_array_release(ptr); });
-			if (settings_array_ptr)
+			//Switching back to a collection we already know, no parsing and no rebuilding
+			next = std::move(cached->m_snapshot);
+			m_rule_revision = cached->m_revision;
+			m_rule_store_current = cached->m_rule_store_current;
+			m_dirty = false;
+		}
+		else
+		{
+			std::vector<recording_setting> settings;
+
+			m_rule_revision = revision;
+			m_rule_store_current = false;
+
+			if (obj_ptr)
 			{
-				size_t count = obs_data_array_count(settings_array_ptr.get());
+				auto obj = obj_ptr.get();
 
-				for (size_t i = 0; i < count; ++i)
+				//An inline table always wins, that way switching the store off (or on) migrates with the next save
+				if (rule_table_json::contains(obj))
 				{
-					auto recording_setting_obj_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_data_array_item(settings_array_ptr.get(), i), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
-					auto setting = recording_setting_obj_ptr.get();
-
-					auto scene_name = obs_data_get_string(setting, SCENE_NAME.data());
-					auto action = static_cast<recording_setting::action>(obs_data_get_int(setting, ACTION.data()));
-					auto trigger_time = static_cast<uint32_t>(obs_data_get_int(setting, TRIGGER_TIME.data()));
+					settings = rule_table_json::read(obj);
+				}
+				else if (obs_data_get_bool(obj, BINARY_RULE_STORE.data()))
+				{
+					binary_rule_store store;
+					if (store.open(rule_store_path()))
+					{
+						if (store.get_revision() != m_rule_revision)
+							blog(LOG_WARNING, "[%s] Binary rule store revision %llu does not match the scene collection (%llu)", PLUGIN_NAME_SHORT.data(), static_cast<unsigned long long>(store.get_revision()), static_cast<unsigned long long>(m_rule_revision));
 
-					m_recording_setting_list.emplace_back(recording_setting{ scene_name, action, trigger_time });
+						//Copied out on purpose: snapshots outlive the store in the rule cache and in readers, and an open mapping
+						//would keep the next save from renaming its file over this one on Windows
+						settings = store.materialize_all();
+						m_rule_store_current = store.get_revision() == m_rule_revision;
+					}
+					else
+					{
+						blog(LOG_WARNING, "[%s] Binary rule store of the current scene collection is missing or damaged", PLUGIN_NAME_SHORT.data());
+					}
 				}
 			}
+
+			//Edits made after the last save (e.g. right before a crash) are still in the journal
+			auto replayed = m_rule_journal.open(journal_path, m_rule_revision, settings);
+			if (replayed)
+				blog(LOG_INFO, "[%s] Recovered %zu rule edits from the journal", PLUGIN_NAME_SHORT.data(), replayed);
+
+			next = std::make_unique<const rule_snapshot>(std::move(settings), ++m_recording_settings_version);
+			m_dirty = replayed != 0;
 		}
 
-		build_recording_table();
-		m_dirty = false;
+		outgoing.m_snapshot = m_recording_settings.exchange(std::move(next));
+		on_recording_settings_published();
+
+		if (cacheable)
+			m_rule_cache.insert(m_collection_name, std::move(outgoing));
+
+		m_collection_name = std::move(collection);
 	}
 }
 
@@ -166,68 +401,45 @@ void smartstart_recording::event_handler(obs_frontend_event event, void* data)
 {
 	(void)data;	//unused parameter
 
-	auto connect_transition_handlers = []() -> void
+	span_tracer::scope span{ "event_handler" };
+
+	auto trigger_time = recording_controller::clock::now();
+
+	auto connect_transition_handlers = [this]() -> void
 		{
-			//Set the transition handler to each transition
+			//Only transitions we do not know yet get connected, the ones which are gone get disconnected
 			obs_frontend_source_list transition_list{ 0 };
 			obs_frontend_get_transitions(&transition_list);
 
-			for (size_t i = 0; i < transition_list.sources.num; ++i)
-			{
-				const auto& v = transition_list.sources.array[i];
-				signal_handler_connect(obs_source_get_signal_handler(v), "transition_start", obs_source_transistion_start_handler, v);
-			}
+			m_transition_connections.synchronize(transition_list.sources.array, transition_list.sources.num);
 
 			obs_frontend_source_list_free(&transition_list);
 		};
 
-	auto scene_list_changed_hander = [this]() -> void
-		{
-			auto scene_list = std::unique_ptr<char*, std::function<void(char**)>>(obs_frontend_get_scene_names(), [](char** ptr)->void { bfree(ptr); });
-
-			bool update_necessary = false;
-			for (auto it = m_recording_setting_list.begin(); it != m_recording_setting_list.end(); it++)
-			{
-				bool item_found = false;
-				auto& v = *(it);
-
-				for (size_t i = 0; scene_list.get()[i]; ++i)
-				{
-					auto item = scene_list.get()[i];
-					if (item == v.get_scene_name())
-					{
-						item_found = true;
-						break;
-					}
-				}
-
-				if (!item_found)
-				{
-					m_recording_setting_map.erase(v.get_scene_name());
-					m_recording_setting_list.erase(it++);
-					update_necessary = true;
-					m_dirty = true;
-				}
-			}
+	//Scene changes are traced together with the scene in on_scene_changed
+	if (event != OBS_FRONTEND_EVENT_SCENE_CHANGED)
+		m_trace_recorder.record(trace_event::frontend_event, static_cast<uint8_t>(event));
 
-			if (update_necessary)
-			{
-				obs_frontend_save();
-			}
-		};
+	if (auto new_state = recording_state_for_event(event))
+	{
+		on_recording_event(event, trigger_time);
+		m_recording_controller.on_recording_state_changed(*new_state);
+		return;
+	}
 
 	switch (event)
 	{
 		case OBS_FRONTEND_EVENT_SCENE_CHANGED:
 		{
 			auto ptr = std::unique_ptr<obs_source_t, std::function<void(obs_source_t*)>>(obs_frontend_get_current_scene(), [](obs_source_t* ptr)->void {obs_source_release(ptr); });
-			on_scene_changed(ptr.get(), nullptr);
+			on_scene_changed(ptr.get(), nullptr, trigger_time);
 		}
 		break;
 
 		case OBS_FRONTEND_EVENT_SCENE_LIST_CHANGED:
 		{
-			scene_list_changed_hander();
+			prune_rules_without_scene();
+			synchronize_scene_graph();
 		}
 		break;
 
@@ -237,19 +449,96 @@ void smartstart_recording::event_handler(obs_frontend_event event, void* data)
 		}
 		break;
 
+		case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGING:
+		{
+			m_collection_changing = true;
+		}
+		break;
+
 		case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED:
 		{
+			m_collection_changing = false;
 			connect_transition_handlers();
+			synchronize_scene_graph();
+
+			//The rules may come straight from the cache, check them against the new scene list once things settled
+			obs_queue_task(OBS_TASK_UI, [](void* param) -> void
+				{
+					(void)param;	//unused parameter
+
+					get().verify_rules();
+				}, nullptr, false);
+		}
+		break;
+
+		case OBS_FRONTEND_EVENT_SCENE_COLLECTION_LIST_CHANGED:
+		{
+			//Forget collections which were deleted
+			std::vector<std::string> collections;
+
+			auto list_ptr = std::unique_ptr<char*, std::function<void(char**)>>(obs_frontend_get_scene_collections(), [](char** ptr) -> void {bfree(ptr); });
+			for (auto it = list_ptr.get(); it && *it; ++it)
+				collections.emplace_back(*it);
+
+			m_rule_cache.retain(collections);
+		}
+		break;
+
+		case OBS_FRONTEND_EVENT_SCENE_COLLECTION_RENAMED:
+		{
+			//Our side files are named after the collection
+			m_rule_store_current = false;
+			m_collection_name = current_collection_name();
+
+			if (!m_rule_journal.relocate(rule_journal_path()))
+				m_journal_failed = true;
+		}
+		break;
+
+		case OBS_FRONTEND_EVENT_FINISHED_LOADING:
+		{
+			//Recording may already be running (e.g. started by another plugin or command line), ask once and follow the events from here on
+			m_recording_controller.synchronize_state();
+
+			//From here on the catalog follows the source signals
+			m_scene_catalog.reset();
+			synchronize_scene_graph();
+			m_frontend_loaded = true;
+			on_recording_settings_published();
+		}
+		break;
+
+		case OBS_FRONTEND_EVENT_REPLAY_BUFFER_STARTED:
+		{
+			update_replay_buffer();
+		}
+		break;
+
+		case OBS_FRONTEND_EVENT_REPLAY_BUFFER_STOPPED:
+		{
+			m_replay_buffer_owned = false;
+		}
+		break;
+
+		case OBS_FRONTEND_EVENT_REPLAY_BUFFER_SAVED:
+		{
+			log_back_fill();
 		}
 		break;
 
 		case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CLEANUP:
-		case OBS_FRONTEND_EVENT_EXIT:
 		{
 			//Cleanup is happening here
 		}
 		break;
 
+		case OBS_FRONTEND_EVENT_EXIT:
+		{
+			//The last save is done, the queued compaction may never run
+			finish_rule_journal_compaction();
+		}
+		break;
+
 		default:
 		{
 
@@ -262,84 +551,527 @@ void smartstart_recording::transistion_start_handler(void* data, calldata_t* cal
 {
 	(void)call_data;	//unused parameter
 
+	auto trigger_time = recording_controller::clock::now();
+	span_tracer::scope span{ "transistion_start_handler" };
 	auto transition = static_cast<obs_source_t*>(data);
 
 	auto source = obs_transition_get_source(transition, OBS_TRANSITION_SOURCE_B);
-	on_scene_changed(source, transition);
+	on_scene_changed(source, transition, trigger_time);
 	obs_source_release(source);
 }
 
+void smartstart_recording::file_changed_handler(void* data, calldata_t* call_data)
+{
+	(void)data;	//unused parameter
+
+	auto trigger_time = recording_controller::clock::now();
+
+	span_tracer::instant("file_changed");
+	m_recording_controller.on_split_confirmed();
+
+	auto next_file = calldata_string(call_data, "next_file");
+	m_segment_index.begin_file(trigger_time, next_file ? next_file : "");
+
+	if (next_file)
+		blog(LOG_INFO, "[%s] Recording continues in %s", PLUGIN_NAME_SHORT.data(), next_file);
+}
+
 void smartstart_recording::source_rename_handler(void* data, calldata_t* call_data)
 {
 	(void)data;	//unused parameter
 
+	auto source = static_cast<obs_source_t*>(calldata_ptr(call_data, "source"));
+
+	auto key = source_key::from_source(source);
 	std::string new_name = calldata_string(call_data, "new_name");
 	std::string prev_name = calldata_string(call_data, "prev_name");
 
-	auto item = m_recording_setting_map.find(prev_name);
-	if (item != m_recording_setting_map.end())
+	m_scene_catalog.rename(source, new_name.c_str());
+
+	//Rules are keyed by UUID, a rename only changes what we display and save. Sequences name their scenes.
+	bool affected = false;
 	{
-		auto old_item = item->second;
-		old_item->set_scene_name(new_name);
+		//The guard has to be gone before the update below, writers wait for readers
+		auto snapshot = m_recording_settings.read();
+		affected = snapshot->find(key) || snapshot->find_nested(key) || snapshot->find_source(key) || snapshot->get_sequences().symbol(prev_name) != scene_sequence_set::NO_SYMBOL;
+	}
 
-		m_recording_setting_map.erase(prev_name);
-		m_recording_setting_map[new_name] = old_item;
+	if (!affected)
+		return;
 
-		m_dirty = true;
+	m_recording_settings.update([this, &key, &new_name, &prev_name](const rule_snapshot& current) -> std::unique_ptr<const rule_snapshot>
+		{
+			auto settings = current.get_settings();
+			for (auto& v : settings)
+			{
+				if (v.get_scene_key() == key)
+				{
+					v.set_scene_name(new_name);
+					log_rule_edit(rule_journal::operation::rename, v);
+				}
+				else if (scene_sequence_set::rename(v, prev_name, new_name))
+					log_rule_edit(rule_journal::operation::rename, v);
+			}
+
+			return std::make_unique<const rule_snapshot>(std::move(settings), ++m_recording_settings_version);
+		});
+
+	m_dirty = true;
+}
+
+void smartstart_recording::source_create_handler(void* data, calldata_t* call_data)
+{
+	(void)data;	//unused parameter
+
+	auto source = static_cast<obs_source_t*>(calldata_ptr(call_data, "source"));
+	m_scene_catalog.add(source);
+
+	//A source with an audio rule came (back), e.g. while a collection is loaded
+	auto snapshot = m_recording_settings.read();
+	auto rec_setting = snapshot->find_source(source_key::from_source(source));
+	if (rec_setting && rec_setting->get_match() == recording_setting::match::audio)
+	{
+		obs_queue_task(OBS_TASK_UI, [](void* param) -> void
+			{
+				(void)param;	//unused parameter
+
+				get().synchronize_audio_monitor();
+			}, nullptr, false);
 	}
 }
 
-void smartstart_recording::on_scene_changed(const obs_source_t* source, const obs_source_t* transition)
+void smartstart_recording::source_remove_handler(void* data, calldata_t* call_data)
 {
-	if (!source)
+	(void)data;	//unused parameter
+
+	auto source = static_cast<obs_source_t*>(calldata_ptr(call_data, "source"));
+	m_scene_catalog.remove(source);
+
+	if (!scene_graph::is_container(source))
 		return;
 
-	std::string_view source_name = obs_source_get_name(source);
-	
-	//scene change can happen directly after the transition. Lets remember which scene was handeled last
-	if (m_last_handeled_scene_name == source_name)
+	scene_graph::delta_list deltas;
+	m_scene_graph.remove_scene(source_key::from_source(source), deltas);
+	on_scene_visibility(deltas, source, recording_controller::clock::now());
+}
+
+void smartstart_recording::source_activity_handler(calldata_t* call_data, bool active)
+{
+	auto trigger_time = recording_controller::clock::now();
+
+	//Every source shown or hidden anywhere ends up here, without source rules this is all it costs
+	auto snapshot = m_recording_settings.read();
+	if (!snapshot->has_source_rules())
 		return;
 
-	m_last_handeled_scene_name = source_name;
+	auto source = static_cast<obs_source_t*>(calldata_ptr(call_data, "source"));
+	m_scene_dispatcher.on_source_activity(source_key::from_source(source), active, *snapshot, source, trigger_time);
+}
 
-	//QMessageBox::information(static_cast<QMainWindow*>(obs_frontend_get_main_window()), "Scene Name", source_name.data());
+void smartstart_recording::scene_item_add_handler(void* data, calldata_t* call_data)
+{
+	auto trigger_time = recording_controller::clock::now();
+	auto item = static_cast<obs_sceneitem_t*>(calldata_ptr(call_data, "item"));
+	auto child = obs_sceneitem_get_source(item);
 
-	auto rec_setting = get_recording_setting(source_name);
-	//Without any setting, there is nothgin to do
-	if (!rec_setting)
+	//Plain sources never show a scene, most items end here
+	if (!scene_graph::is_container(child))
 		return;
-	
+
+	scene_graph::delta_list deltas;
+	m_scene_graph.add_item(source_key::from_source(static_cast<obs_source_t*>(data)), obs_sceneitem_get_id(item), source_key::from_source(child), obs_sceneitem_visible(item), deltas);
+	on_scene_visibility(deltas, data, trigger_time);
+
+	//A new group has items of its own we have to follow, the signal may arrive before the group is filled
+	if (obs_source_is_group(child))
+	{
+		obs_queue_task(OBS_TASK_UI, [](void* param) -> void
+			{
+				(void)param;	//unused parameter
+
+				get().synchronize_scene_graph();
+			}, nullptr, false);
+	}
+}
+
+void smartstart_recording::scene_item_remove_handler(void* data, calldata_t* call_data)
+{
+	auto item = static_cast<obs_sceneitem_t*>(calldata_ptr(call_data, "item"));
+
+	scene_graph::delta_list deltas;
+	m_scene_graph.remove_item(source_key::from_source(static_cast<obs_source_t*>(data)), obs_sceneitem_get_id(item), deltas);
+	on_scene_visibility(deltas, data, recording_controller::clock::now());
+}
+
+void smartstart_recording::scene_item_visible_handler(void* data, calldata_t* call_data)
+{
+	auto trigger_time = recording_controller::clock::now();
+	auto item = static_cast<obs_sceneitem_t*>(calldata_ptr(call_data, "item"));
+
+	scene_graph::delta_list deltas;
+	m_scene_graph.set_item_visible(source_key::from_source(static_cast<obs_source_t*>(data)), obs_sceneitem_get_id(item), calldata_bool(call_data, "visible"), deltas);
+	on_scene_visibility(deltas, data, trigger_time);
+}
+
+void smartstart_recording::on_scene_changed(const obs_source_t* source, const obs_source_t* transition, recording_controller::clock::time_point trigger_time)
+{
+	if (!source)
+		return;
+
+	span_tracer::scope span{ "on_scene_changed" };
+
+	auto scene_key = source_key::from_source(source);
+
 	if (transition)
+		m_trace_recorder.record(trace_event::transition_start, 0, 0, scene_key);
+	else
+		m_trace_recorder.record(trace_event::frontend_event, static_cast<uint8_t>(OBS_FRONTEND_EVENT_SCENE_CHANGED), 0, scene_key);
+
+	//The guard keeps the rule alive until we are done, the controller calls never block
+	auto snapshot = m_recording_settings.read();
+	std::string_view scene_name = obs_source_get_name(source) ? obs_source_get_name(source) : "";
+
+	//The scene graph locks and allocates, so it stays off the transition path. OBS reports the scene change on the UI thread right after the transition started.
+	//Scenes nested in the new program scene go first, unless the program scene has a rule of its own, that one always wins.
+	if (!transition)
 	{
-		switch (rec_setting->get_action())
+		m_program_deltas.clear();
+		m_scene_graph.set_program(scene_key, m_program_deltas);
+
+		if (!snapshot->resolve(scene_key, scene_name))
+			on_scene_visibility(m_program_deltas, source, trigger_time);
+	}
+
+	m_scene_dispatcher.on_scene_changed(scene_key, scene_name, *snapshot, transition != nullptr, source, trigger_time);
+
+	m_segment_index.record_scene(trigger_time, scene_key, scene_name, snapshot->resolve(scene_key, scene_name), transition != nullptr);
+}
+
+void smartstart_recording::on_scene_visibility(const scene_graph::delta_list& deltas, const void* origin, recording_controller::clock::time_point trigger_time)
+{
+	if (deltas.empty())
+		return;
+
+	auto snapshot = m_recording_settings.read();
+	for (const auto& v : deltas)
+	{
+		//Scenes leaving the output have nothing to trigger, the next rule decides what happens
+		if (v.second)
+			m_scene_dispatcher.on_scene_visible(v.first, *snapshot, origin, trigger_time);
+	}
+}
+
+void smartstart_recording::on_audio_activity(const source_key& key, bool active, recording_controller::clock::time_point trigger_time)
+{
+	span_tracer::instant(active ? "audio_gate_open" : "audio_gate_closed");
+
+	auto snapshot = m_recording_settings.read();
+	m_scene_dispatcher.on_audio_activity(key, active, *snapshot, nullptr, trigger_time);
+}
+
+void smartstart_recording::synchronize_audio_monitor()
+{
+	std::vector<obs_source_t*> sources;
+	{
+		//Keep the guard short, attaching waits for audio callbacks running right now
+		auto snapshot = m_recording_settings.read();
+		for (const auto& v : snapshot->get_settings())
 		{
-			case recording_setting::action::start:
-			{
-				m_recording_controller.start_recording(std::chrono::milliseconds{ rec_setting->get_trigger_time() });
-			}
-			break;
+			if (v.get_match() != recording_setting::match::audio)
+				continue;
+
+			if (auto source = obs_get_source_by_uuid(v.get_scene_key().to_string().c_str()))
+				sources.push_back(source);
+		}
+	}
+
+	m_audio_monitor.synchronize(sources.data(), sources.size());
+
+	for (auto v : sources)
+		obs_source_release(v);
+}
+
+void smartstart_recording::synchronize_scene_graph()
+{
+	//Groups are enumerated as scenes as well
+	std::vector<obs_source_t*> scenes;
+	obs_enum_scenes([](void* param, obs_source_t* source) -> bool
+		{
+			if (auto ref = obs_source_get_ref(source))
+				static_cast<std::vector<obs_source_t*>*>(param)->push_back(ref);
+
+			return true;
+		}, &scenes);
+
+	scene_graph::delta_list deltas;
+	m_scene_graph.reset(scenes.data(), scenes.size(), deltas);
+
+	auto ptr = std::unique_ptr<obs_source_t, std::function<void(obs_source_t*)>>(obs_frontend_get_current_scene(), [](obs_source_t* ptr)->void {obs_source_release(ptr); });
+	if (ptr)
+		m_scene_graph.set_program(source_key::from_source(ptr.get()), deltas);
+
+	m_item_add_connections.synchronize(scenes.data(), scenes.size());
+	m_item_remove_connections.synchronize(scenes.data(), scenes.size());
+	m_item_visible_connections.synchronize(scenes.data(), scenes.size());
+
+	for (auto v : scenes)
+		obs_source_release(v);
+
+	on_scene_visibility(deltas, ptr.get(), recording_controller::clock::now());
+}
+
+void smartstart_recording::on_recording_event(obs_frontend_event event, recording_controller::clock::time_point trigger_time)
+{
+	switch (event)
+	{
+		case OBS_FRONTEND_EVENT_RECORDING_STARTED:
+		{
+			connect_recording_output();
+			m_segment_index.begin_file(trigger_time, recording_output_path(m_recording_output.get()));
 
-			default:
+			//The scene on air at the start opens the index, later ones follow the scene changes
+			auto ptr = std::unique_ptr<obs_source_t, std::function<void(obs_source_t*)>>(obs_frontend_get_current_scene(), [](obs_source_t* ptr)->void {obs_source_release(ptr); });
+			if (ptr)
 			{
-				m_recording_controller.stop_recording(std::chrono::milliseconds{ rec_setting->get_trigger_time() });
+				auto scene_key = source_key::from_source(ptr.get());
+				std::string_view scene_name = obs_source_get_name(ptr.get()) ? obs_source_get_name(ptr.get()) : "";
+
+				m_segment_index.record_scene(trigger_time, scene_key, scene_name, m_recording_settings.read()->resolve(scene_key, scene_name), false);
 			}
-			break;
 		}
-		
+		break;
+
+		case OBS_FRONTEND_EVENT_RECORDING_STOPPED:
+		{
+			disconnect_recording_output();
+			m_segment_index.end_file(trigger_time);
+		}
+		break;
+
+		case OBS_FRONTEND_EVENT_RECORDING_PAUSED:
+		{
+			m_segment_index.pause(trigger_time);
+		}
+		break;
+
+		case OBS_FRONTEND_EVENT_RECORDING_UNPAUSED:
+		{
+			m_segment_index.unpause(trigger_time);
+		}
+		break;
+
+		default:
+		{
+
+		}
+		break;
+	}
+}
+
+void smartstart_recording::on_recording_settings_published()
+{
+	m_scene_catalog.set_rule_keys(m_recording_settings.read()->get_keys());
+
+	update_replay_buffer();
+	synchronize_audio_monitor();
+}
+
+void smartstart_recording::update_replay_buffer()
+{
+	//Starting outputs before the frontend finished loading is not supported by OBS
+	if (!m_frontend_loaded)
+		return;
+
+	uint32_t pre_roll = 0;
+	{
+		auto snapshot = m_recording_settings.read();
+		for (const auto& v : snapshot->get_settings())
+		{
+			if (v.get_action() == recording_setting::action::start)
+				pre_roll = std::max(pre_roll, v.get_pre_roll());
+		}
+	}
+
+	auto active = obs_frontend_replay_buffer_active();
+
+	if (pre_roll && !active)
+	{
+		//The limits are applied once OBS reports the buffer as started
+		blog(LOG_INFO, "[%s] Starting the replay buffer for a pre-roll of %u s", PLUGIN_NAME_SHORT.data(), pre_roll);
+
+		m_replay_buffer_owned = true;
+		obs_frontend_replay_buffer_start();
+		return;
+	}
+
+	if (!pre_roll && active && m_replay_buffer_owned)
+	{
+		m_replay_buffer_owned = false;
+		obs_frontend_replay_buffer_stop();
+		return;
+	}
+
+	if (pre_roll && active)
+		limit_replay_buffer(pre_roll);
+}
+
+void smartstart_recording::limit_replay_buffer(uint32_t pre_roll)
+{
+	auto output_ptr = std::unique_ptr<obs_output_t, std::function<void(obs_output_t*)>>(obs_frontend_get_replay_buffer_output(), [](obs_output_t* ptr) -> void {obs_output_release(ptr); });
+	if (!output_ptr)
+		return;
+
+	auto settings_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_output_get_settings(output_ptr.get()), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
+	if (!settings_ptr)
+		return;
+
+	//A buffer the user started is theirs, we only point out when it is too short for our rules
+	if (!m_replay_buffer_owned)
+	{
+		auto max_time = obs_data_get_int(settings_ptr.get(), "max_time_sec");
+		if (max_time < pre_roll)
+			blog(LOG_WARNING, "[%s] The replay buffer keeps %lld s, less than the pre-roll of %u s", PLUGIN_NAME_SHORT.data(), max_time, pre_roll);
+
 		return;
 	}
 
-	//Without transition we want to immediatley start the recording if requested (probably we are here, because OBS crashed)
-	if(rec_setting->get_action() == recording_setting::action::start)
-		m_recording_controller.start_recording(std::chrono::milliseconds{ 0 });
+	//The replay buffer trims itself to whichever limit is reached first, that bounds its memory
+	obs_data_set_int(settings_ptr.get(), "max_time_sec", pre_roll);
+	obs_data_set_int(settings_ptr.get(), "max_size_mb", m_config.get_replay_buffer_budget());
+	obs_output_update(output_ptr.get(), settings_ptr.get());
+
+	blog(LOG_INFO, "[%s] Replay buffer limited to %u s and %u MiB", PLUGIN_NAME_SHORT.data(), pre_roll, m_config.get_replay_buffer_budget());
+}
+
+void smartstart_recording::log_back_fill()
+{
+	//Saves the user triggered are none of our business
+	auto back_fills = m_recording_controller.get_back_fills();
+	if (back_fills == m_logged_back_fills)
+		return;
+
+	m_logged_back_fills = back_fills;
+
+	auto path_ptr = std::unique_ptr<char, std::function<void(char*)>>(obs_frontend_get_last_replay(), [](char* ptr) -> void {bfree(ptr); });
+	if (!path_ptr)
+		return;
+
+	//The clip is what the buffer held in memory at the time of the save
+	std::error_code error;
+	auto size = std::filesystem::file_size(std::filesystem::u8path(path_ptr.get()), error);
+
+	blog(LOG_INFO, "[%s] Pre-roll saved to %s, %.1f MiB buffered, %llu back-fills, %llu without replay buffer", PLUGIN_NAME_SHORT.data(), path_ptr.get(), error ? 0.0 : static_cast<double>(size) / (1024.0 * 1024.0),
+		static_cast<unsigned long long>(back_fills), static_cast<unsigned long long>(m_recording_controller.get_missed_back_fills()));
+}
+
+void smartstart_recording::connect_recording_output()
+{
+	disconnect_recording_output();
+
+	m_recording_output = std::unique_ptr<obs_output_t, std::function<void(obs_output_t*)>>(obs_frontend_get_recording_output(), [](obs_output_t* ptr) -> void {obs_output_release(ptr); });
+	if (!m_recording_output)
+		return;
+
+	signal_handler_connect(obs_output_get_signal_handler(m_recording_output.get()), "file_changed", obs_output_file_changed_handler, nullptr);
+}
+
+void smartstart_recording::disconnect_recording_output()
+{
+	if (!m_recording_output)
+		return;
+
+	signal_handler_disconnect(obs_output_get_signal_handler(m_recording_output.get()), "file_changed", obs_output_file_changed_handler, nullptr);
+	m_recording_output.reset();
+}
+
+void smartstart_recording::prune_rules_without_scene()
+{
+	//While a collection is swapped the scene list is empty for a moment, that must not cost us any rules
+	if (m_collection_changing || !m_scene_catalog.missing_rule_count())
+		return;
+
+	bool update_necessary = false;
+	m_recording_settings.update([this, &update_necessary](const rule_snapshot& current) -> std::unique_ptr<const rule_snapshot>
+		{
+			std::vector<recording_setting> settings;
+
+			for (const auto& v : current.get_settings())
+			{
+				//Patterns belong to no particular scene and source rules to no scene at all, they stay
+				if (v.is_pattern() || v.is_source() || m_scene_catalog.contains(v.get_scene_key()))
+					settings.push_back(v);
+				else
+					log_rule_edit(rule_journal::operation::remove, v);
+			}
+
+			if (settings.size() == current.get_settings().size())
+				return nullptr;
+
+			update_necessary = true;
+			m_dirty = true;
+
+			return std::make_unique<const rule_snapshot>(std::move(settings), ++m_recording_settings_version);
+		});
+
+	//The journal already has the removal, no need to force a save
+	if (update_necessary)
+		on_recording_settings_published();
 }
 
-void smartstart_recording::build_recording_table()
+void smartstart_recording::verify_rules()
 {
-	m_recording_setting_map.clear();
+	m_scene_catalog.reset();
+	on_recording_settings_published();
 
-	for (auto& v : m_recording_setting_list)
-		m_recording_setting_map[v.get_scene_name()] = &v;
+	if (m_scene_catalog.missing_rule_count())
+		blog(LOG_INFO, "[%s] %zu rules of scene collection \"%s\" have no scene anymore", PLUGIN_NAME_SHORT.data(), m_scene_catalog.missing_rule_count(), m_collection_name.c_str());
+
+	prune_rules_without_scene();
+}
+
+void smartstart_recording::stop_trace()
+{
+	if (!m_trace_recorder.is_recording())
+		return;
+
+	m_trace_recorder.stop();
+
+	blog(LOG_INFO, "[%s] Trace stopped, %llu records written, %llu dropped", PLUGIN_NAME_SHORT.data(), static_cast<unsigned long long>(m_trace_recorder.get_written()), static_cast<unsigned long long>(m_trace_recorder.get_dropped()));
+}
+
+void smartstart_recording::log_rule_edit(rule_journal::operation op, const recording_setting& setting)
+{
+	//Whatever did not make it into the journal has to be covered by the next full save
+	if (!m_rule_journal.append(op, setting))
+		m_journal_failed = true;
+}
+
+void smartstart_recording::compact_rule_journal()
+{
+	++m_rule_revision;
+
+	//OBS writes the collection after all save callbacks returned, until then the journal is the only copy of the recent edits.
+	//The task runs once the UI thread is done with the save.
+	m_pending_compaction = journal_compaction{ m_rule_revision, m_rule_journal.get_size(), m_rule_journal.get_entry_count() };
+
+	obs_queue_task(OBS_TASK_UI, [](void* param) -> void
+		{
+			(void)param;	//unused parameter
+
+			get().finish_rule_journal_compaction();
+		}, nullptr, false);
+}
+
+void smartstart_recording::finish_rule_journal_compaction()
+{
+	if (!m_pending_compaction)
+		return;
+
+	auto compaction = *m_pending_compaction;
+	m_pending_compaction.reset();
+
+	//Edits which came in after the save stay in the journal
+	m_journal_failed = !m_rule_journal.rebase(compaction.m_revision, compaction.m_size, compaction.m_entry_count);
 }
 
 void smartstart_recording::obs_frontend_save_load_handler(obs_data_t* save_data, bool saving, void* user_data)
@@ -361,3 +1093,47 @@ void smartstart_recording::obs_source_rename_handler(void* data, calldata_t* cal
 {
 	get().source_rename_handler(data, call_data);
 }
+
+void smartstart_recording::obs_source_create_handler(void* data, calldata_t* call_data)
+{
+	get().source_create_handler(data, call_data);
+}
+
+void smartstart_recording::obs_source_remove_handler(void* data, calldata_t* call_data)
+{
+	get().source_remove_handler(data, call_data);
+}
+
+void smartstart_recording::obs_source_activate_handler(void* data, calldata_t* call_data)
+{
+	(void)data;	//unused parameter
+
+	get().source_activity_handler(call_data, true);
+}
+
+void smartstart_recording::obs_source_deactivate_handler(void* data, calldata_t* call_data)
+{
+	(void)data;	//unused parameter
+
+	get().source_activity_handler(call_data, false);
+}
+
+void smartstart_recording::obs_output_file_changed_handler(void* data, calldata_t* call_data)
+{
+	get().file_changed_handler(data, call_data);
+}
+
+void smartstart_recording::obs_scene_item_add_handler(void* data, calldata_t* call_data)
+{
+	get().scene_item_add_handler(data, call_data);
+}
+
+void smartstart_recording::obs_scene_item_remove_handler(void* data, calldata_t* call_data)
+{
+	get().scene_item_remove_handler(data, call_data);
+}
+
+void smartstart_recording::obs_scene_item_visible_handler(void* data, calldata_t* call_data)
+{
+	get().scene_item_visible_handler(data, call_data);
+}
@@ -23,26 +23,53 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 #include <string>
 #include <list>
-#include <unordered_map>
 #include <condition_variable>
 #include <mutex>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
 
+#include "audio_monitor.h"
 #include "recording_setting.h"
 #include "recording_controller.h"
+#include "rcu_cell.h"
+#include "rule_snapshot.h"
+#include "scene_catalog.h"
+#include "plugin_config.h"
+#include "rule_journal.h"
+#include "rule_cache.h"
+#include "signal_connection_registry.h"
+#include "scene_dispatcher.h"
+#include "scene_graph.h"
+#include "segment_index.h"
+#include "trace_recorder.h"
+#include "trace_replay.h"
 
 class smartstart_recording
 {
 public:
 	static smartstart_recording& get();
+
+	//Recording state a frontend event stands for, if any
+	static std::optional<recording_controller::state> recording_state_for_event(obs_frontend_event event);
 public:
+	//Loads the configuration, adds the Tools menu and attaches, the only part needing Qt
 	bool load();
+	//Applies the configuration and subscribes to the frontend and the global signals. Builds without Qt, tests attach the plugin this way.
+	void attach();
 	void unload();
 
 	void update_recording_settings(const std::list<recording_setting>& new_list);
-	void remove_recording_setting(std::string_view name);
+	void remove_recording_setting(const source_key& key);
 
-	const std::list<recording_setting>& get_recording_setting_list() const;
-	const recording_setting* get_recording_setting(const std::string_view scene_name) const;
+	std::list<recording_setting> get_recording_setting_list() const;
+	inline const scene_catalog& get_scene_catalog() const { return m_scene_catalog; }
+	inline plugin_config& get_config() { return m_config; }
+	inline const rule_cache& get_rule_cache() const { return m_rule_cache; }
+	inline const signal_connection_registry& get_transition_connections() const { return m_transition_connections; }
+	inline const recording_controller& get_recording_controller() const { return m_recording_controller; }
 
 protected:
 	smartstart_recording();
@@ -51,21 +78,118 @@ private:
 	void event_handler(obs_frontend_event event, void* data);
 	void transistion_start_handler(void* data, calldata_t* call_data);
 	void source_rename_handler(void* data, calldata_t* call_data);
+	void source_create_handler(void* data, calldata_t* call_data);
+	void source_remove_handler(void* data, calldata_t* call_data);
+	void source_activity_handler(calldata_t* call_data, bool active);
+	void file_changed_handler(void* data, calldata_t* call_data);
+	void scene_item_add_handler(void* data, calldata_t* call_data);
+	void scene_item_remove_handler(void* data, calldata_t* call_data);
+	void scene_item_visible_handler(void* data, calldata_t* call_data);
+
+	void on_scene_changed(const obs_source_t* source, const obs_source_t* transition, recording_controller::clock::time_point trigger_time);
+	void on_recording_event(obs_frontend_event event, recording_controller::clock::time_point trigger_time);
+	void on_scene_visibility(const scene_graph::delta_list& deltas, const void* origin, recording_controller::clock::time_point trigger_time);
+	void on_audio_activity(const source_key& key, bool active, recording_controller::clock::time_point trigger_time);
+
+	void synchronize_scene_graph();
+	void synchronize_audio_monitor();
+
+	void on_recording_settings_published();
+
+	void update_replay_buffer();
+	void limit_replay_buffer(uint32_t pre_roll);
+	void log_back_fill();
+
+	void connect_recording_output();
+	void disconnect_recording_output();
 
-	void on_scene_changed(const obs_source_t* source, const obs_source_t* transition);
+	void prune_rules_without_scene();
+	void verify_rules();
 
-	void build_recording_table();
+	//Qt, in smartstart_recording_ui.cpp
+	void start_trace();
+	void save_profile();
+	void start_replay(trace_replay::speed replay_speed);
+
+	void stop_trace();
+
+	void log_rule_edit(rule_journal::operation op, const recording_setting& setting);
+	void compact_rule_journal();
+	void finish_rule_journal_compaction();
 
 	static void obs_frontend_save_load_handler(obs_data_t* save_data, bool saving, void* user_data);
 	static void obs_frontend_event_handler(obs_frontend_event event, void* user_data);
 	static void obs_source_transistion_start_handler(void* data, calldata_t* call_data);
 	static void obs_source_rename_handler(void* data, calldata_t* call_data);
+	static void obs_source_create_handler(void* data, calldata_t* call_data);
+	static void obs_source_remove_handler(void* data, calldata_t* call_data);
+	static void obs_source_activate_handler(void* data, calldata_t* call_data);
+	static void obs_source_deactivate_handler(void* data, calldata_t* call_data);
+	static void obs_output_file_changed_handler(void* data, calldata_t* call_data);
+	static void obs_scene_item_add_handler(void* data, calldata_t* call_data);
+	static void obs_scene_item_remove_handler(void* data, calldata_t* call_data);
+	static void obs_scene_item_visible_handler(void* data, calldata_t* call_data);
+
+	plugin_config m_config;
+
+	//Declared before the controller, which reports its decisions here until it is gone
+	trace_recorder m_trace_recorder;
+	segment_index_writer m_segment_index;
 
 	recording_controller m_recording_controller;
+	scene_dispatcher m_scene_dispatcher;
+
+	//Written by the UI and rename handlers, read lock-free from the transition handlers
+	rcu_cell<rule_snapshot> m_recording_settings;
+	std::atomic<uint64_t> m_recording_settings_version;
+
+	scene_catalog m_scene_catalog;
+	bool m_collection_changing;
+
+	//Persisted with the collection, tells whether the binary rule store and the journal belong to it
+	uint64_t m_rule_revision;
+	bool m_rule_store_current;
+
+	rule_journal m_rule_journal;
+	std::atomic_bool m_journal_failed;
+
+	//A save compacted the journal, but OBS did not write the collection yet. UI thread only.
+	struct journal_compaction
+	{
+		uint64_t m_revision;
+		uint64_t m_size;
+		size_t m_entry_count;
+	};
+	std::optional<journal_compaction> m_pending_compaction;
+
+	//Rules of the collections we switched away from
+	rule_cache m_rule_cache;
+	std::string m_collection_name;
+
+	signal_connection_registry m_transition_connections;
+
+	//Nested scenes and groups on air, followed through the item signals of every scene and group
+	scene_graph m_scene_graph;
+	//Only touched on the UI thread, reused so switching the program scene does not allocate once it has grown
+	scene_graph::delta_list m_program_deltas;
+	signal_connection_registry m_item_add_connections;
+	signal_connection_registry m_item_remove_connections;
+	signal_connection_registry m_item_visible_connections;
+
+	//Sources with an audio rule, their gates run on the audio thread
+	audio_monitor m_audio_monitor;
+
+	std::atomic_bool m_dirty;
+
+	//Rules with a pre-roll need the replay buffer, if we had to start it ourselves we also stop it again
+	bool m_frontend_loaded;
+	bool m_replay_buffer_owned;
+	uint64_t m_logged_back_fills;
 
-	std::list<recording_setting> m_recording_setting_list;
-	std::unordered_map<std::string, recording_setting*> m_recording_setting_map;
-	std::string m_last_handeled_scene_name;
+	//Split rules are confirmed by the output once the next file is open, we listen while it records
+	std::unique_ptr<obs_output_t, std::function<void(obs_output_t*)>> m_recording_output;
 
-	bool m_dirty;
+	std::thread m_replay_thread;
+	std::atomic_bool m_replay_cancel;
+	std::atomic_bool m_replay_running;
 };
\ No newline at end of file
@@ -0,0 +1,203 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "smartstart_recording.h"
+
+#include <QAction>
+#include <QDateTime>
+#include <QFileDialog>
+#include <QMenu>
+#include <QMessageBox>
+
+#include <filesystem>
+#include <memory>
+
+#include "plugin_window.h"
+#include "span_tracer.h"
+#include "trace_replay.h"
+#include "constants.h"
+
+//The parts of the plugin which need Qt: the Tools menu and what it opens. Everything else lives in smartstart_recording.cpp, which also builds without Qt.
+
+bool smartstart_recording::load()
+{
+	m_config.load();
+
+	auto* action = static_cast<QAction*>(obs_frontend_add_tools_menu_qaction(obs_module_text(PLUGIN_NAME.data())));
+
+	auto cb = []
+		{
+			//Code for opening window for plugin here
+			obs_frontend_push_ui_translation(obs_module_get_string);
+
+			auto my_window = new plugin_window(static_cast<QMainWindow*>(obs_frontend_get_main_window()));
+
+			my_window->setAttribute(Qt::WA_DeleteOnClose);
+			my_window->show();
+
+			obs_frontend_pop_ui_translation();
+		};
+
+	QAction::connect(action, &QAction::triggered, cb);
+
+	//Traces are for reproducing timing problems offline, they live in their own menu
+	auto* trace_action = static_cast<QAction*>(obs_frontend_add_tools_menu_qaction(obs_module_text("trace_menu")));
+	auto* trace_menu = new QMenu{};
+	trace_action->setMenu(trace_menu);
+
+	auto* record_action = trace_menu->addAction(obs_module_text("trace_menu.record"));
+	record_action->setCheckable(true);
+	QAction::connect(record_action, &QAction::toggled, [this](bool checked) -> void
+		{
+			if (checked)
+				start_trace();
+			else
+				stop_trace();
+		});
+
+	QAction::connect(trace_menu->addAction(obs_module_text("trace_menu.replay")), &QAction::triggered, [this]() -> void
+		{
+			start_replay(trace_replay::speed::fastest);
+		});
+
+	QAction::connect(trace_menu->addAction(obs_module_text("trace_menu.replay_real_time")), &QAction::triggered, [this]() -> void
+		{
+			start_replay(trace_replay::speed::real_time);
+		});
+
+	QAction::connect(trace_menu->addAction(obs_module_text("trace_menu.stop_replay")), &QAction::triggered, [this]() -> void
+		{
+			m_replay_cancel = true;
+		});
+
+	//Profiles show where the plugin's own threads spend their time, for Perfetto or chrome://tracing
+	trace_menu->addSeparator();
+
+	auto* profile_action = trace_menu->addAction(obs_module_text("trace_menu.profile"));
+	profile_action->setCheckable(true);
+	QAction::connect(profile_action, &QAction::toggled, [](bool checked) -> void
+		{
+			span_tracer::get().set_enabled(checked);
+		});
+
+	QAction::connect(trace_menu->addAction(obs_module_text("trace_menu.save_profile")), &QAction::triggered, [this]() -> void
+		{
+			save_profile();
+		});
+
+	//The configuration is loaded, from here on the plugin follows OBS
+	attach();
+
+	return true;
+}
+
+void smartstart_recording::start_trace()
+{
+	auto file_name = "traces/" + QDateTime::currentDateTime().toString("yyyy-MM-dd_HH-mm-ss").toStdString() + ".sstrace";
+	auto path_ptr = std::unique_ptr<char, std::function<void(char*)>>(obs_module_config_path(file_name.c_str()), [](char* ptr) -> void {bfree(ptr); });
+
+	if (!path_ptr || !m_trace_recorder.start(std::filesystem::u8path(path_ptr.get())))
+	{
+		blog(LOG_WARNING, "[%s] Could not start recording a trace", PLUGIN_NAME_SHORT.data());
+		return;
+	}
+
+	blog(LOG_INFO, "[%s] Recording trace to %s", PLUGIN_NAME_SHORT.data(), path_ptr.get());
+}
+
+void smartstart_recording::save_profile()
+{
+	auto main_window = static_cast<QWidget*>(obs_frontend_get_main_window());
+
+	auto file_name = "profiles/" + QDateTime::currentDateTime().toString("yyyy-MM-dd_HH-mm-ss").toStdString() + ".json";
+	auto path_ptr = std::unique_ptr<char, std::function<void(char*)>>(obs_module_config_path(file_name.c_str()), [](char* ptr) -> void {bfree(ptr); });
+
+	if (!path_ptr || !span_tracer::get().write_json(std::filesystem::u8path(path_ptr.get())))
+	{
+		blog(LOG_WARNING, "[%s] Could not save the profile", PLUGIN_NAME_SHORT.data());
+		QMessageBox::warning(main_window, obs_module_text("msgbox_profile.title"), obs_module_text("msgbox_profile.failed"));
+		return;
+	}
+
+	if (span_tracer::get().get_dropped())
+		blog(LOG_INFO, "[%s] %llu profile events were dropped, too many threads", PLUGIN_NAME_SHORT.data(), static_cast<unsigned long long>(span_tracer::get().get_dropped()));
+
+	blog(LOG_INFO, "[%s] Profile saved to %s", PLUGIN_NAME_SHORT.data(), path_ptr.get());
+	QMessageBox::information(main_window, obs_module_text("msgbox_profile.title"), QString{ obs_module_text("msgbox_profile.saved") }.arg(path_ptr.get()));
+}
+
+void smartstart_recording::start_replay(trace_replay::speed replay_speed)
+{
+	auto main_window = static_cast<QWidget*>(obs_frontend_get_main_window());
+
+	if (m_replay_thread.joinable())
+	{
+		if (m_replay_running)
+		{
+			QMessageBox::information(main_window, obs_module_text("msgbox_replay.title"), obs_module_text("msgbox_replay.busy"));
+			return;
+		}
+
+		m_replay_thread.join();
+	}
+
+	auto directory_ptr = std::unique_ptr<char, std::function<void(char*)>>(obs_module_config_path("traces"), [](char* ptr) -> void {bfree(ptr); });
+	auto file_name = QFileDialog::getOpenFileName(main_window, obs_module_text("msgbox_replay.title"), directory_ptr ? directory_ptr.get() : "", "SmartStart Trace (*.sstrace)");
+	if (file_name.isEmpty())
+		return;
+
+	std::vector<trace_record> records;
+	if (!trace_recorder::load(std::filesystem::u8path(file_name.toStdString()), records))
+	{
+		QMessageBox::warning(main_window, obs_module_text("msgbox_replay.title"), obs_module_text("msgbox_replay.failed"));
+		return;
+	}
+
+	m_replay_cancel = false;
+	m_replay_running = true;
+
+	//The replay works on the rules as they are now, a copy keeps them stable for as long as it runs
+	m_replay_thread = std::thread{ [this, replay_speed, records = std::move(records), settings = m_recording_settings.read()->get_settings()]() mutable -> void
+		{
+			rule_snapshot rules{ std::move(settings), 0 };
+			trace_replay replay{ std::move(records) };
+
+			auto result = std::make_unique<trace_replay::result>(replay.run(rules, replay_speed, &m_replay_cancel));
+			m_replay_running = false;
+
+			blog(LOG_INFO, "[%s] Replayed %zu events, %zu recorded and %zu replayed decisions, %zu mismatches, largest drift %lld ns", PLUGIN_NAME_SHORT.data(), result->m_events, result->m_recorded_decisions, result->m_replayed_decisions, result->m_mismatches, static_cast<long long>(result->m_max_drift));
+
+			//Cancelled replays (e.g. on unload) are only logged
+			if (m_replay_cancel)
+				return;
+
+			obs_queue_task(OBS_TASK_UI, [](void* param) -> void
+				{
+					auto result = std::unique_ptr<trace_replay::result>(static_cast<trace_replay::result*>(param));
+
+					auto text = QString{ obs_module_text("msgbox_replay.text") }
+						.arg(static_cast<unsigned long long>(result->m_events))
+						.arg(static_cast<unsigned long long>(result->m_recorded_decisions))
+						.arg(static_cast<unsigned long long>(result->m_replayed_decisions))
+						.arg(static_cast<unsigned long long>(result->m_mismatches))
+						.arg(static_cast<double>(result->m_max_drift) / 1000000.0, 0, 'f', 3);
+
+					QMessageBox::information(static_cast<QWidget*>(obs_frontend_get_main_window()), obs_module_text("msgbox_replay.title"), text);
+				}, result.release(), false);
+		} };
+}
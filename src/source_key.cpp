@@ -0,0 +1,120 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "source_key.h"
+
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <random>
+
+static int hex_value(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+
+	return -1;
+}
+
+source_key source_key::from_uuid(std::string_view uuid)
+{
+	uint64_t halves[2] = { 0, 0 };
+	size_t digits = 0;
+
+	for (auto c : uuid)
+	{
+		if (c == '-')
+			continue;
+
+		auto value = hex_value(c);
+		if (value < 0 || digits >= 32)
+			return source_key{};
+
+		auto& half = halves[digits / 16];
+		half = (half << 4) | static_cast<uint64_t>(value);
+		++digits;
+	}
+
+	if (digits != 32)
+		return source_key{};
+
+	return source_key{ halves[0], halves[1] };
+}
+
+source_key source_key::from_source(const obs_source_t* source)
+{
+	if (!source)
+		return source_key{};
+
+	auto uuid = obs_source_get_uuid(source);
+	if (!uuid)
+		return source_key{};
+
+	return from_uuid(uuid);
+}
+
+source_key source_key::from_name(const char* name)
+{
+	if (!name || !*name)
+		return source_key{};
+
+	auto source = std::unique_ptr<obs_source_t, std::function<void(obs_source_t*)>>(obs_get_source_by_name(name), [](obs_source_t* ptr) -> void {obs_source_release(ptr); });
+
+	return from_source(source.get());
+}
+
+source_key source_key::generate()
+{
+	static std::mutex mutex;
+	static std::mt19937_64 engine{ std::random_device{}() };
+
+	std::lock_guard<std::mutex> lock{ mutex };
+
+	//Same version and variant bits as a random UUID, so the key survives a round trip through to_string() and from_uuid()
+	auto high = (engine() & ~0xF000ull) | 0x4000ull;
+	auto low = (engine() & ~(0x3ull << 62)) | (0x2ull << 62);
+
+	return source_key{ high, low };
+}
+
+std::string source_key::to_string() const
+{
+	constexpr std::string_view HEX = "0123456789abcdef";
+
+	std::string result;
+	result.reserve(36);
+
+	for (int i = 0; i < 32; ++i)
+	{
+		if (i == 8 || i == 12 || i == 16 || i == 20)
+			result.push_back('-');
+
+		auto half = i < 16 ? m_high : m_low;
+		auto shift = (15 - (i % 16)) * 4;
+
+		result.push_back(HEX[(half >> shift) & 0xF]);
+	}
+
+	return result;
+}
@@ -0,0 +1,87 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+//Stable identity of an OBS source, taken from its UUID.
+//The 128 bit value is stored as two integers, so comparing and hashing never touches a string.
+class source_key
+{
+	public:
+		source_key()
+		{ }
+
+		source_key(uint64_t high, uint64_t low)
+			: m_high{ high }
+			, m_low{ low }
+		{ }
+
+		friend bool operator==(const source_key& lhs, const source_key& rhs);
+		friend bool operator!=(const source_key& lhs, const source_key& rhs);
+
+	public:
+		//Parses the canonical "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx" form, returns an invalid key on malformed input
+		static source_key from_uuid(std::string_view uuid);
+		static source_key from_source(const obs_source_t* source);
+		static source_key from_name(const char* name);
+
+		//Random key for things that are no OBS source, e.g. pattern rules
+		static source_key generate();
+
+		std::string to_string() const;
+
+		inline bool valid() const { return m_high || m_low; }
+		inline uint64_t get_high() const { return m_high; }
+		inline uint64_t get_low() const { return m_low; }
+
+		//UUIDs are random already, a cheap mix of both halves is enough
+		inline uint64_t hash() const
+		{
+			uint64_t h = m_high ^ (m_low * 0x9E3779B97F4A7C15ull);
+			h ^= h >> 32;
+
+			return h;
+		}
+
+	protected:
+
+	private:
+		uint64_t m_high = 0;
+		uint64_t m_low = 0;
+};
+
+inline bool operator==(const source_key& lhs, const source_key& rhs)
+{
+	return lhs.m_high == rhs.m_high && lhs.m_low == rhs.m_low;
+}
+
+inline bool operator!=(const source_key& lhs, const source_key& rhs)
+{
+	return lhs.m_high != rhs.m_high || lhs.m_low != rhs.m_low;
+}
+
+struct source_key_hash
+{
+	inline size_t operator()(const source_key& key) const { return static_cast<size_t>(key.hash()); }
+};
@@ -0,0 +1,175 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "span_tracer.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <system_error>
+
+std::atomic_bool span_tracer::s_enabled{ false };
+thread_local span_tracer::ring* span_tracer::t_ring = nullptr;
+thread_local const char* span_tracer::t_thread_name = nullptr;
+
+span_tracer::span_tracer()
+	: m_epoch{ 0 }
+	, m_dropped{ 0 }
+{ }
+
+span_tracer& span_tracer::get()
+{
+	static span_tracer instance{};
+	return instance;
+}
+
+void span_tracer::set_enabled(bool value)
+{
+	if (value)
+		m_epoch.store(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+
+	s_enabled.store(value, std::memory_order_relaxed);
+}
+
+span_tracer::ring* span_tracer::thread_ring()
+{
+	if (t_ring)
+		return t_ring;
+
+	std::lock_guard<std::mutex> lock{ m_threads_mutex };
+
+	//OBS runs a handful of threads, more than that means threads come and go and we stop following new ones
+	if (m_threads.size() >= MAX_THREADS)
+		return nullptr;
+
+	auto r = std::make_unique<ring>();
+	r->m_thread_id = static_cast<uint32_t>(m_threads.size() + 1);
+	r->m_thread_name = t_thread_name ? t_thread_name : "thread " + std::to_string(r->m_thread_id);
+
+	t_ring = r.get();
+	m_threads.push_back(std::move(r));
+
+	return t_ring;
+}
+
+void span_tracer::record(phase value, const char* name)
+{
+	auto r = thread_ring();
+	if (!r)
+	{
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+
+	auto index = r->m_published.load(std::memory_order_relaxed);
+	auto& e = r->m_events[index & (RING_SIZE - 1)];
+
+	//Seqlock style: the claim has to be visible before any field of the overwritten event changes
+	r->m_claimed.store(index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	e.m_time.store(time, std::memory_order_relaxed);
+	e.m_name.store(name, std::memory_order_relaxed);
+	e.m_phase.store(value, std::memory_order_relaxed);
+
+	r->m_published.store(index + 1, std::memory_order_release);
+}
+
+bool span_tracer::write_json(const std::filesystem::path& path) const
+{
+	std::vector<exported_event> events;
+	std::vector<std::pair<uint32_t, std::string>> thread_names;
+
+	auto epoch = m_epoch.load(std::memory_order_relaxed);
+
+	{
+		std::lock_guard<std::mutex> lock{ m_threads_mutex };
+
+		for (auto& r : m_threads)
+		{
+			thread_names.emplace_back(r->m_thread_id, r->m_thread_name);
+
+			auto published = r->m_published.load(std::memory_order_acquire);
+			auto first = published > RING_SIZE ? published - RING_SIZE : 0;
+			auto copied = events.size();
+
+			for (auto i = first; i < published; ++i)
+			{
+				auto& e = r->m_events[i & (RING_SIZE - 1)];
+				events.push_back(exported_event{ e.m_time.load(std::memory_order_relaxed), e.m_name.load(std::memory_order_relaxed), e.m_phase.load(std::memory_order_relaxed), r->m_thread_id });
+			}
+
+			//Everything the producer may have started to overwrite while we copied is dropped
+			std::atomic_thread_fence(std::memory_order_acquire);
+			auto claimed = r->m_claimed.load(std::memory_order_relaxed);
+			auto valid_from = claimed > RING_SIZE ? claimed - RING_SIZE + 1 : 0;
+
+			if (valid_from > first)
+			{
+				auto stale = static_cast<size_t>(std::min(valid_from, published) - first);
+				events.erase(events.begin() + copied, events.begin() + copied + stale);
+			}
+		}
+	}
+
+	//Earlier profiling sessions are still in the rings
+	events.erase(std::remove_if(events.begin(), events.end(), [epoch](const exported_event& e) -> bool { return e.m_time < epoch || !e.m_name; }), events.end());
+
+	std::stable_sort(events.begin(), events.end(), [](const exported_event& lhs, const exported_event& rhs) -> bool
+		{
+			return lhs.m_time < rhs.m_time;
+		});
+
+	std::error_code error;
+	std::filesystem::create_directories(path.parent_path(), error);
+
+	std::ofstream stream{ path, std::ios::trunc };
+	if (!stream)
+		return false;
+
+	stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+	//Names are string literals of ours, they never need escaping. Thread names are plain ASCII as well.
+	char buffer[256];
+	bool first = true;
+
+	for (auto& [thread_id, thread_name] : thread_names)
+	{
+		std::snprintf(buffer, sizeof(buffer), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", thread_id, thread_name.c_str());
+		stream << buffer;
+		first = false;
+	}
+
+	for (auto& e : events)
+	{
+		auto time = e.m_time - epoch;
+
+		//Chrome expects microseconds, the fraction keeps the nanoseconds
+		std::snprintf(buffer, sizeof(buffer), "%s{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%" PRId64 ".%03" PRId64 "%s}", first ? "" : ",\n",
+			e.m_name, static_cast<char>(e.m_phase), e.m_thread_id, time / 1000, time % 1000, e.m_phase == phase::instant ? ",\"s\":\"t\"" : "");
+		stream << buffer;
+		first = false;
+	}
+
+	stream << "\n]}\n";
+
+	return static_cast<bool>(stream);
+}
@@ -0,0 +1,150 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//Opt-in profiler for the plugin's own threads. Collects begin/end spans and instant events into
+//per-thread rings and exports them as Chrome trace-event JSON, which Perfetto and chrome://tracing load.
+//While disabled every probe is a single relaxed load and a branch. Names must be string literals, only the pointer is kept.
+class span_tracer
+{
+	public:
+		enum class phase : uint8_t
+		{
+			begin = 'B',
+			end = 'E',
+			instant = 'i'
+		};
+
+		//Records a begin event now and the matching end event when leaving the scope
+		class scope
+		{
+			public:
+				explicit scope(const char* name)
+					: m_name{ is_enabled() ? name : nullptr }
+				{
+					if (m_name)
+						get().record(phase::begin, m_name);
+				}
+
+				~scope()
+				{
+					//Ends even if tracing was switched off in between, so no span stays open
+					if (m_name)
+						get().record(phase::end, m_name);
+				}
+
+				//No copying
+				scope(const scope& other) = delete;
+				scope& operator = (const scope& other) = delete;
+
+			private:
+				const char* m_name;
+		};
+
+		static span_tracer& get();
+
+		static inline bool is_enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+		static inline void instant(const char* name)
+		{
+			if (is_enabled())
+				get().record(phase::instant, name);
+		}
+
+		//No copying
+		span_tracer(const span_tracer& other) = delete;
+		span_tracer& operator = (const span_tracer& other) = delete;
+
+	public:
+		//Enabling starts a new profile, events from earlier sessions are not exported anymore
+		void set_enabled(bool value);
+
+		//Shown as the track name of the calling thread, takes effect with the thread's first event
+		static inline void set_thread_name(const char* name) { t_thread_name = name; }
+
+		//Safe while events are being recorded, whatever gets overwritten during the copy is left out
+		bool write_json(const std::filesystem::path& path) const;
+
+		inline uint64_t get_dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+	protected:
+
+	private:
+		using clock = std::chrono::steady_clock;
+
+		//Per thread, oldest events are overwritten once full
+		static constexpr size_t RING_SIZE = 8192;
+		static constexpr size_t MAX_THREADS = 64;
+
+		static_assert((RING_SIZE & (RING_SIZE - 1)) == 0, "the ring size must be a power of two");
+
+		struct event
+		{
+			std::atomic<int64_t> m_time{ 0 };
+			std::atomic<const char*> m_name{ nullptr };
+			std::atomic<phase> m_phase{ phase::instant };
+		};
+
+		//Single producer: only the owning thread writes. m_claimed moves before an event is written, m_published after,
+		//so a reader can tell which of the events it copied might have been overwritten meanwhile.
+		struct ring
+		{
+			alignas(64) std::atomic<uint64_t> m_claimed{ 0 };
+			std::atomic<uint64_t> m_published{ 0 };
+			std::array<event, RING_SIZE> m_events;
+
+			uint32_t m_thread_id = 0;
+			std::string m_thread_name;
+		};
+
+		struct exported_event
+		{
+			int64_t m_time;
+			const char* m_name;
+			phase m_phase;
+			uint32_t m_thread_id;
+		};
+
+		span_tracer();
+
+		void record(phase value, const char* name);
+		ring* thread_ring();
+
+		static std::atomic_bool s_enabled;
+
+		//Rings are owned by the tracer and outlive their threads, a thread only remembers where its ring is
+		static thread_local ring* t_ring;
+		static thread_local const char* t_thread_name;
+
+		std::atomic<int64_t> m_epoch;
+		std::atomic<uint64_t> m_dropped;
+
+		mutable std::mutex m_threads_mutex;
+		std::vector<std::unique_ptr<ring>> m_threads;
+};
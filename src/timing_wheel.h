@@ -0,0 +1,344 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+//Hierarchical timing wheel with millisecond ticks.
+//Four levels of 64 slots cover ~4.6 hours, anything further out waits in an overflow list.
+//Scheduling and cancelling are O(1), advancing only touches slots which actually hold timers.
+//Not thread safe, the owner is expected to drive it from a single thread.
+template <typename T>
+class timing_wheel
+{
+	public:
+		using clock = std::chrono::steady_clock;
+		using tick = std::chrono::milliseconds;
+
+		class handle
+		{
+			public:
+				handle()
+				{ }
+
+				inline bool valid() const { return m_index != NPOS; }
+
+			private:
+				friend class timing_wheel;
+
+				handle(uint32_t index, uint32_t generation)
+					: m_index{ index }
+					, m_generation{ generation }
+				{ }
+
+				uint32_t m_index = NPOS;
+				uint32_t m_generation = 0;
+		};
+
+		explicit timing_wheel(clock::time_point epoch = clock::now())
+			: m_epoch{ epoch }
+		{
+			m_slots.fill(NPOS);
+			m_occupied.fill(0);
+		}
+
+		handle schedule(clock::time_point deadline, T payload)
+		{
+			auto index = allocate_node();
+			auto& n = m_nodes[index];
+
+			n.m_payload = std::move(payload);
+			n.m_expiry = std::max(to_tick(deadline), m_current + 1);
+			n.m_active = true;
+			place(index);
+
+			++m_size;
+
+			return handle{ index, n.m_generation };
+		}
+
+		bool cancel(handle h)
+		{
+			if (!h.valid() || h.m_index >= m_nodes.size())
+				return false;
+
+			auto& n = m_nodes[h.m_index];
+			if (!n.m_active || n.m_generation != h.m_generation)
+				return false;
+
+			unlink(h.m_index);
+			release_node(h.m_index);
+			--m_size;
+
+			return true;
+		}
+
+		//Fires every timer due at or before now. Timers may be scheduled or cancelled from inside the callback.
+		template <typename F>
+		size_t advance(clock::time_point now, F&& on_expired)
+		{
+			size_t fired = 0;
+			int64_t target = to_tick_floor(now);
+
+			while (m_current < target)
+			{
+				auto next = next_event_tick();
+				if (!next || *next > target)
+				{
+					//Nothing happens in between, we can skip the idle ticks in one go
+					m_current = target;
+					break;
+				}
+
+				m_current = *next;
+				cascade();
+
+				auto slot = slot_index(0, digit(m_current, 0));
+				while (m_slots[slot] != NPOS)
+				{
+					auto index = m_slots[slot];
+					unlink(index);
+
+					T payload = std::move(m_nodes[index].m_payload);
+					release_node(index);
+					--m_size;
+					++fired;
+
+					on_expired(payload);
+				}
+			}
+
+			return fired;
+		}
+
+		//Earliest point in time the wheel needs attention. May be a cascade point earlier than the real expiry.
+		std::optional<clock::time_point> next_deadline() const
+		{
+			auto next = next_event_tick();
+			if (!next)
+				return std::nullopt;
+
+			return m_epoch + tick{ *next };
+		}
+
+		inline size_t size() const { return m_size; }
+		inline bool empty() const { return m_size == 0; }
+
+	protected:
+
+	private:
+		static constexpr uint32_t NPOS = std::numeric_limits<uint32_t>::max();
+		static constexpr uint32_t OVERFLOW_SLOT = NPOS - 1;
+		static constexpr int SLOT_BITS = 6;
+		static constexpr int SLOTS = 1 << SLOT_BITS;
+		static constexpr int LEVELS = 4;
+		static constexpr int WHEEL_BITS = SLOT_BITS * LEVELS;
+
+		struct node
+		{
+			T m_payload{};
+			int64_t m_expiry = 0;
+			uint32_t m_prev = NPOS;
+			uint32_t m_next = NPOS;
+			uint32_t m_slot = NPOS;
+			uint32_t m_generation = 0;
+			bool m_active = false;
+		};
+
+		static inline uint32_t digit(int64_t value, int level) { return static_cast<uint32_t>(value >> (level * SLOT_BITS)) & (SLOTS - 1); }
+		static inline uint32_t slot_index(int level, uint32_t digit) { return static_cast<uint32_t>(level * SLOTS) + digit; }
+
+		static int lowest_bit(uint64_t value)
+		{
+			int result = 0;
+			while (!(value & 1))
+			{
+				value >>= 1;
+				++result;
+			}
+
+			return result;
+		}
+
+		int64_t to_tick(clock::time_point time) const
+		{
+			auto delta = std::chrono::ceil<tick>(time - m_epoch).count();
+			return delta < 0 ? 0 : delta;
+		}
+
+		int64_t to_tick_floor(clock::time_point time) const
+		{
+			auto delta = std::chrono::floor<tick>(time - m_epoch).count();
+			return delta < 0 ? 0 : delta;
+		}
+
+		uint32_t allocate_node()
+		{
+			if (m_free != NPOS)
+			{
+				auto index = m_free;
+				m_free = m_nodes[index].m_next;
+				m_nodes[index].m_next = NPOS;
+
+				return index;
+			}
+
+			m_nodes.emplace_back();
+			return static_cast<uint32_t>(m_nodes.size() - 1);
+		}
+
+		void release_node(uint32_t index)
+		{
+			auto& n = m_nodes[index];
+			n.m_active = false;
+			n.m_payload = T{};
+			++n.m_generation;
+			n.m_prev = NPOS;
+			n.m_slot = NPOS;
+			n.m_next = m_free;
+			m_free = index;
+		}
+
+		//The level is picked by the highest bit in which expiry and current tick differ
+		void place(uint32_t index)
+		{
+			auto& n = m_nodes[index];
+			uint64_t diff = static_cast<uint64_t>(n.m_expiry ^ m_current);
+
+			if (diff >> WHEEL_BITS)
+			{
+				push_front(m_overflow, index, OVERFLOW_SLOT);
+				return;
+			}
+
+			int level = 0;
+			while (diff >> ((level + 1) * SLOT_BITS))
+				++level;
+
+			auto slot = slot_index(level, digit(n.m_expiry, level));
+			push_front(m_slots[slot], index, slot);
+			m_occupied[level] |= uint64_t{ 1 } << digit(n.m_expiry, level);
+		}
+
+		void push_front(uint32_t& head, uint32_t index, uint32_t slot)
+		{
+			auto& n = m_nodes[index];
+			n.m_prev = NPOS;
+			n.m_next = head;
+			n.m_slot = slot;
+
+			if (head != NPOS)
+				m_nodes[head].m_prev = index;
+
+			head = index;
+		}
+
+		void unlink(uint32_t index)
+		{
+			auto& n = m_nodes[index];
+
+			if (n.m_prev != NPOS)
+				m_nodes[n.m_prev].m_next = n.m_next;
+			else if (n.m_slot == OVERFLOW_SLOT)
+				m_overflow = n.m_next;
+			else
+				m_slots[n.m_slot] = n.m_next;
+
+			if (n.m_next != NPOS)
+				m_nodes[n.m_next].m_prev = n.m_prev;
+
+			if (n.m_slot != OVERFLOW_SLOT && m_slots[n.m_slot] == NPOS)
+				m_occupied[n.m_slot / SLOTS] &= ~(uint64_t{ 1 } << (n.m_slot % SLOTS));
+
+			n.m_prev = NPOS;
+			n.m_next = NPOS;
+		}
+
+		void redistribute(uint32_t& head)
+		{
+			auto index = head;
+			head = NPOS;
+
+			while (index != NPOS)
+			{
+				auto next = m_nodes[index].m_next;
+				place(index);
+				index = next;
+			}
+		}
+
+		//Moves timers from coarse slots into finer ones whenever the current tick crosses their boundary
+		void cascade()
+		{
+			if ((m_current & ((int64_t{ 1 } << WHEEL_BITS) - 1)) == 0)
+				redistribute(m_overflow);
+
+			for (int level = LEVELS - 1; level > 0; --level)
+			{
+				if (m_current & ((int64_t{ 1 } << (level * SLOT_BITS)) - 1))
+					continue;
+
+				auto d = digit(m_current, level);
+				auto slot = slot_index(level, d);
+				m_occupied[level] &= ~(uint64_t{ 1 } << d);
+				redistribute(m_slots[slot]);
+			}
+		}
+
+		std::optional<int64_t> next_event_tick() const
+		{
+			if (!m_size)
+				return std::nullopt;
+
+			for (int level = 0; level < LEVELS; ++level)
+			{
+				auto current_digit = digit(m_current, level);
+				auto pending = current_digit == SLOTS - 1 ? 0 : m_occupied[level] & (~uint64_t{ 0 } << (current_digit + 1));
+
+				if (pending)
+				{
+					int shift = (level + 1) * SLOT_BITS;
+					int64_t base = (m_current >> shift) << shift;
+
+					return base | (static_cast<int64_t>(lowest_bit(pending)) << (level * SLOT_BITS));
+				}
+			}
+
+			//Only overflow timers left, they are looked at again when the top level wraps around
+			return ((m_current >> WHEEL_BITS) + 1) << WHEEL_BITS;
+		}
+
+		clock::time_point m_epoch;
+		int64_t m_current = 0;
+		size_t m_size = 0;
+
+		std::vector<node> m_nodes;
+		uint32_t m_free = NPOS;
+		uint32_t m_overflow = NPOS;
+
+		std::array<uint32_t, SLOTS * LEVELS> m_slots;
+		std::array<uint64_t, LEVELS> m_occupied;
+};
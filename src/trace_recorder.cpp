@@ -0,0 +1,165 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "trace_recorder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <system_error>
+
+struct trace_file_header
+{
+	uint32_t m_magic;
+	uint16_t m_version;
+	uint16_t m_record_size;
+	uint64_t m_reserved;
+};
+
+static_assert(sizeof(trace_record) == 32 && sizeof(trace_file_header) == 16, "the file layout must not depend on padding");
+
+trace_recorder::trace_recorder()
+	: m_recording{ false }
+	, m_exit{ false }
+	, m_written{ 0 }
+	, m_dropped{ 0 }
+{ }
+
+trace_recorder::~trace_recorder()
+{
+	stop();
+}
+
+bool trace_recorder::start(const std::filesystem::path& path)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	if (m_thread.joinable())
+		return false;
+
+	std::error_code error;
+	std::filesystem::create_directories(path.parent_path(), error);
+
+	m_stream.open(path, std::ios::binary | std::ios::trunc);
+	if (!m_stream)
+		return false;
+
+	trace_file_header header{ MAGIC, VERSION, sizeof(trace_record), 0 };
+	m_stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	//Whatever arrived after the previous stop does not belong to this trace
+	trace_record stale;
+	while (m_queue.try_pop(stale))
+	{ }
+
+	m_written = 0;
+	m_dropped = 0;
+	m_exit = false;
+	m_recording = true;
+	m_thread = std::thread{ &trace_recorder::work, this };
+
+	return true;
+}
+
+void trace_recorder::stop()
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	if (!m_thread.joinable())
+		return;
+
+	m_recording = false;
+	m_exit = true;
+	m_wake_writer.notify();
+	m_thread.join();
+
+	m_stream.close();
+}
+
+bool trace_recorder::load(const std::filesystem::path& path, std::vector<trace_record>& records)
+{
+	records.clear();
+
+	std::ifstream stream{ path, std::ios::binary };
+	if (!stream)
+		return false;
+
+	trace_file_header header{};
+	if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return false;
+
+	if (header.m_magic != MAGIC || header.m_version != VERSION || header.m_record_size < sizeof(trace_record))
+		return false;
+
+	std::vector<char> buffer(header.m_record_size);
+	while (stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size())))
+	{
+		trace_record r;
+		std::memcpy(&r, buffer.data(), sizeof(r));
+		records.push_back(r);
+	}
+
+	//The writer drains a queue fed by several threads, restore the order of occurrence
+	std::stable_sort(records.begin(), records.end(), [](const trace_record& lhs, const trace_record& rhs) -> bool
+		{
+			return lhs.m_time < rhs.m_time;
+		});
+
+	return true;
+}
+
+void trace_recorder::push(clock::time_point time, trace_event type, uint8_t code, uint32_t value, const source_key& key)
+{
+	trace_record r{};
+	r.m_time = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+	r.m_type = static_cast<uint8_t>(type);
+	r.m_code = code;
+	r.m_value = value;
+	r.m_key_high = key.get_high();
+	r.m_key_low = key.get_low();
+
+	if (!m_queue.try_push(r))
+	{
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	m_wake_writer.notify();
+}
+
+void trace_recorder::work()
+{
+	while (!m_exit)
+	{
+		drain();
+		m_wake_writer.wait();
+	}
+
+	drain();
+	m_stream.flush();
+}
+
+void trace_recorder::drain()
+{
+	trace_record r;
+	while (m_queue.try_pop(r))
+	{
+		m_stream.write(reinterpret_cast<const char*>(&r), sizeof(r));
+		m_written.fetch_add(1, std::memory_order_relaxed);
+	}
+}
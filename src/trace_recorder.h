@@ -0,0 +1,118 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mpsc_queue.h"
+#include "source_key.h"
+#include "wakeup_event.h"
+
+enum class trace_event : uint8_t
+{
+	frontend_event = 1,
+	transition_start,
+	decision
+};
+
+//One fixed-size entry of a trace file
+struct trace_record
+{
+	int64_t m_time;		//steady clock, nanoseconds
+	uint8_t m_type;		//trace_event
+	uint8_t m_code;		//frontend event or controller decision
+	uint16_t m_reserved;
+	uint32_t m_value;	//e.g. the target state of a decision
+	uint64_t m_key_high;	//scene involved, if any
+	uint64_t m_key_low;
+};
+
+//Records frontend events, transition starts and controller decisions into a compact binary file.
+//record() is lock-free and costs a single relaxed load while no trace is being recorded, a writer thread does the file I/O.
+class trace_recorder
+{
+	public:
+		using clock = std::chrono::steady_clock;
+
+		static constexpr uint32_t MAGIC = 0x54525353;	//"SSRT"
+		static constexpr uint16_t VERSION = 1;
+
+		trace_recorder();
+		~trace_recorder();
+
+		//No copying
+		trace_recorder(const trace_recorder& other) = delete;
+		trace_recorder& operator = (const trace_recorder& other) = delete;
+
+	public:
+		bool start(const std::filesystem::path& path);
+		void stop();
+
+		inline bool is_recording() const { return m_recording.load(std::memory_order_relaxed); }
+
+		inline void record(trace_event type, uint8_t code, uint32_t value = 0, const source_key& key = {})
+		{
+			if (!is_recording())
+				return;
+
+			push(clock::now(), type, code, value, key);
+		}
+
+		inline void record_at(clock::time_point time, trace_event type, uint8_t code, uint32_t value = 0, const source_key& key = {})
+		{
+			if (!is_recording())
+				return;
+
+			push(time, type, code, value, key);
+		}
+
+		inline uint64_t get_written() const { return m_written.load(std::memory_order_relaxed); }
+		inline uint64_t get_dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+		static bool load(const std::filesystem::path& path, std::vector<trace_record>& records);
+
+	protected:
+
+	private:
+		static constexpr size_t QUEUE_SIZE = 8192;
+
+		void push(clock::time_point time, trace_event type, uint8_t code, uint32_t value, const source_key& key);
+		void work();
+		void drain();
+
+		mpsc_queue<trace_record, QUEUE_SIZE> m_queue;
+		wakeup_event m_wake_writer;
+
+		std::atomic_bool m_recording;
+		std::atomic_bool m_exit;
+		std::atomic<uint64_t> m_written;
+		std::atomic<uint64_t> m_dropped;
+
+		//Serializes start() and stop()
+		std::mutex m_mutex;
+		std::ofstream m_stream;
+		std::thread m_thread;
+};
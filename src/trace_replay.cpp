@@ -0,0 +1,177 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "trace_replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+#include "recording_controller.h"
+#include "scene_dispatcher.h"
+#include "smartstart_recording.h"
+#include "virtual_clock.h"
+
+//A replay must never touch the real recording, the decisions are all we are after
+static recording_frontend replay_frontend()
+{
+	return recording_frontend
+	{
+		[]() -> void {},
+		[]() -> void {},
+		[]() -> bool { return false; },
+		[]() -> bool { return false; },
+		[](bool pause) -> void { (void)pause; },
+		[]() -> bool { return false; },
+		[]() -> bool { return false; },
+		[]() -> void {},
+		[]() -> bool { return true; }
+	};
+}
+
+static trace_record make_decision_record(recording_controller::clock::time_point time, recording_controller::decision value, recording_controller::state target_state)
+{
+	trace_record r{};
+	r.m_time = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+	r.m_type = static_cast<uint8_t>(trace_event::decision);
+	r.m_code = static_cast<uint8_t>(value);
+	r.m_value = static_cast<uint32_t>(target_state);
+
+	return r;
+}
+
+trace_replay::trace_replay(std::vector<trace_record> records)
+	: m_records{ std::move(records) }
+{ }
+
+trace_replay::result trace_replay::run(const rule_snapshot& rules, speed replay_speed, const std::atomic_bool* cancel) const
+{
+	using clock = recording_controller::clock;
+
+	result replay_result;
+	if (m_records.empty())
+		return replay_result;
+
+	auto to_time_point = [](int64_t time) -> clock::time_point
+		{
+			return clock::time_point{ std::chrono::duration_cast<clock::duration>(std::chrono::nanoseconds{ time }) };
+		};
+
+	virtual_clock time{ to_time_point(m_records.front().m_time) };
+
+	recording_controller::options controller_options;
+	controller_options.m_frontend = replay_frontend();
+	controller_options.m_manual_clock = &time;
+	controller_options.m_on_decision = [&replay_result](recording_controller::decision value, recording_controller::state target_state, clock::time_point decision_time) -> void
+		{
+			replay_result.m_decisions.push_back(make_decision_record(decision_time, value, target_state));
+		};
+
+	recording_controller controller{ std::move(controller_options) };
+	scene_dispatcher dispatcher{ controller };
+
+	std::vector<trace_record> recorded_decisions;
+
+	auto wall_start = std::chrono::steady_clock::now();
+	auto trace_start = to_time_point(m_records.front().m_time);
+
+	//Timers due before the next event fire at their own (virtual) time, not at the time of the event
+	auto run_until = [&controller, &time](clock::time_point target) -> void
+		{
+			auto next = controller.process(time.now());
+			while (next && *next <= target)
+			{
+				time.advance_to(*next);
+				next = controller.process(time.now());
+			}
+
+			time.advance_to(target);
+			controller.process(time.now());
+		};
+
+	for (const auto& r : m_records)
+	{
+		if (cancel && *cancel)
+			break;
+
+		auto event_time = to_time_point(r.m_time);
+
+		if (replay_speed == speed::real_time)
+			std::this_thread::sleep_until(wall_start + (event_time - trace_start));
+
+		run_until(event_time);
+
+		source_key key{ r.m_key_high, r.m_key_low };
+
+		switch (static_cast<trace_event>(r.m_type))
+		{
+			case trace_event::frontend_event:
+			{
+				auto event = static_cast<obs_frontend_event>(r.m_code);
+
+				if (event == OBS_FRONTEND_EVENT_SCENE_CHANGED)
+					dispatcher.on_scene_changed(key, {}, rules, false, nullptr);
+				else if (auto new_state = smartstart_recording::recording_state_for_event(event))
+					controller.on_recording_state_changed(*new_state);
+			}
+			break;
+
+			case trace_event::transition_start:
+			{
+				dispatcher.on_scene_changed(key, {}, rules, true, nullptr);
+			}
+			break;
+
+			case trace_event::decision:
+			{
+				recorded_decisions.push_back(r);
+			}
+			break;
+
+			default:
+			{
+
+			}
+			break;
+		}
+
+		++replay_result.m_events;
+	}
+
+	run_until(to_time_point(m_records.back().m_time));
+
+	replay_result.m_recorded_decisions = recorded_decisions.size();
+	replay_result.m_replayed_decisions = replay_result.m_decisions.size();
+
+	auto common = std::min(recorded_decisions.size(), replay_result.m_decisions.size());
+	replay_result.m_mismatches = std::max(recorded_decisions.size(), replay_result.m_decisions.size()) - common;
+
+	for (size_t i = 0; i < common; ++i)
+	{
+		const auto& recorded = recorded_decisions[i];
+		const auto& replayed = replay_result.m_decisions[i];
+
+		if (recorded.m_code != replayed.m_code || recorded.m_value != replayed.m_value)
+			++replay_result.m_mismatches;
+
+		replay_result.m_max_drift = std::max(replay_result.m_max_drift, std::abs(recorded.m_time - replayed.m_time));
+	}
+
+	return replay_result;
+}
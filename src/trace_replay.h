@@ -0,0 +1,67 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "rule_snapshot.h"
+#include "trace_recorder.h"
+
+//Feeds a recorded trace through a scene_dispatcher and a recording_controller in manual mode.
+//Time comes from a virtual clock, so a replay takes the same decisions every time, no matter how fast it runs.
+class trace_replay
+{
+	public:
+		enum class speed
+		{
+			fastest,
+			real_time
+		};
+
+		struct result
+		{
+			size_t m_events = 0;
+			size_t m_recorded_decisions = 0;
+			size_t m_replayed_decisions = 0;
+
+			//Decisions which differ in kind or target state, compared in order
+			size_t m_mismatches = 0;
+
+			//Largest distance in time between a recorded decision and its replayed counterpart, nanoseconds
+			int64_t m_max_drift = 0;
+
+			std::vector<trace_record> m_decisions;
+		};
+
+		explicit trace_replay(std::vector<trace_record> records);
+
+	public:
+		//cancel is polled between events, it allows aborting a real time replay
+		result run(const rule_snapshot& rules, speed replay_speed, const std::atomic_bool* cancel = nullptr) const;
+
+		inline size_t size() const { return m_records.size(); }
+
+	protected:
+
+	private:
+		std::vector<trace_record> m_records;
+};
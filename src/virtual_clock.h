@@ -0,0 +1,44 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <chrono>
+
+//Time source which only moves when told to. Lets the recording controller run on recorded time, e.g. in replays.
+//Not thread safe, the owner drives it from one thread.
+class virtual_clock
+{
+	public:
+		using clock = std::chrono::steady_clock;
+
+		explicit virtual_clock(clock::time_point start = clock::time_point{})
+			: m_now{ start }
+		{ }
+
+	public:
+		inline clock::time_point now() const { return m_now; }
+
+		//Time never runs backwards
+		inline void advance_to(clock::time_point time) { if (time > m_now) m_now = time; }
+
+	protected:
+
+	private:
+		clock::time_point m_now;
+};
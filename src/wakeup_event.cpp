@@ -0,0 +1,143 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "wakeup_event.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#endif
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "the kernel waits on the raw 32 bit word");
+
+wakeup_event::wakeup_event()
+	: m_signaled{ 0 }
+	, m_sleeping{ 0 }
+#if defined(__APPLE__)
+	, m_semaphore{ dispatch_semaphore_create(0) }
+#endif
+{ }
+
+wakeup_event::~wakeup_event()
+{
+#if defined(__APPLE__)
+	dispatch_release(m_semaphore);
+#endif
+}
+
+void wakeup_event::notify()
+{
+	//Only pay for the system call if the waiter is (about to be) asleep
+	if (m_signaled.exchange(1) == 0 && m_sleeping.load())
+		wake();
+}
+
+bool wakeup_event::wait_until(clock::time_point deadline)
+{
+	while (true)
+	{
+		if (m_signaled.exchange(0))
+			return true;
+
+		if (clock::now() >= deadline)
+			return false;
+
+		sleep(&deadline);
+	}
+}
+
+void wakeup_event::wait()
+{
+	while (!m_signaled.exchange(0))
+		sleep(nullptr);
+}
+
+void wakeup_event::sleep(const clock::time_point* deadline)
+{
+	m_sleeping.store(1);
+
+	//notify() sets the flag before it looks at m_sleeping, so checking here again closes the lost wakeup window
+	if (!m_signaled.load())
+	{
+#if defined(_WIN32)
+		DWORD timeout = INFINITE;
+		if (deadline)
+		{
+			auto remaining = std::chrono::ceil<std::chrono::milliseconds>(*deadline - clock::now()).count();
+			timeout = remaining < 0 ? 0 : static_cast<DWORD>(remaining);
+		}
+
+		uint32_t expected = 0;
+		WaitOnAddress(&m_signaled, &expected, sizeof(expected), timeout);
+#elif defined(__linux__)
+		//steady_clock is CLOCK_MONOTONIC, so the deadline can be handed to the kernel as an absolute timeout
+		timespec timeout{};
+		if (deadline)
+		{
+			auto since_epoch = deadline->time_since_epoch();
+			auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+
+			timeout.tv_sec = static_cast<time_t>(seconds.count());
+			timeout.tv_nsec = static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch - seconds).count());
+		}
+
+		syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_signaled), FUTEX_WAIT_BITSET_PRIVATE, 0, deadline ? &timeout : nullptr, nullptr, FUTEX_BITSET_MATCH_ANY);
+#elif defined(__APPLE__)
+		dispatch_time_t timeout = DISPATCH_TIME_FOREVER;
+		if (deadline)
+		{
+			auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(*deadline - clock::now()).count();
+			timeout = dispatch_time(DISPATCH_TIME_NOW, remaining < 0 ? 0 : remaining);
+		}
+
+		dispatch_semaphore_wait(m_semaphore, timeout);
+#else
+		std::unique_lock lock{ m_mutex };
+		auto predicate = [this]() -> bool {return m_signaled.load() != 0; };
+
+		if (deadline)
+			m_condition.wait_until(lock, *deadline, predicate);
+		else
+			m_condition.wait(lock, predicate);
+#endif
+	}
+
+	m_sleeping.store(0);
+}
+
+void wakeup_event::wake()
+{
+#if defined(_WIN32)
+	WakeByAddressSingle(&m_signaled);
+#elif defined(__linux__)
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_signaled), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#elif defined(__APPLE__)
+	//Surplus signals only cause a spurious wakeup, the waiter re-checks the flag
+	dispatch_semaphore_signal(m_semaphore);
+#else
+	{
+		std::unique_lock lock{ m_mutex };
+	}
+	m_condition.notify_one();
+#endif
+}
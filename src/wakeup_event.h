@@ -0,0 +1,69 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#elif !defined(_WIN32) && !defined(__linux__)
+#include <condition_variable>
+#include <mutex>
+#endif
+
+//Auto-reset wakeup for a single waiting thread.
+//notify() is a plain atomic exchange and only enters the kernel while the waiter actually sleeps.
+//Backed by futex on Linux, WaitOnAddress on Windows and a dispatch semaphore on macOS.
+class wakeup_event
+{
+	public:
+		using clock = std::chrono::steady_clock;
+
+		wakeup_event();
+		~wakeup_event();
+
+		//No copying
+		wakeup_event(const wakeup_event& other) = delete;
+		wakeup_event& operator = (const wakeup_event& other) = delete;
+
+	public:
+		void notify();
+
+		//Returns true if woken by notify(), false on timeout
+		bool wait_until(clock::time_point deadline);
+		void wait();
+
+	protected:
+
+	private:
+		void sleep(const clock::time_point* deadline);
+		void wake();
+
+		std::atomic<uint32_t> m_signaled;
+		std::atomic<uint32_t> m_sleeping;
+
+#if defined(__APPLE__)
+		dispatch_semaphore_t m_semaphore;
+#elif !defined(_WIN32) && !defined(__linux__)
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+#endif
+};
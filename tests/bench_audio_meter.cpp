@@ -0,0 +1,97 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "audio_meter.h"
+
+//Every audio_meter kernel the CPU supports against measure_scalar, on blocks of synthetic PCM as OBS hands them to the capture callback.
+//The blocks start one float past an aligned address, OBS gives no alignment guarantee for its planes.
+
+using bench_clock = std::chrono::steady_clock;
+
+static constexpr uint32_t BLOCK_SIZES[] = { 480, 1024, 4096 };
+static constexpr size_t BLOCK_COUNT = 64;
+
+//Keeps the compiler from dropping the measurements
+static volatile float s_sink = 0.0f;
+
+//Mean nanoseconds per block, the blocks are walked round robin so they do not all sit in L1
+static double time_kernel(const audio_meter::kernel& kernel, const std::vector<float>& samples, uint32_t frames, std::chrono::milliseconds budget)
+{
+	uint64_t calls = 0;
+	float sink = 0.0f;
+
+	auto begin = bench_clock::now();
+	do
+	{
+		for (size_t i = 0; i < BLOCK_COUNT; ++i)
+		{
+			auto level = kernel.m_function(samples.data() + 1 + i * frames, frames);
+			sink += level.m_sum_squares + level.m_peak;
+		}
+
+		calls += BLOCK_COUNT;
+	} while (bench_clock::now() - begin < budget);
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - begin).count();
+	s_sink = sink;
+
+	return static_cast<double>(elapsed) / static_cast<double>(calls);
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--quick") == 0)
+			quick = true;
+	}
+
+	auto budget = std::chrono::milliseconds{ quick ? 10 : 300 };
+	auto kernels = audio_meter::get_kernels();
+
+	std::mt19937 random{ 2025 };
+	std::uniform_real_distribution<float> sample{ -0.5f, 0.5f };
+
+	std::printf("measure() uses %s\n", audio_meter::kernel_name());
+
+	for (auto frames : BLOCK_SIZES)
+	{
+		std::vector<float> samples(1 + BLOCK_COUNT * frames);
+		for (auto& v : samples)
+			v = sample(random);
+
+		//measure_scalar is always the last kernel
+		auto scalar = time_kernel(kernels.back(), samples, frames, budget);
+
+		for (const auto& kernel : kernels)
+		{
+			auto mean = &kernel == &kernels.back() ? scalar : time_kernel(kernel, samples, frames, budget);
+			std::printf("%-8s frames=%-6u %9.1f ns per block, %6.2f samples per ns, %5.2fx scalar\n", kernel.m_name, frames, mean, static_cast<double>(frames) / mean, scalar / mean);
+		}
+	}
+
+	return 0;
+}
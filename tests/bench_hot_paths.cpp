@@ -0,0 +1,307 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fake_obs.h"
+#include "latency_histogram.h"
+#include "plugin_config.h"
+#include "rule_snapshot.h"
+#include "smartstart_recording.h"
+
+//Hot paths of the plugin measured against the fake OBS, no OBS installation needed.
+//Every measurement prints one line, "--quick" cuts the repetitions so the benchmark can run as a test.
+//The scene change and save/load paths run through smartstart_recording itself, attached to the fake OBS.
+
+using bench_clock = std::chrono::steady_clock;
+
+static constexpr size_t RULE_COUNTS[] = { 10, 1000, 100000 };
+static constexpr size_t SCENE_COUNT = 256;
+
+static bool s_quick = false;
+static bool s_failed = false;
+
+static inline uint64_t elapsed_ns(bench_clock::time_point begin)
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - begin).count());
+}
+
+//Scene changes never come back to back, a pause now and then lets the controller's worker drain its queue like it would in OBS
+static inline void pace(int call)
+{
+	if (call % 256 == 255)
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+}
+
+static void print_summary(const char* name, size_t rules, const latency_histogram::summary& summary)
+{
+	std::printf("%-36s rules=%-7zu n=%-8" PRIu64 " mean=%-7" PRIu64 " p50=%-7" PRIu64 " p99=%-7" PRIu64 " p99.9=%-7" PRIu64 " max=%" PRIu64 " ns\n",
+		name, rules, summary.m_count, summary.m_mean, summary.m_p50, summary.m_p99, summary.m_p999, summary.m_max);
+}
+
+//Repeats work until it ran for at least the given time, returns the mean in nanoseconds
+static double measure_mean(std::chrono::milliseconds budget, size_t min_runs, const std::function<void()>& work)
+{
+	size_t runs = 0;
+	auto begin = bench_clock::now();
+
+	do
+	{
+		work();
+		++runs;
+	} while (runs < min_runs || bench_clock::now() - begin < budget);
+
+	return static_cast<double>(elapsed_ns(begin)) / static_cast<double>(runs);
+}
+
+//Scene rules for the given scenes first, the rest point at scenes which do not exist (yet).
+//One rule in a hundred is a wildcard pattern, so resolve() also has patterns to consider.
+static std::vector<recording_setting> make_rules(size_t count, const std::vector<obs_source_t*>& scenes)
+{
+	std::vector<recording_setting> settings;
+	settings.reserve(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto action = i % 2 ? recording_setting::action::stop : recording_setting::action::start;
+		auto trigger_time = static_cast<uint32_t>(1000 + (i % 7) * 500);
+
+		if (i < scenes.size())
+			settings.emplace_back(source_key::from_source(scenes[i]), obs_source_get_name(scenes[i]), action, trigger_time);
+		else if (i % 100 == 99)
+			settings.emplace_back(source_key::generate(), "Pattern " + std::to_string(i) + " *", action, trigger_time, 0, recording_setting::match::wildcard, static_cast<int32_t>(i));
+		else
+			settings.emplace_back(source_key::generate(), "Scene " + std::to_string(i), action, trigger_time);
+	}
+
+	return settings;
+}
+
+static void bench_build_recording_table(size_t count)
+{
+	auto settings = make_rules(count, {});
+
+	auto mean = measure_mean(std::chrono::milliseconds{ s_quick ? 20 : 500 }, s_quick ? 1 : 3, [&settings]() -> void
+		{
+			rule_snapshot snapshot{ settings, 1 };
+			(void)snapshot;
+		});
+
+	std::printf("%-36s rules=%-7zu %.3f ms per build, %.1f ns per rule\n", "build_recording_table", count, mean / 1e6, mean / static_cast<double>(count));
+}
+
+static void bench_get_recording_setting(size_t count)
+{
+	auto settings = make_rules(count, {});
+	rule_snapshot snapshot{ settings, 1 };
+
+	//Half the lookups hit a scene rule, a quarter only match a pattern by name, the rest find nothing
+	std::vector<std::pair<source_key, std::string>> lookups;
+	std::mt19937_64 random{ 42 };
+
+	for (size_t i = 0; i < 4096; ++i)
+	{
+		const auto& rule = settings[random() % settings.size()];
+		switch (i % 4)
+		{
+			case 0:
+			case 1: { lookups.emplace_back(rule.get_scene_key(), rule.get_scene_name()); } break;
+			case 2: { lookups.emplace_back(source_key::generate(), "Pattern " + std::to_string(random() % count) + " x"); } break;
+			default: { lookups.emplace_back(source_key::generate(), "Unknown " + std::to_string(i)); } break;
+		}
+	}
+
+	size_t found = 0;
+	auto iterations = s_quick ? 16 : 512;
+	auto begin = bench_clock::now();
+
+	for (int n = 0; n < iterations; ++n)
+	{
+		for (const auto& v : lookups)
+			found += snapshot.resolve(v.first, v.second) != nullptr;
+	}
+
+	auto total = elapsed_ns(begin);
+	auto calls = static_cast<double>(iterations) * static_cast<double>(lookups.size());
+
+	std::printf("%-36s rules=%-7zu %.1f ns per lookup, %.1f M lookups/s (%zu found)\n", "get_recording_setting", count, static_cast<double>(total) / calls, calls * 1e3 / static_cast<double>(total), found);
+}
+
+//The plugin attached to the fake OBS like OBS attaches it, the frontend finished loading and the transitions are connected
+static smartstart_recording& attach_plugin(const std::vector<recording_setting>& settings)
+{
+	auto& plugin = smartstart_recording::get();
+	plugin.update_recording_settings(std::list<recording_setting>{ settings.begin(), settings.end() });
+	plugin.attach();
+
+	fake_obs::run_on_ui([]() -> void
+		{
+			fake_obs::dispatch_frontend_event(OBS_FRONTEND_EVENT_FINISHED_LOADING);
+			fake_obs::dispatch_frontend_event(OBS_FRONTEND_EVENT_TRANSITION_LIST_CHANGED);
+		});
+
+	return plugin;
+}
+
+static void detach_plugin(smartstart_recording& plugin)
+{
+	plugin.unload();
+
+	fake_obs::flush_ui();
+	fake_obs::reset();
+}
+
+static void bench_on_scene_changed(size_t count)
+{
+	fake_obs::reset();
+
+	std::vector<obs_source_t*> scenes;
+	for (size_t i = 0; i < SCENE_COUNT; ++i)
+		scenes.push_back(fake_obs::create_scene("Scene " + std::to_string(i)));
+
+	auto transition = fake_obs::create_transition("Fade");
+
+	auto& plugin = attach_plugin(make_rules(count, scenes));
+	auto calls = s_quick ? 2000 : 200000;
+
+	//The controller outlives the runs before, only what this run queued counts
+	auto queue_before = plugin.get_recording_controller().get_queue_statistics();
+
+	//The transition path: the signal goes through the connection registry into the transition_start handler, like OBS emits it
+	latency_histogram transition_latency;
+	for (int i = 0; i < calls; ++i)
+	{
+		fake_obs::set_transition_target(transition, scenes[i % scenes.size()]);
+
+		auto begin = bench_clock::now();
+		fake_obs::emit(transition, "transition_start");
+		transition_latency.record(elapsed_ns(begin));
+		pace(i);
+	}
+
+	print_summary("on_scene_changed (transition)", count, transition_latency.get_summary());
+
+	//The frontend path also moves the program scene in the scene graph, it runs on the UI thread like in OBS.
+	//Changing the scene queues another scene change event, those run once the measurement is done.
+	latency_histogram frontend_latency;
+	fake_obs::run_on_ui([&]() -> void
+		{
+			for (int i = 0; i < calls; ++i)
+			{
+				fake_obs::set_current_scene(scenes[i % scenes.size()]);
+
+				auto begin = bench_clock::now();
+				fake_obs::dispatch_frontend_event(OBS_FRONTEND_EVENT_SCENE_CHANGED);
+				frontend_latency.record(elapsed_ns(begin));
+				pace(i);
+			}
+		});
+
+	print_summary("on_scene_changed (frontend event)", count, frontend_latency.get_summary());
+
+	auto queue = plugin.get_recording_controller().get_queue_statistics();
+	std::printf("%-36s rules=%-7zu %" PRIu64 " commands, %" PRIu64 " dropped\n", "controller queue", count, queue.m_count - queue_before.m_count, queue.m_dropped - queue_before.m_dropped);
+
+	detach_plugin(plugin);
+}
+
+//Saving and loading the scene collection through the plugin's save callback, with the table inline in the collection or in the binary rule store
+static void bench_save_load(size_t count, bool binary_rule_store)
+{
+	fake_obs::reset();
+
+	//Every run starts without side files, a journal left behind would be replayed into the rules
+	auto collection = "smartstart_bench_" + std::to_string(count);
+	fake_obs::set_scene_collection(collection);
+
+	std::error_code ec;
+	for (auto extension : { ".rules", ".journal" })
+		std::filesystem::remove(plugin_config::collection_file_path(collection.c_str(), extension), ec);
+
+	auto& plugin = smartstart_recording::get();
+	plugin.get_config().set_binary_rule_store(binary_rule_store);
+	attach_plugin(make_rules(count, {}));
+
+	auto runs = s_quick ? 1 : (count >= 100000 ? 5 : 50);
+	size_t json_size = 0;
+	size_t loaded = 0;
+
+	auto mean = measure_mean(std::chrono::milliseconds{ 0 }, runs, [&]() -> void
+		{
+			auto save_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_data_create(), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
+			fake_obs::save_collection(save_ptr.get());
+
+			std::string json = obs_data_get_json(save_ptr.get());
+			json_size = json.size();
+
+			auto load_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_data_create_from_json(json.c_str()), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
+			fake_obs::load_collection(load_ptr.get());
+
+			loaded = plugin.get_recording_setting_list().size();
+		});
+
+	std::printf("%-36s rules=%-7zu %.3f ms per round trip, %zu bytes JSON, %zu loaded\n", binary_rule_store ? "save_load (binary rule store)" : "save_load (scene collection JSON)", count, mean / 1e6, json_size, loaded);
+
+	if (loaded != count)
+	{
+		std::printf("FAILED: %zu of %zu rules survived the round trip\n", loaded, count);
+		s_failed = true;
+	}
+
+	detach_plugin(plugin);
+	plugin.get_config().set_binary_rule_store(false);
+
+	for (auto extension : { ".rules", ".journal" })
+		std::filesystem::remove(plugin_config::collection_file_path(collection.c_str(), extension), ec);
+}
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--quick") == 0)
+			s_quick = true;
+	}
+
+	fake_obs::set_log_level(LOG_ERROR);
+
+	for (auto count : RULE_COUNTS)
+	{
+		bench_build_recording_table(count);
+		bench_get_recording_setting(count);
+		bench_on_scene_changed(count);
+		bench_save_load(count, false);
+		bench_save_load(count, true);
+	}
+
+	return s_failed ? 1 : 0;
+}
@@ -0,0 +1,237 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fake_obs.h"
+#include "rule_snapshot.h"
+#include "smartstart_recording.h"
+#include "source_key.h"
+
+//Rule lookup and the transition path at 10k scenes, with every heap allocation of the calling thread counted.
+//The lookup and the transition path must not allocate once warmed up, the benchmark fails (exit code 1) if they do.
+//Allocations of the controller's worker and of the fake OBS UI thread are not counted, they happen off the transition path.
+
+static constexpr size_t SCENE_COUNT = 10000;
+
+static thread_local bool t_counting = false;
+static thread_local uint64_t t_allocations = 0;
+
+void* operator new(size_t size)
+{
+	if (t_counting)
+		++t_allocations;
+
+	if (auto ptr = std::malloc(size ? size : 1))
+		return ptr;
+
+	throw std::bad_alloc{};
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t size) noexcept
+{
+	(void)size;	//unused parameter
+
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t size) noexcept
+{
+	(void)size;	//unused parameter
+
+	std::free(ptr);
+}
+
+class allocation_counter
+{
+	public:
+		allocation_counter()
+			: m_begin{ t_allocations }
+		{
+			t_counting = true;
+		}
+
+		~allocation_counter()
+		{
+			t_counting = false;
+		}
+
+		inline uint64_t get() const { return t_allocations - m_begin; }
+
+	private:
+		uint64_t m_begin;
+};
+
+using bench_clock = std::chrono::steady_clock;
+
+static bool s_quick = false;
+static bool s_failed = false;
+
+static void report(const char* name, uint64_t calls, uint64_t nanoseconds, uint64_t allocations)
+{
+	std::printf("%-36s scenes=%-6zu %.1f ns per call, %" PRIu64 " allocations in %" PRIu64 " calls\n", name, SCENE_COUNT, static_cast<double>(nanoseconds) / static_cast<double>(calls), allocations, calls);
+
+	if (allocations)
+	{
+		std::printf("FAILED: %s allocated on the hot path\n", name);
+		s_failed = true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--quick") == 0)
+			s_quick = true;
+	}
+
+	fake_obs::set_log_level(LOG_ERROR);
+
+	std::vector<obs_source_t*> scenes;
+	std::vector<recording_setting> settings;
+
+	for (size_t i = 0; i < SCENE_COUNT; ++i)
+	{
+		auto scene = fake_obs::create_scene("Scene " + std::to_string(i));
+		scenes.push_back(scene);
+		settings.emplace_back(source_key::from_source(scene), obs_source_get_name(scene), i % 2 ? recording_setting::action::stop : recording_setting::action::start, static_cast<uint32_t>(1000 + i % 5000));
+	}
+
+	auto transition = fake_obs::create_transition("Fade");
+
+	//Random order, so consecutive lookups do not walk the table in order
+	std::vector<size_t> order(SCENE_COUNT * 4);
+	std::mt19937_64 random{ 7 };
+	for (auto& v : order)
+		v = random() % SCENE_COUNT;
+
+	auto rounds = s_quick ? 2 : 50;
+
+	{
+		rule_snapshot snapshot{ settings, 1 };
+
+		std::vector<source_key> keys;
+		for (auto v : scenes)
+			keys.push_back(source_key::from_source(v));
+
+		size_t found = 0;
+		for (auto v : order)
+			found += snapshot.find(keys[v]) != nullptr;
+
+		allocation_counter counter;
+		auto begin = bench_clock::now();
+
+		for (int n = 0; n < rounds; ++n)
+		{
+			for (auto v : order)
+				found += snapshot.find(keys[v]) != nullptr;
+		}
+
+		auto elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - begin).count());
+		report("rule_snapshot::find", static_cast<uint64_t>(rounds) * order.size(), elapsed, counter.get());
+
+		if (found != static_cast<size_t>(rounds + 1) * order.size())
+		{
+			std::printf("FAILED: %zu of %zu lookups found their rule\n", found, static_cast<size_t>(rounds + 1) * order.size());
+			s_failed = true;
+		}
+	}
+
+	{
+		//The plugin itself, attached like OBS attaches it, the transition is connected once the frontend finished loading
+		auto& plugin = smartstart_recording::get();
+		plugin.update_recording_settings(std::list<recording_setting>{ settings.begin(), settings.end() });
+		plugin.attach();
+
+		fake_obs::run_on_ui([]() -> void
+			{
+				fake_obs::dispatch_frontend_event(OBS_FRONTEND_EVENT_FINISHED_LOADING);
+				fake_obs::dispatch_frontend_event(OBS_FRONTEND_EVENT_TRANSITION_LIST_CHANGED);
+			});
+
+		//From the signal through the transition_start handler, like OBS emits it
+		auto transition_path = [&scenes, transition](size_t index) -> void
+			{
+				fake_obs::set_transition_target(transition, scenes[index]);
+				fake_obs::emit(transition, "transition_start");
+			};
+
+		//Thread locals and the first wakeups of the worker may allocate once
+		for (size_t i = 0; i < 1024; ++i)
+			transition_path(order[i]);
+
+		uint64_t allocations = 0;
+		uint64_t elapsed = 0;
+		uint64_t calls = 0;
+
+		for (int n = 0; n < rounds; ++n)
+		{
+			//Scene changes never come back to back, let the worker catch up in between
+			for (size_t i = 0; i < order.size(); i += 256)
+			{
+				allocation_counter counter;
+				auto begin = bench_clock::now();
+
+				for (size_t j = i; j < i + 256 && j < order.size(); ++j, ++calls)
+					transition_path(order[j]);
+
+				elapsed += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - begin).count());
+				allocations += counter.get();
+
+				std::this_thread::sleep_for(std::chrono::microseconds{ 200 });
+			}
+		}
+
+		report("on_scene_changed (transition)", calls, elapsed, allocations);
+
+		plugin.unload();
+	}
+
+	fake_obs::flush_ui();
+	fake_obs::reset();
+
+	return s_failed ? 1 : 0;
+}
@@ -0,0 +1,169 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "binary_rule_store.h"
+#include "rule_cache.h"
+#include "rule_snapshot.h"
+#include "rule_table_json.h"
+
+//Loading the rules of a scene collection: from the collection JSON, from the binary rule store and from the rule cache.
+//Every step is timed on its own, so it shows where startup and a collection switch spend their time.
+//"fields only" walks every record without creating a single string, the floor for a loader which materializes names lazily.
+
+using bench_clock = std::chrono::steady_clock;
+
+static bool s_quick = false;
+
+static double measure_ms(size_t runs, const std::function<void()>& work)
+{
+	auto begin = bench_clock::now();
+
+	for (size_t i = 0; i < runs; ++i)
+		work();
+
+	return std::chrono::duration<double, std::milli>(bench_clock::now() - begin).count() / static_cast<double>(runs);
+}
+
+static std::vector<recording_setting> make_rules(size_t count, bool long_names)
+{
+	std::vector<recording_setting> settings;
+	settings.reserve(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto name = long_names ? "Gameplay - Ranked Match Overlay " + std::to_string(i) + " (Main Camera)" : "Scene " + std::to_string(i);
+		settings.emplace_back(source_key::generate(), name, i % 2 ? recording_setting::action::stop : recording_setting::action::start, static_cast<uint32_t>(i % 10000));
+	}
+
+	return settings;
+}
+
+static void bench_load(size_t count, bool long_names)
+{
+	auto settings = make_rules(count, long_names);
+	auto runs = s_quick ? 1 : (count >= 100000 ? 5 : (count >= 10000 ? 20 : 200));
+	const char* names = long_names ? "long" : "short";
+
+	//The collection JSON as OBS would hand it to the plugin
+	std::string json;
+	{
+		auto save_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_data_create(), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
+		rule_table_json::write(save_ptr.get(), settings);
+		json = obs_data_get_json(save_ptr.get());
+	}
+
+	auto path = std::filesystem::temp_directory_path() / ("smartstart_bench_store_" + std::to_string(count) + ".rules");
+	binary_rule_store::write(path, settings, 1);
+
+	size_t check = 0;
+
+	auto json_parse = measure_ms(runs, [&]() -> void
+		{
+			auto obj_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_data_create_from_json(json.c_str()), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
+			check += obj_ptr != nullptr;
+		});
+
+	//Both loaders hand their vector to the snapshot, like the plugin does
+	auto obj_ptr = std::unique_ptr<obs_data_t, std::function<void(obs_data_t*)>>(obs_data_create_from_json(json.c_str()), [](obs_data_t* ptr) -> void {obs_data_release(ptr); });
+	auto json_build = measure_ms(runs, [&]() -> void
+		{
+			rule_snapshot snapshot{ rule_table_json::read(obj_ptr.get()), 1 };
+			check += snapshot.get_settings().size();
+		});
+
+	auto store_open = measure_ms(runs, [&]() -> void
+		{
+			binary_rule_store store;
+			check += store.open(path);
+		});
+
+	binary_rule_store store;
+	store.open(path);
+
+	auto store_build = measure_ms(runs, [&]() -> void
+		{
+			rule_snapshot snapshot{ store.materialize_all(), 1 };
+			check += snapshot.get_settings().size();
+		});
+
+	auto store_materialize = measure_ms(runs, [&]() -> void
+		{
+			check += store.materialize_all().size();
+		});
+
+	auto store_fields = measure_ms(runs, [&]() -> void
+		{
+			for (size_t i = 0; i < store.size(); ++i)
+			{
+				check += static_cast<size_t>(store.get_key(i).get_low() & 1) + store.get_name(i).size() + store.get_trigger_time(i) + static_cast<size_t>(store.get_priority(i));
+				check += static_cast<size_t>(store.get_action(i)) + static_cast<size_t>(store.get_match(i)) + store.get_pre_roll(i) + store.get_window(i);
+			}
+		});
+
+	//Switching back to a collection which is still cached
+	rule_cache cache{ static_cast<size_t>(1) << 40 };
+	rule_cache::entry entry;
+	entry.m_snapshot = std::make_unique<const rule_snapshot>(std::vector<recording_setting>{ settings }, 1);
+	cache.insert("collection", std::move(entry));
+
+	auto cache_hit = measure_ms(runs, [&]() -> void
+		{
+			auto cached = cache.take("collection", [](const rule_cache::entry& v) -> bool {return v.m_revision == 0; });
+			check += cached.has_value();
+			cache.insert("collection", std::move(*cached));
+		});
+
+	std::printf("rules=%-7zu names=%-5s json: parse %8.3f + read and build %8.3f = %8.3f ms | store: open %7.3f + materialize and build %7.3f = %7.3f ms (materialize %.3f, fields only %.3f) | cache hit %.4f ms\n",
+		count, names, json_parse, json_build, json_parse + json_build, store_open, store_build, store_open + store_build, store_materialize, store_fields, cache_hit);
+
+	if (!check)
+		std::printf("unexpected: nothing loaded\n");
+
+	store.close();
+
+	std::error_code ec;
+	std::filesystem::remove(path, ec);
+}
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--quick") == 0)
+			s_quick = true;
+	}
+
+	for (auto count : { 10, 1000, 10000, 100000 })
+	{
+		bench_load(static_cast<size_t>(count), false);
+		bench_load(static_cast<size_t>(count), true);
+	}
+
+	return 0;
+}
@@ -0,0 +1,124 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "recording_setting.h"
+#include "scene_sequence_set.h"
+
+//scene_sequence_matcher::advance with thousands of partial matches alive at once.
+//Every rule reads "Intro k > Middle k > Live", the Intro scenes leave one partial per rule waiting for its Middle scene.
+
+using bench_clock = std::chrono::steady_clock;
+
+static bool s_failed = false;
+
+static void report(const char* name, size_t partials, uint64_t calls, uint64_t nanoseconds)
+{
+	auto per_call = static_cast<double>(nanoseconds) / static_cast<double>(calls);
+	std::printf("%-28s partials=%-6zu %10.1f ns per advance, %.2f ns per partial\n", name, partials, per_call, per_call / static_cast<double>(partials));
+}
+
+static uint64_t elapsed_since(bench_clock::time_point begin)
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - begin).count());
+}
+
+static void run(size_t rule_count)
+{
+	std::vector<recording_setting> settings;
+	std::vector<std::string> intros;
+	std::vector<std::string> middles;
+
+	for (size_t k = 0; k < rule_count; ++k)
+	{
+		intros.push_back("Intro " + std::to_string(k));
+		middles.push_back("Middle " + std::to_string(k));
+		settings.emplace_back(source_key::generate(), intros.back() + " > " + middles.back() + " > Live", recording_setting::action::start, 0, 0, recording_setting::match::sequence, 0, 0);
+	}
+
+	scene_sequence_set set;
+	set.build(settings);
+
+	scene_sequence_matcher matcher;
+	auto time = bench_clock::now();
+
+	//Each Intro scene starts one partial, the advance walks all partials started before it
+	auto begin = bench_clock::now();
+	for (const auto& v : intros)
+		matcher.advance(set, 1, v, time);
+
+	report("start partials", rule_count, rule_count, elapsed_since(begin));
+
+	//A scene outside every rule only walks the partials
+	auto rounds = 16;
+	begin = bench_clock::now();
+	for (int n = 0; n < rounds; ++n)
+		matcher.advance(set, 1, "Break", time);
+
+	report("scene outside the rules", rule_count, static_cast<uint64_t>(rounds), elapsed_since(begin));
+
+	//Every Middle scene moves exactly one partial on
+	begin = bench_clock::now();
+	for (const auto& v : middles)
+		matcher.advance(set, 1, v, time);
+
+	report("advance one partial", rule_count, rule_count, elapsed_since(begin));
+
+	if (matcher.get_active() != rule_count)
+	{
+		std::printf("FAILED: %zu partials active instead of %zu\n", matcher.get_active(), rule_count);
+		s_failed = true;
+	}
+
+	//Live completes every rule at once, the first listed wins
+	begin = bench_clock::now();
+	auto result = matcher.advance(set, 1, "Live", time);
+	report("complete all partials", rule_count, 1, elapsed_since(begin));
+
+	if (result.m_rule != &settings[0] || matcher.get_active() != 0)
+	{
+		std::printf("FAILED: Live did not complete the first rule and every partial\n");
+		s_failed = true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool quick = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--quick") == 0)
+			quick = true;
+	}
+
+	if (quick)
+		run(1000);
+	else
+	{
+		for (auto v : { 1000, 4000, 16000 })
+			run(static_cast<size_t>(v));
+	}
+
+	return s_failed ? 1 : 0;
+}
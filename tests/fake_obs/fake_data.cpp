@@ -0,0 +1,657 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+//Settings objects keep their items in insertion order and write the same JSON layout libobs does,
+//so a save/load round trip costs roughly what it costs in OBS
+struct obs_data_item
+{
+	enum class type
+	{
+		null,
+		boolean,
+		integer,
+		number,
+		string,
+		object,
+		array
+	};
+
+	type m_type = type::null;
+	bool m_bool = false;
+	long long m_int = 0;
+	double m_double = 0.0;
+	std::string m_string;
+	obs_data_t* m_object = nullptr;
+	obs_data_array_t* m_array = nullptr;
+};
+
+struct obs_data
+{
+	std::atomic<long> m_refs{ 1 };
+	std::vector<std::pair<std::string, obs_data_item>> m_items;
+	std::string m_json;
+};
+
+struct obs_data_array
+{
+	std::atomic<long> m_refs{ 1 };
+	std::vector<obs_data_t*> m_items;
+};
+
+static void release_item(obs_data_item& item)
+{
+	obs_data_release(item.m_object);
+	obs_data_array_release(item.m_array);
+	item.m_object = nullptr;
+	item.m_array = nullptr;
+}
+
+static obs_data_item* find_item(obs_data_t* data, const char* name)
+{
+	if (!data || !name)
+		return nullptr;
+
+	for (auto& v : data->m_items)
+	{
+		if (v.first == name)
+			return &v.second;
+	}
+
+	return nullptr;
+}
+
+static obs_data_item& set_item(obs_data_t* data, const char* name, obs_data_item::type type)
+{
+	auto item = find_item(data, name);
+	if (!item)
+		item = &data->m_items.emplace_back(name, obs_data_item{}).second;
+	else
+		release_item(*item);
+
+	item->m_type = type;
+
+	return *item;
+}
+
+static void write_string(std::string& out, const std::string& value)
+{
+	out += '"';
+
+	for (auto c : value)
+	{
+		switch (c)
+		{
+			case '"': { out += "\\\""; } break;
+			case '\\': { out += "\\\\"; } break;
+			case '\n': { out += "\\n"; } break;
+			case '\r': { out += "\\r"; } break;
+			case '\t': { out += "\\t"; } break;
+			default:
+			{
+				if (static_cast<unsigned char>(c) < 0x20)
+				{
+					char buffer[8];
+					std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+					out += buffer;
+				}
+				else
+					out += c;
+			} break;
+		}
+	}
+
+	out += '"';
+}
+
+static void write_object(std::string& out, const obs_data_t* data, size_t indent);
+
+static void write_array(std::string& out, const obs_data_array_t* array, size_t indent)
+{
+	out += '[';
+
+	for (size_t i = 0; i < array->m_items.size(); ++i)
+	{
+		out += i ? ",\n" : "\n";
+		out.append(indent + 4, ' ');
+		write_object(out, array->m_items[i], indent + 4);
+	}
+
+	if (!array->m_items.empty())
+	{
+		out += '\n';
+		out.append(indent, ' ');
+	}
+
+	out += ']';
+}
+
+static void write_object(std::string& out, const obs_data_t* data, size_t indent)
+{
+	out += '{';
+
+	bool first = true;
+	for (const auto& v : data->m_items)
+	{
+		out += first ? "\n" : ",\n";
+		first = false;
+
+		out.append(indent + 4, ' ');
+		write_string(out, v.first);
+		out += ": ";
+
+		const auto& item = v.second;
+		switch (item.m_type)
+		{
+			case obs_data_item::type::null: { out += "null"; } break;
+			case obs_data_item::type::boolean: { out += item.m_bool ? "true" : "false"; } break;
+			case obs_data_item::type::integer: { out += std::to_string(item.m_int); } break;
+			case obs_data_item::type::number:
+			{
+				char buffer[32];
+				std::snprintf(buffer, sizeof(buffer), "%.17g", item.m_double);
+				out += buffer;
+			} break;
+			case obs_data_item::type::string: { write_string(out, item.m_string); } break;
+			case obs_data_item::type::object: { write_object(out, item.m_object, indent + 4); } break;
+			case obs_data_item::type::array: { write_array(out, item.m_array, indent + 4); } break;
+			default: { } break;
+		}
+	}
+
+	if (!first)
+	{
+		out += '\n';
+		out.append(indent, ' ');
+	}
+
+	out += '}';
+}
+
+//Recursive descent parser for the JSON written above, returns false on anything it does not understand
+class json_parser
+{
+	public:
+		explicit json_parser(const char* text) : m_position{ text } { }
+
+		obs_data_t* parse()
+		{
+			auto data = obs_data_create();
+			if (!parse_object(data) || (skip_space(), *m_position))
+			{
+				obs_data_release(data);
+				return nullptr;
+			}
+
+			return data;
+		}
+
+	private:
+		void skip_space()
+		{
+			while (*m_position == ' ' || *m_position == '\n' || *m_position == '\r' || *m_position == '\t')
+				++m_position;
+		}
+
+		bool expect(char c)
+		{
+			skip_space();
+			if (*m_position != c)
+				return false;
+
+			++m_position;
+
+			return true;
+		}
+
+		bool parse_string(std::string& out)
+		{
+			if (!expect('"'))
+				return false;
+
+			out.clear();
+			while (*m_position && *m_position != '"')
+			{
+				char c = *m_position++;
+				if (c != '\\')
+				{
+					out += c;
+					continue;
+				}
+
+				switch (*m_position++)
+				{
+					case '"': { out += '"'; } break;
+					case '\\': { out += '\\'; } break;
+					case '/': { out += '/'; } break;
+					case 'n': { out += '\n'; } break;
+					case 'r': { out += '\r'; } break;
+					case 't': { out += '\t'; } break;
+					case 'b': { out += '\b'; } break;
+					case 'f': { out += '\f'; } break;
+					case 'u':
+					{
+						//Only what write_string produces, control characters below 0x80
+						char* end = nullptr;
+						char digits[5] = { };
+						std::strncpy(digits, m_position, 4);
+
+						auto value = std::strtoul(digits, &end, 16);
+						if (end != digits + 4 || value >= 0x80)
+							return false;
+
+						out += static_cast<char>(value);
+						m_position += 4;
+					} break;
+					default: { return false; } break;
+				}
+			}
+
+			return *m_position++ == '"';
+		}
+
+		bool parse_value(obs_data_t* data, const char* name)
+		{
+			skip_space();
+
+			switch (*m_position)
+			{
+				case '"':
+				{
+					std::string value;
+					if (!parse_string(value))
+						return false;
+
+					obs_data_set_string(data, name, value.c_str());
+				} break;
+				case '{':
+				{
+					auto object = obs_data_create();
+					bool result = parse_object(object);
+					if (result)
+						obs_data_set_obj(data, name, object);
+
+					obs_data_release(object);
+
+					if (!result)
+						return false;
+				} break;
+				case '[':
+				{
+					auto array = obs_data_array_create();
+					bool result = parse_array(array);
+					if (result)
+						obs_data_set_array(data, name, array);
+
+					obs_data_array_release(array);
+
+					if (!result)
+						return false;
+				} break;
+				case 't':
+				case 'f':
+				case 'n':
+				{
+					for (auto literal : { "true", "false", "null" })
+					{
+						auto length = std::strlen(literal);
+						if (std::strncmp(m_position, literal, length) == 0)
+						{
+							m_position += length;
+							if (*literal == 'n')
+								set_item(data, name, obs_data_item::type::null);
+							else
+								obs_data_set_bool(data, name, *literal == 't');
+
+							return true;
+						}
+					}
+
+					return false;
+				} break;
+				default:
+				{
+					char* end = nullptr;
+					auto integer = std::strtoll(m_position, &end, 10);
+					if (end == m_position)
+						return false;
+
+					if (*end == '.' || *end == 'e' || *end == 'E')
+					{
+						auto number = std::strtod(m_position, &end);
+						obs_data_set_double(data, name, number);
+					}
+					else
+						obs_data_set_int(data, name, integer);
+
+					m_position = end;
+				} break;
+			}
+
+			return true;
+		}
+
+		bool parse_object(obs_data_t* data)
+		{
+			if (!expect('{'))
+				return false;
+
+			if (expect('}'))
+				return true;
+
+			std::string name;
+			do
+			{
+				if (!parse_string(name) || !expect(':') || !parse_value(data, name.c_str()))
+					return false;
+			} while (expect(','));
+
+			return expect('}');
+		}
+
+		bool parse_array(obs_data_array_t* array)
+		{
+			if (!expect('['))
+				return false;
+
+			if (expect(']'))
+				return true;
+
+			do
+			{
+				auto object = obs_data_create();
+				bool result = parse_object(object);
+				if (result)
+					obs_data_array_push_back(array, object);
+
+				obs_data_release(object);
+
+				if (!result)
+					return false;
+			} while (expect(','));
+
+			return expect(']');
+		}
+
+		const char* m_position;
+};
+
+extern "C" {
+
+obs_data_t* obs_data_create(void)
+{
+	return new obs_data_t{};
+}
+
+obs_data_t* obs_data_create_from_json(const char* json_string)
+{
+	return json_string ? json_parser{ json_string }.parse() : nullptr;
+}
+
+obs_data_t* obs_data_create_from_json_file_safe(const char* json_file, const char* backup_ext)
+{
+	//Like libobs, a file which does not parse is replaced by its backup
+	auto read_file = [](const std::string& path) -> obs_data_t*
+		{
+			std::ifstream file{ std::filesystem::u8path(path), std::ios::binary };
+			if (!file)
+				return nullptr;
+
+			std::string json{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+
+			return obs_data_create_from_json(json.c_str());
+		};
+
+	if (!json_file)
+		return nullptr;
+
+	auto data = read_file(json_file);
+	if (!data && backup_ext && *backup_ext)
+		data = read_file(std::string{ json_file } + "." + backup_ext);
+
+	return data;
+}
+
+bool obs_data_save_json_safe(obs_data_t* data, const char* file, const char* temp_ext, const char* backup_ext)
+{
+	if (!data || !file || !temp_ext)
+		return false;
+
+	auto path = std::filesystem::u8path(file);
+	auto temp_path = std::filesystem::u8path(std::string{ file } + "." + temp_ext);
+
+	{
+		std::ofstream temp_file{ temp_path, std::ios::binary | std::ios::trunc };
+		temp_file << obs_data_get_json(data);
+		if (!temp_file)
+			return false;
+	}
+
+	std::error_code error;
+	if (backup_ext && *backup_ext && std::filesystem::exists(path, error))
+		std::filesystem::copy_file(path, std::filesystem::u8path(std::string{ file } + "." + backup_ext), std::filesystem::copy_options::overwrite_existing, error);
+
+	std::filesystem::rename(temp_path, path, error);
+
+	return !error;
+}
+
+const char* obs_data_get_json(obs_data_t* data)
+{
+	if (!data)
+		return nullptr;
+
+	data->m_json.clear();
+	write_object(data->m_json, data, 0);
+
+	return data->m_json.c_str();
+}
+
+void obs_data_addref(obs_data_t* data)
+{
+	if (data)
+		++data->m_refs;
+}
+
+void obs_data_release(obs_data_t* data)
+{
+	if (!data || --data->m_refs)
+		return;
+
+	for (auto& v : data->m_items)
+		release_item(v.second);
+
+	delete data;
+}
+
+void obs_data_set_string(obs_data_t* data, const char* name, const char* val)
+{
+	set_item(data, name, obs_data_item::type::string).m_string = val ? val : "";
+}
+
+void obs_data_set_int(obs_data_t* data, const char* name, long long val)
+{
+	set_item(data, name, obs_data_item::type::integer).m_int = val;
+}
+
+void obs_data_set_bool(obs_data_t* data, const char* name, bool val)
+{
+	set_item(data, name, obs_data_item::type::boolean).m_bool = val;
+}
+
+void obs_data_set_double(obs_data_t* data, const char* name, double val)
+{
+	set_item(data, name, obs_data_item::type::number).m_double = val;
+}
+
+void obs_data_set_obj(obs_data_t* data, const char* name, obs_data_t* obj)
+{
+	obs_data_addref(obj);
+	set_item(data, name, obs_data_item::type::object).m_object = obj;
+}
+
+void obs_data_set_array(obs_data_t* data, const char* name, obs_data_array_t* array)
+{
+	obs_data_array_addref(array);
+	set_item(data, name, obs_data_item::type::array).m_array = array;
+}
+
+//Defaults are kept as values as long as nothing was set, enough for settings that are read once
+void obs_data_set_default_int(obs_data_t* data, const char* name, long long val)
+{
+	if (!find_item(data, name))
+		obs_data_set_int(data, name, val);
+}
+
+void obs_data_set_default_bool(obs_data_t* data, const char* name, bool val)
+{
+	if (!find_item(data, name))
+		obs_data_set_bool(data, name, val);
+}
+
+const char* obs_data_get_string(obs_data_t* data, const char* name)
+{
+	auto item = find_item(data, name);
+
+	return item && item->m_type == obs_data_item::type::string ? item->m_string.c_str() : "";
+}
+
+long long obs_data_get_int(obs_data_t* data, const char* name)
+{
+	auto item = find_item(data, name);
+	if (!item)
+		return 0;
+
+	switch (item->m_type)
+	{
+		case obs_data_item::type::integer: { return item->m_int; } break;
+		case obs_data_item::type::number: { return static_cast<long long>(item->m_double); } break;
+		default: { } break;
+	}
+
+	return 0;
+}
+
+bool obs_data_get_bool(obs_data_t* data, const char* name)
+{
+	auto item = find_item(data, name);
+
+	return item && item->m_type == obs_data_item::type::boolean && item->m_bool;
+}
+
+double obs_data_get_double(obs_data_t* data, const char* name)
+{
+	auto item = find_item(data, name);
+	if (!item)
+		return 0.0;
+
+	switch (item->m_type)
+	{
+		case obs_data_item::type::integer: { return static_cast<double>(item->m_int); } break;
+		case obs_data_item::type::number: { return item->m_double; } break;
+		default: { } break;
+	}
+
+	return 0.0;
+}
+
+obs_data_t* obs_data_get_obj(obs_data_t* data, const char* name)
+{
+	auto item = find_item(data, name);
+	if (!item || item->m_type != obs_data_item::type::object)
+		return nullptr;
+
+	obs_data_addref(item->m_object);
+
+	return item->m_object;
+}
+
+obs_data_array_t* obs_data_get_array(obs_data_t* data, const char* name)
+{
+	auto item = find_item(data, name);
+	if (!item || item->m_type != obs_data_item::type::array)
+		return nullptr;
+
+	obs_data_array_addref(item->m_array);
+
+	return item->m_array;
+}
+
+bool obs_data_has_user_value(obs_data_t* data, const char* name)
+{
+	return find_item(data, name) != nullptr;
+}
+
+obs_data_array_t* obs_data_array_create(void)
+{
+	return new obs_data_array_t{};
+}
+
+void obs_data_array_addref(obs_data_array_t* array)
+{
+	if (array)
+		++array->m_refs;
+}
+
+void obs_data_array_release(obs_data_array_t* array)
+{
+	if (!array || --array->m_refs)
+		return;
+
+	for (auto v : array->m_items)
+		obs_data_release(v);
+
+	delete array;
+}
+
+size_t obs_data_array_count(obs_data_array_t* array)
+{
+	return array ? array->m_items.size() : 0;
+}
+
+obs_data_t* obs_data_array_item(obs_data_array_t* array, size_t idx)
+{
+	if (!array || idx >= array->m_items.size())
+		return nullptr;
+
+	obs_data_addref(array->m_items[idx]);
+
+	return array->m_items[idx];
+}
+
+size_t obs_data_array_push_back(obs_data_array_t* array, obs_data_t* obj)
+{
+	obs_data_addref(obj);
+	array->m_items.push_back(obj);
+
+	return array->m_items.size() - 1;
+}
+
+}
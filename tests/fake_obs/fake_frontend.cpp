@@ -0,0 +1,477 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "fake_obs.h"
+#include "fake_obs_internal.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//Outputs only need to exist for the plugin, they never produce a file
+struct obs_output
+{
+	std::atomic<long> m_refs{ 0 };
+	obs_data_t* m_settings = nullptr;
+};
+
+static std::mutex s_mutex;
+static std::vector<std::pair<obs_frontend_event_cb, void*>> s_callbacks;
+static std::vector<std::pair<obs_frontend_save_cb, void*>> s_save_callbacks;
+static fake_obs::frontend_options s_options;
+static obs_output_t s_recording_output;
+static obs_output_t s_replay_buffer_output;
+static obs_source_t* s_current_scene = nullptr;
+static std::unordered_map<const obs_source_t*, obs_source_t*> s_transition_targets;
+static std::string s_scene_collection = "Untitled";
+static std::atomic_bool s_recording_active{ false };
+static std::atomic_bool s_recording_paused{ false };
+static std::atomic_bool s_replay_buffer_active{ false };
+static std::atomic<uint64_t> s_start_calls{ 0 };
+static std::atomic<uint64_t> s_stop_calls{ 0 };
+
+//Frontend events are always reported on the UI thread
+static void dispatch(obs_frontend_event event)
+{
+	std::vector<std::pair<obs_frontend_event_cb, void*>> callbacks;
+	{
+		std::lock_guard<std::mutex> lock{ s_mutex };
+		callbacks = s_callbacks;
+	}
+
+	for (const auto& v : callbacks)
+		v.first(event, v.second);
+}
+
+static void dispatch_save(obs_data_t* data, bool saving)
+{
+	std::vector<std::pair<obs_frontend_save_cb, void*>> callbacks;
+	{
+		std::lock_guard<std::mutex> lock{ s_mutex };
+		callbacks = s_save_callbacks;
+	}
+
+	for (const auto& v : callbacks)
+		v.first(data, saving, v.second);
+}
+
+static void post_event(obs_frontend_event event, std::chrono::microseconds delay = std::chrono::microseconds{ 0 })
+{
+	fake_obs_internal::post_ui([event]() -> void { dispatch(event); }, delay);
+}
+
+static char* copy_string(const std::string& value)
+{
+	auto result = static_cast<char*>(std::malloc(value.size() + 1));
+	std::memcpy(result, value.c_str(), value.size() + 1);
+
+	return result;
+}
+
+static void fill_source_list(obs_frontend_source_list* list, const std::vector<obs_source_t*>& sources)
+{
+	list->sources.num = 0;
+	list->sources.capacity = sources.size();
+	list->sources.array = static_cast<obs_source_t**>(std::malloc(std::max<size_t>(sources.size(), 1) * sizeof(obs_source_t*)));
+
+	for (auto v : sources)
+	{
+		auto source = obs_source_get_ref(v);
+		if (source)
+			list->sources.array[list->sources.num++] = source;
+	}
+}
+
+void fake_obs::set_frontend_options(const frontend_options& options)
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+	s_options = options;
+}
+
+void fake_obs::set_current_scene(obs_source_t* scene, obs_source_t* transition)
+{
+	{
+		std::lock_guard<std::mutex> lock{ s_mutex };
+		s_current_scene = scene;
+
+		if (transition)
+			s_transition_targets[transition] = scene;
+	}
+
+	if (transition)
+		emit(transition, "transition_start");
+
+	post_event(OBS_FRONTEND_EVENT_SCENE_CHANGED);
+}
+
+void fake_obs::set_transition_target(obs_source_t* transition, obs_source_t* scene)
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+	s_transition_targets[transition] = scene;
+}
+
+void fake_obs::dispatch_frontend_event(obs_frontend_event event)
+{
+	dispatch(event);
+}
+
+void fake_obs::set_scene_collection(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+	s_scene_collection = name;
+}
+
+void fake_obs::save_collection(obs_data_t* data)
+{
+	run_on_ui([data]() -> void { dispatch_save(data, true); });
+}
+
+void fake_obs::load_collection(obs_data_t* data)
+{
+	run_on_ui([data]() -> void { dispatch_save(data, false); });
+}
+
+uint64_t fake_obs::get_start_calls()
+{
+	return s_start_calls;
+}
+
+uint64_t fake_obs::get_stop_calls()
+{
+	return s_stop_calls;
+}
+
+void fake_obs_internal::reset_frontend()
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	s_callbacks.clear();
+	s_save_callbacks.clear();
+	s_options = fake_obs::frontend_options{};
+	s_current_scene = nullptr;
+	s_transition_targets.clear();
+	s_scene_collection = "Untitled";
+
+	for (auto output : { &s_recording_output, &s_replay_buffer_output })
+	{
+		obs_data_release(output->m_settings);
+		output->m_settings = nullptr;
+	}
+	s_recording_active = false;
+	s_recording_paused = false;
+	s_replay_buffer_active = false;
+	s_start_calls = 0;
+	s_stop_calls = 0;
+}
+
+extern "C" {
+
+void obs_frontend_add_event_callback(obs_frontend_event_cb callback, void* private_data)
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+	s_callbacks.emplace_back(callback, private_data);
+}
+
+void obs_frontend_remove_event_callback(obs_frontend_event_cb callback, void* private_data)
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+	s_callbacks.erase(std::remove(s_callbacks.begin(), s_callbacks.end(), std::make_pair(callback, private_data)), s_callbacks.end());
+}
+
+void obs_frontend_add_save_callback(obs_frontend_save_cb callback, void* private_data)
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+	s_save_callbacks.emplace_back(callback, private_data);
+}
+
+void obs_frontend_remove_save_callback(obs_frontend_save_cb callback, void* private_data)
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+	s_save_callbacks.erase(std::remove(s_save_callbacks.begin(), s_save_callbacks.end(), std::make_pair(callback, private_data)), s_save_callbacks.end());
+}
+
+char* obs_frontend_get_current_scene_collection(void)
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	return copy_string(s_scene_collection);
+}
+
+char** obs_frontend_get_scene_collections(void)
+{
+	//There is only the current collection, in one block like obs_frontend_get_scene_names
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	auto result = static_cast<char**>(std::malloc(2 * sizeof(char*) + s_scene_collection.size() + 1));
+	auto text = reinterpret_cast<char*>(result + 2);
+
+	std::memcpy(text, s_scene_collection.c_str(), s_scene_collection.size() + 1);
+	result[0] = text;
+	result[1] = nullptr;
+
+	return result;
+}
+
+char** obs_frontend_get_scene_names(void)
+{
+	//One block like libobs: the pointer table followed by the strings, freed with a single bfree
+	auto scenes = fake_obs_internal::get_scenes();
+
+	size_t size = (scenes.size() + 1) * sizeof(char*);
+	for (auto v : scenes)
+		size += std::strlen(obs_source_get_name(v)) + 1;
+
+	auto result = static_cast<char**>(std::malloc(size));
+	auto text = reinterpret_cast<char*>(result + scenes.size() + 1);
+
+	for (size_t i = 0; i < scenes.size(); ++i)
+	{
+		auto name = obs_source_get_name(scenes[i]);
+		auto length = std::strlen(name) + 1;
+
+		std::memcpy(text, name, length);
+		result[i] = text;
+		text += length;
+	}
+
+	result[scenes.size()] = nullptr;
+
+	return result;
+}
+
+void obs_frontend_get_scenes(obs_frontend_source_list* sources)
+{
+	fill_source_list(sources, fake_obs_internal::get_scenes());
+}
+
+obs_source_t* obs_frontend_get_current_scene(void)
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	return obs_source_get_ref(s_current_scene);
+}
+
+void obs_frontend_get_transitions(obs_frontend_source_list* sources)
+{
+	fill_source_list(sources, fake_obs_internal::get_transitions());
+}
+
+void obs_frontend_source_list_free(obs_frontend_source_list* sources)
+{
+	for (size_t i = 0; i < sources->sources.num; ++i)
+		obs_source_release(sources->sources.array[i]);
+
+	std::free(sources->sources.array);
+	sources->sources.array = nullptr;
+	sources->sources.num = 0;
+	sources->sources.capacity = 0;
+}
+
+obs_source_t* obs_transition_get_source(obs_source_t* transition, enum obs_transition_target target)
+{
+	if (target != OBS_TRANSITION_SOURCE_B)
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	//A transition which never ran heads for the current scene
+	auto it = s_transition_targets.find(transition);
+
+	return obs_source_get_ref(it != s_transition_targets.end() ? it->second : s_current_scene);
+}
+
+void obs_frontend_recording_start(void)
+{
+	++s_start_calls;
+
+	if (s_recording_active.exchange(true))
+		return;
+
+	std::chrono::microseconds latency;
+	{
+		std::lock_guard<std::mutex> lock{ s_mutex };
+		latency = s_options.m_start_latency;
+	}
+
+	post_event(OBS_FRONTEND_EVENT_RECORDING_STARTING);
+	post_event(OBS_FRONTEND_EVENT_RECORDING_STARTED, latency);
+}
+
+void obs_frontend_recording_stop(void)
+{
+	++s_stop_calls;
+
+	if (!s_recording_active.exchange(false))
+		return;
+
+	s_recording_paused = false;
+
+	std::chrono::microseconds latency;
+	{
+		std::lock_guard<std::mutex> lock{ s_mutex };
+		latency = s_options.m_stop_latency;
+	}
+
+	post_event(OBS_FRONTEND_EVENT_RECORDING_STOPPING);
+	post_event(OBS_FRONTEND_EVENT_RECORDING_STOPPED, latency);
+}
+
+bool obs_frontend_recording_active(void)
+{
+	return s_recording_active;
+}
+
+void obs_frontend_recording_pause(bool pause)
+{
+	if (!s_recording_active || s_recording_paused.exchange(pause) == pause)
+		return;
+
+	post_event(pause ? OBS_FRONTEND_EVENT_RECORDING_PAUSED : OBS_FRONTEND_EVENT_RECORDING_UNPAUSED);
+}
+
+bool obs_frontend_recording_paused(void)
+{
+	return s_recording_paused;
+}
+
+bool obs_frontend_recording_split_file(void)
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	return s_recording_active && s_options.m_can_split;
+}
+
+obs_output_t* obs_frontend_get_recording_output(void)
+{
+	++s_recording_output.m_refs;
+
+	return &s_recording_output;
+}
+
+bool obs_output_active(const obs_output_t* output)
+{
+	(void)output;	//unused parameter
+
+	return s_recording_active;
+}
+
+bool obs_output_paused(const obs_output_t* output)
+{
+	(void)output;	//unused parameter
+
+	return s_recording_paused;
+}
+
+bool obs_output_can_pause(const obs_output_t* output)
+{
+	(void)output;	//unused parameter
+
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	return s_options.m_can_pause;
+}
+
+void obs_output_release(obs_output_t* output)
+{
+	if (output)
+		--output->m_refs;
+}
+
+obs_data_t* obs_output_get_settings(const obs_output_t* output)
+{
+	if (!output)
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	auto& settings = const_cast<obs_output_t*>(output)->m_settings;
+	if (!settings)
+		settings = obs_data_create();
+
+	obs_data_addref(settings);
+
+	return settings;
+}
+
+void obs_output_update(obs_output_t* output, obs_data_t* settings)
+{
+	if (!output || !settings)
+		return;
+
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	obs_data_addref(settings);
+	obs_data_release(output->m_settings);
+	output->m_settings = settings;
+}
+
+bool obs_frontend_recording_add_chapter(const char* name)
+{
+	(void)name;	//unused parameter
+
+	return s_recording_active;
+}
+
+void obs_frontend_replay_buffer_start(void)
+{
+	if (s_replay_buffer_active.exchange(true))
+		return;
+
+	post_event(OBS_FRONTEND_EVENT_REPLAY_BUFFER_STARTING);
+	post_event(OBS_FRONTEND_EVENT_REPLAY_BUFFER_STARTED);
+}
+
+void obs_frontend_replay_buffer_stop(void)
+{
+	if (!s_replay_buffer_active.exchange(false))
+		return;
+
+	post_event(OBS_FRONTEND_EVENT_REPLAY_BUFFER_STOPPING);
+	post_event(OBS_FRONTEND_EVENT_REPLAY_BUFFER_STOPPED);
+}
+
+void obs_frontend_replay_buffer_save(void)
+{
+	if (s_replay_buffer_active)
+		post_event(OBS_FRONTEND_EVENT_REPLAY_BUFFER_SAVED);
+}
+
+bool obs_frontend_replay_buffer_active(void)
+{
+	return s_replay_buffer_active;
+}
+
+obs_output_t* obs_frontend_get_replay_buffer_output(void)
+{
+	++s_replay_buffer_output.m_refs;
+
+	return &s_replay_buffer_output;
+}
+
+char* obs_frontend_get_last_replay(void)
+{
+	//The replay buffer never writes a file
+	return nullptr;
+}
+
+}
@@ -0,0 +1,854 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "fake_obs.h"
+#include "fake_obs_internal.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//Signals carry at most a handful of values, kept inline so emitting never allocates
+struct calldata
+{
+	struct entry
+	{
+		const char* m_name = nullptr;
+		void* m_ptr = nullptr;
+		long long m_int = 0;
+		bool m_bool = false;
+	};
+
+	entry m_entries[4];
+	size_t m_count = 0;
+
+	inline void set_ptr(const char* name, void* value) { m_entries[m_count++] = entry{ name, value, 0, false }; }
+	inline void set_bool(const char* name, bool value) { m_entries[m_count++] = entry{ name, nullptr, 0, value }; }
+
+	const entry* find(const char* name) const
+	{
+		for (size_t i = 0; i < m_count; ++i)
+		{
+			if (std::strcmp(m_entries[i].m_name, name) == 0)
+				return &m_entries[i];
+		}
+
+		return nullptr;
+	}
+};
+
+//Like libobs, a callback runs with the handler locked, so disconnecting waits for a callback running on another thread
+struct signal_handler
+{
+	struct connection
+	{
+		std::string m_signal;
+		signal_callback_t m_callback;
+		void* m_data;
+	};
+
+	std::recursive_mutex m_mutex;
+	std::vector<connection> m_connections;
+	//Callbacks may disconnect while we walk the list, they are only erased once nobody walks it anymore
+	size_t m_emitting = 0;
+
+	void emit(const char* signal, calldata_t* cd)
+	{
+		std::lock_guard<std::recursive_mutex> lock{ m_mutex };
+
+		++m_emitting;
+		for (size_t i = 0; i < m_connections.size(); ++i)
+		{
+			const auto& c = m_connections[i];
+			if (c.m_callback && c.m_signal == signal)
+				c.m_callback(c.m_data, cd);
+		}
+
+		if (--m_emitting == 0)
+			m_connections.erase(std::remove_if(m_connections.begin(), m_connections.end(), [](const connection& c) -> bool {return !c.m_callback; }), m_connections.end());
+	}
+};
+
+struct obs_weak_source
+{
+	obs_source_t* m_source = nullptr;
+	std::atomic<long> m_refs{ 0 };
+};
+
+struct obs_sceneitem
+{
+	int64_t m_id = 0;
+	obs_source_t* m_source = nullptr;
+	obs_scene_t* m_parent = nullptr;
+	bool m_visible = false;
+};
+
+struct obs_scene
+{
+	obs_source_t* m_source = nullptr;
+	std::vector<obs_sceneitem_t*> m_items;
+	int64_t m_next_id = 1;
+};
+
+struct obs_source
+{
+	std::string m_name;
+	std::string m_uuid;
+	obs_source_type m_type = OBS_SOURCE_TYPE_INPUT;
+	bool m_group = false;
+	std::atomic_bool m_removed{ false };
+	std::atomic<long> m_refs{ 1 };
+
+	signal_handler m_signals;
+	obs_weak_source m_weak;
+	obs_scene m_scene;
+
+	std::mutex m_audio_mutex;
+	std::vector<std::pair<obs_source_audio_capture_t, void*>> m_audio_callbacks;
+};
+
+struct audio_output
+{
+	size_t m_channels = 2;
+	uint32_t m_sample_rate = 48000;
+};
+
+//The UI thread of the fake: a queue of tasks ordered by the time they are due
+class ui_thread
+{
+	public:
+		void post(std::function<void()> task, std::chrono::microseconds delay)
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+
+			if (!m_thread.joinable())
+			{
+				m_stop = false;
+				m_thread = std::thread{ [this]() -> void { run(); } };
+			}
+
+			m_tasks.emplace(std::chrono::steady_clock::now() + delay, std::move(task));
+			m_condition.notify_all();
+		}
+
+		void flush()
+		{
+			if (is_current())
+				return;
+
+			std::unique_lock<std::mutex> lock{ m_mutex };
+			m_condition.wait(lock, [this]() -> bool {return m_tasks.empty() && !m_running; });
+		}
+
+		void stop()
+		{
+			{
+				std::lock_guard<std::mutex> lock{ m_mutex };
+				m_stop = true;
+				m_tasks.clear();
+				m_condition.notify_all();
+			}
+
+			if (m_thread.joinable())
+				m_thread.join();
+		}
+
+		inline bool is_current() const { return std::this_thread::get_id() == m_id.load(); }
+
+		~ui_thread()
+		{
+			stop();
+		}
+
+	private:
+		void run()
+		{
+			m_id = std::this_thread::get_id();
+
+			std::unique_lock<std::mutex> lock{ m_mutex };
+			while (!m_stop)
+			{
+				if (m_tasks.empty())
+				{
+					m_condition.wait(lock);
+					continue;
+				}
+
+				auto due = m_tasks.begin()->first;
+				if (due > std::chrono::steady_clock::now())
+				{
+					m_condition.wait_until(lock, due);
+					continue;
+				}
+
+				auto task = std::move(m_tasks.begin()->second);
+				m_tasks.erase(m_tasks.begin());
+				m_running = true;
+
+				lock.unlock();
+				task();
+				lock.lock();
+
+				m_running = false;
+				m_condition.notify_all();
+			}
+
+			m_id = std::thread::id{};
+		}
+
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> m_tasks;
+		std::thread m_thread;
+		std::atomic<std::thread::id> m_id;
+		bool m_running = false;
+		bool m_stop = false;
+};
+
+static std::mutex s_mutex;
+static std::vector<std::unique_ptr<obs_source_t>> s_sources;
+static std::unordered_map<std::string, obs_source_t*> s_sources_by_name;
+static std::unordered_map<std::string, obs_source_t*> s_sources_by_uuid;
+static std::vector<std::unique_ptr<obs_sceneitem_t>> s_items;
+static uint64_t s_next_uuid = 1;
+
+static signal_handler s_global_signals;
+static audio_output s_audio;
+static ui_thread s_ui_thread;
+static std::atomic<int> s_log_level{ LOG_WARNING };
+
+static obs_source_t* add_source(const std::string& name, obs_source_type type, bool group)
+{
+	auto source = std::make_unique<obs_source_t>();
+	source->m_name = name;
+	source->m_type = type;
+	source->m_group = group;
+	source->m_weak.m_source = source.get();
+	source->m_scene.m_source = source.get();
+
+	char uuid[40];
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	std::snprintf(uuid, sizeof(uuid), "00000000-0000-4000-8000-%012llx", static_cast<unsigned long long>(s_next_uuid++));
+	source->m_uuid = uuid;
+
+	auto result = source.get();
+	s_sources_by_name[name] = result;
+	s_sources_by_uuid[source->m_uuid] = result;
+	s_sources.push_back(std::move(source));
+
+	return result;
+}
+
+static void emit_source(signal_handler& handler, const char* signal, obs_source_t* source)
+{
+	calldata_t cd;
+	cd.set_ptr("source", source);
+	handler.emit(signal, &cd);
+}
+
+void fake_obs::reset()
+{
+	s_ui_thread.stop();
+	fake_obs_internal::reset_frontend();
+
+	std::lock_guard<std::mutex> lock{ s_mutex };
+	{
+		std::lock_guard<std::recursive_mutex> signal_lock{ s_global_signals.m_mutex };
+		s_global_signals.m_connections.clear();
+	}
+
+	s_items.clear();
+	s_sources_by_name.clear();
+	s_sources_by_uuid.clear();
+	s_sources.clear();
+	s_next_uuid = 1;
+	s_audio = audio_output{};
+}
+
+obs_source_t* fake_obs::create_source(const std::string& name)
+{
+	return add_source(name, OBS_SOURCE_TYPE_INPUT, false);
+}
+
+obs_source_t* fake_obs::create_scene(const std::string& name)
+{
+	return add_source(name, OBS_SOURCE_TYPE_SCENE, false);
+}
+
+obs_source_t* fake_obs::create_group(const std::string& name)
+{
+	return add_source(name, OBS_SOURCE_TYPE_SCENE, true);
+}
+
+obs_source_t* fake_obs::create_transition(const std::string& name)
+{
+	return add_source(name, OBS_SOURCE_TYPE_TRANSITION, false);
+}
+
+void fake_obs::remove_source(obs_source_t* source)
+{
+	emit_source(s_global_signals, "source_remove", source);
+	emit_source(source->m_signals, "remove", source);
+
+	source->m_removed = true;
+
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	auto it = s_sources_by_name.find(source->m_name);
+	if (it != s_sources_by_name.end() && it->second == source)
+		s_sources_by_name.erase(it);
+
+	s_sources_by_uuid.erase(source->m_uuid);
+}
+
+obs_sceneitem_t* fake_obs::add_item(obs_source_t* scene, obs_source_t* child, bool visible)
+{
+	auto item = std::make_unique<obs_sceneitem_t>();
+	item->m_source = child;
+	item->m_parent = &scene->m_scene;
+	item->m_visible = visible;
+
+	auto result = item.get();
+	{
+		std::lock_guard<std::mutex> lock{ s_mutex };
+
+		item->m_id = scene->m_scene.m_next_id++;
+		scene->m_scene.m_items.push_back(result);
+		s_items.push_back(std::move(item));
+	}
+
+	calldata_t cd;
+	cd.set_ptr("scene", &scene->m_scene);
+	cd.set_ptr("item", result);
+	scene->m_signals.emit("item_add", &cd);
+
+	return result;
+}
+
+void fake_obs::remove_item(obs_sceneitem_t* item)
+{
+	auto scene = item->m_parent;
+
+	calldata_t cd;
+	cd.set_ptr("scene", scene);
+	cd.set_ptr("item", item);
+	scene->m_source->m_signals.emit("item_remove", &cd);
+
+	std::lock_guard<std::mutex> lock{ s_mutex };
+	scene->m_items.erase(std::remove(scene->m_items.begin(), scene->m_items.end(), item), scene->m_items.end());
+}
+
+void fake_obs::set_item_visible(obs_sceneitem_t* item, bool visible)
+{
+	if (item->m_visible == visible)
+		return;
+
+	item->m_visible = visible;
+
+	calldata_t cd;
+	cd.set_ptr("scene", item->m_parent);
+	cd.set_ptr("item", item);
+	cd.set_bool("visible", visible);
+	item->m_parent->m_source->m_signals.emit("item_visible", &cd);
+}
+
+void fake_obs::emit(obs_source_t* source, const char* signal)
+{
+	emit_source(source->m_signals, signal, source);
+}
+
+void fake_obs::emit_global(const char* signal, obs_source_t* source)
+{
+	emit_source(s_global_signals, signal, source);
+}
+
+size_t fake_obs::get_connection_count(obs_source_t* source, const char* signal)
+{
+	auto& handler = source ? source->m_signals : s_global_signals;
+	std::lock_guard<std::recursive_mutex> lock{ handler.m_mutex };
+
+	return static_cast<size_t>(std::count_if(handler.m_connections.begin(), handler.m_connections.end(), [signal](const signal_handler::connection& c) -> bool
+		{
+			return c.m_callback && c.m_signal == signal;
+		}));
+}
+
+void fake_obs::push_audio(obs_source_t* source, const float* const* planes, uint32_t frames, bool muted)
+{
+	audio_data audio{};
+	for (size_t i = 0; i < s_audio.m_channels && i < MAX_AV_PLANES; ++i)
+		audio.data[i] = reinterpret_cast<uint8_t*>(const_cast<float*>(planes[i]));
+
+	audio.frames = frames;
+
+	std::lock_guard<std::mutex> lock{ source->m_audio_mutex };
+	for (const auto& v : source->m_audio_callbacks)
+		v.first(v.second, source, &audio, muted);
+}
+
+void fake_obs::set_audio_format(size_t channels, uint32_t sample_rate)
+{
+	s_audio.m_channels = channels;
+	s_audio.m_sample_rate = sample_rate;
+}
+
+size_t fake_obs::get_audio_callback_count(obs_source_t* source)
+{
+	std::lock_guard<std::mutex> lock{ source->m_audio_mutex };
+
+	return source->m_audio_callbacks.size();
+}
+
+void fake_obs::flush_ui()
+{
+	s_ui_thread.flush();
+}
+
+void fake_obs::run_on_ui(std::function<void()> task)
+{
+	s_ui_thread.post(std::move(task), std::chrono::microseconds{ 0 });
+	s_ui_thread.flush();
+}
+
+void fake_obs::set_log_level(int level)
+{
+	s_log_level = level;
+}
+
+void fake_obs_internal::post_ui(std::function<void()> task, std::chrono::microseconds delay)
+{
+	s_ui_thread.post(std::move(task), delay);
+}
+
+bool fake_obs_internal::is_ui_thread()
+{
+	return s_ui_thread.is_current();
+}
+
+void fake_obs_internal::flush_ui()
+{
+	s_ui_thread.flush();
+}
+
+void fake_obs_internal::stop_ui()
+{
+	s_ui_thread.stop();
+}
+
+std::vector<obs_source_t*> fake_obs_internal::get_scenes()
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	std::vector<obs_source_t*> result;
+	for (const auto& v : s_sources)
+	{
+		if (!v->m_removed && v->m_type == OBS_SOURCE_TYPE_SCENE && !v->m_group)
+			result.push_back(v.get());
+	}
+
+	return result;
+}
+
+std::vector<obs_source_t*> fake_obs_internal::get_transitions()
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	std::vector<obs_source_t*> result;
+	for (const auto& v : s_sources)
+	{
+		if (!v->m_removed && v->m_type == OBS_SOURCE_TYPE_TRANSITION)
+			result.push_back(v.get());
+	}
+
+	return result;
+}
+
+extern "C" {
+
+void blog(int log_level, const char* format, ...)
+{
+	if (log_level > s_log_level)
+		return;
+
+	va_list args;
+	va_start(args, format);
+	std::vfprintf(stderr, format, args);
+	va_end(args);
+
+	std::fputc('\n', stderr);
+}
+
+void bfree(void* ptr)
+{
+	std::free(ptr);
+}
+
+const char* obs_module_text(const char* lookup_string)
+{
+	return lookup_string;
+}
+
+char* obs_module_config_path(const char* file)
+{
+	auto path = (std::filesystem::temp_directory_path() / "smartstart_recording_tests" / (file ? file : "")).u8string();
+
+	auto result = static_cast<char*>(std::malloc(path.size() + 1));
+	std::memcpy(result, path.c_str(), path.size() + 1);
+
+	return result;
+}
+
+uint64_t os_gettime_ns(void)
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+signal_handler_t* obs_get_signal_handler(void)
+{
+	return &s_global_signals;
+}
+
+signal_handler_t* obs_source_get_signal_handler(const obs_source_t* source)
+{
+	return source ? &const_cast<obs_source_t*>(source)->m_signals : nullptr;
+}
+
+signal_handler_t* obs_output_get_signal_handler(const obs_output_t* output)
+{
+	(void)output;	//unused parameter
+
+	return nullptr;
+}
+
+void signal_handler_connect(signal_handler_t* handler, const char* signal, signal_callback_t callback, void* data)
+{
+	if (!handler)
+		return;
+
+	std::lock_guard<std::recursive_mutex> lock{ handler->m_mutex };
+	handler->m_connections.push_back(signal_handler::connection{ signal, callback, data });
+}
+
+void signal_handler_disconnect(signal_handler_t* handler, const char* signal, signal_callback_t callback, void* data)
+{
+	if (!handler)
+		return;
+
+	std::lock_guard<std::recursive_mutex> lock{ handler->m_mutex };
+	for (auto& c : handler->m_connections)
+	{
+		if (c.m_callback == callback && c.m_data == data && c.m_signal == signal)
+		{
+			c.m_callback = nullptr;
+			break;
+		}
+	}
+
+	if (!handler->m_emitting)
+		handler->m_connections.erase(std::remove_if(handler->m_connections.begin(), handler->m_connections.end(), [](const signal_handler::connection& c) -> bool {return !c.m_callback; }), handler->m_connections.end());
+}
+
+void* calldata_ptr(const calldata_t* data, const char* name)
+{
+	auto entry = data ? data->find(name) : nullptr;
+
+	return entry ? entry->m_ptr : nullptr;
+}
+
+bool calldata_bool(const calldata_t* data, const char* name)
+{
+	auto entry = data ? data->find(name) : nullptr;
+
+	return entry ? entry->m_bool : false;
+}
+
+long long calldata_int(const calldata_t* data, const char* name)
+{
+	auto entry = data ? data->find(name) : nullptr;
+
+	return entry ? entry->m_int : 0;
+}
+
+const char* calldata_string(const calldata_t* data, const char* name)
+{
+	(void)data;	//unused parameter
+	(void)name;	//unused parameter
+
+	return nullptr;
+}
+
+const char* obs_source_get_name(const obs_source_t* source)
+{
+	return source ? source->m_name.c_str() : nullptr;
+}
+
+const char* obs_source_get_uuid(const obs_source_t* source)
+{
+	return source ? source->m_uuid.c_str() : nullptr;
+}
+
+enum obs_source_type obs_source_get_type(const obs_source_t* source)
+{
+	return source ? source->m_type : OBS_SOURCE_TYPE_INPUT;
+}
+
+bool obs_source_is_scene(const obs_source_t* source)
+{
+	return source && source->m_type == OBS_SOURCE_TYPE_SCENE && !source->m_group;
+}
+
+bool obs_source_is_group(const obs_source_t* source)
+{
+	return source && source->m_group;
+}
+
+obs_source_t* obs_source_get_ref(obs_source_t* source)
+{
+	if (!source || source->m_removed)
+		return nullptr;
+
+	++source->m_refs;
+
+	return source;
+}
+
+void obs_source_release(obs_source_t* source)
+{
+	if (source)
+		--source->m_refs;
+}
+
+obs_source_t* obs_get_source_by_name(const char* name)
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	auto it = name ? s_sources_by_name.find(name) : s_sources_by_name.end();
+	if (it == s_sources_by_name.end())
+		return nullptr;
+
+	++it->second->m_refs;
+
+	return it->second;
+}
+
+obs_source_t* obs_get_source_by_uuid(const char* uuid)
+{
+	std::lock_guard<std::mutex> lock{ s_mutex };
+
+	auto it = uuid ? s_sources_by_uuid.find(uuid) : s_sources_by_uuid.end();
+	if (it == s_sources_by_uuid.end())
+		return nullptr;
+
+	++it->second->m_refs;
+
+	return it->second;
+}
+
+void obs_enum_sources(bool (*enum_proc)(void*, obs_source_t*), void* param)
+{
+	std::vector<obs_source_t*> sources;
+	{
+		std::lock_guard<std::mutex> lock{ s_mutex };
+
+		for (const auto& v : s_sources)
+		{
+			if (!v->m_removed && v->m_type == OBS_SOURCE_TYPE_INPUT)
+				sources.push_back(v.get());
+		}
+	}
+
+	for (auto v : sources)
+	{
+		if (!enum_proc(param, v))
+			break;
+	}
+}
+
+void obs_enum_scenes(bool (*enum_proc)(void*, obs_source_t*), void* param)
+{
+	//Groups are enumerated as well, like libobs does
+	std::vector<obs_source_t*> scenes;
+	{
+		std::lock_guard<std::mutex> lock{ s_mutex };
+
+		for (const auto& v : s_sources)
+		{
+			if (!v->m_removed && v->m_type == OBS_SOURCE_TYPE_SCENE)
+				scenes.push_back(v.get());
+		}
+	}
+
+	for (auto v : scenes)
+	{
+		if (!enum_proc(param, v))
+			break;
+	}
+}
+
+obs_weak_source_t* obs_source_get_weak_source(obs_source_t* source)
+{
+	if (!source)
+		return nullptr;
+
+	++source->m_weak.m_refs;
+
+	return &source->m_weak;
+}
+
+obs_source_t* obs_weak_source_get_source(obs_weak_source_t* weak)
+{
+	if (!weak || weak->m_source->m_removed)
+		return nullptr;
+
+	++weak->m_source->m_refs;
+
+	return weak->m_source;
+}
+
+void obs_weak_source_release(obs_weak_source_t* weak)
+{
+	if (weak)
+		--weak->m_refs;
+}
+
+obs_scene_t* obs_scene_from_source(const obs_source_t* source)
+{
+	return obs_source_is_scene(source) ? &const_cast<obs_source_t*>(source)->m_scene : nullptr;
+}
+
+obs_scene_t* obs_group_from_source(const obs_source_t* source)
+{
+	return obs_source_is_group(source) ? &const_cast<obs_source_t*>(source)->m_scene : nullptr;
+}
+
+obs_source_t* obs_scene_get_source(const obs_scene_t* scene)
+{
+	return scene ? scene->m_source : nullptr;
+}
+
+void obs_scene_enum_items(obs_scene_t* scene, bool (*callback)(obs_scene_t*, obs_sceneitem_t*, void*), void* param)
+{
+	if (!scene)
+		return;
+
+	std::vector<obs_sceneitem_t*> items;
+	{
+		std::lock_guard<std::mutex> lock{ s_mutex };
+		items = scene->m_items;
+	}
+
+	for (auto v : items)
+	{
+		if (!callback(scene, v, param))
+			break;
+	}
+}
+
+obs_source_t* obs_sceneitem_get_source(const obs_sceneitem_t* item)
+{
+	return item ? item->m_source : nullptr;
+}
+
+obs_scene_t* obs_sceneitem_get_scene(const obs_sceneitem_t* item)
+{
+	return item ? item->m_parent : nullptr;
+}
+
+bool obs_sceneitem_visible(const obs_sceneitem_t* item)
+{
+	return item && item->m_visible;
+}
+
+int64_t obs_sceneitem_get_id(const obs_sceneitem_t* item)
+{
+	return item ? item->m_id : 0;
+}
+
+void obs_source_add_audio_capture_callback(obs_source_t* source, obs_source_audio_capture_t callback, void* param)
+{
+	std::lock_guard<std::mutex> lock{ source->m_audio_mutex };
+	source->m_audio_callbacks.emplace_back(callback, param);
+}
+
+void obs_source_remove_audio_capture_callback(obs_source_t* source, obs_source_audio_capture_t callback, void* param)
+{
+	std::lock_guard<std::mutex> lock{ source->m_audio_mutex };
+
+	auto& callbacks = source->m_audio_callbacks;
+	callbacks.erase(std::remove(callbacks.begin(), callbacks.end(), std::make_pair(callback, param)), callbacks.end());
+}
+
+audio_t* obs_get_audio(void)
+{
+	return &s_audio;
+}
+
+size_t audio_output_get_channels(const audio_t* audio)
+{
+	return audio ? audio->m_channels : 0;
+}
+
+uint32_t audio_output_get_sample_rate(const audio_t* audio)
+{
+	return audio ? audio->m_sample_rate : 0;
+}
+
+void obs_queue_task(enum obs_task_type type, obs_task_t task, void* param, bool wait)
+{
+	if (type != OBS_TASK_UI || s_ui_thread.is_current())
+	{
+		task(param);
+		return;
+	}
+
+	if (!wait)
+	{
+		s_ui_thread.post([task, param]() -> void { task(param); }, std::chrono::microseconds{ 0 });
+		return;
+	}
+
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool done = false;
+
+	s_ui_thread.post([&]() -> void
+		{
+			task(param);
+
+			std::lock_guard<std::mutex> lock{ mutex };
+			done = true;
+			condition.notify_all();
+		}, std::chrono::microseconds{ 0 });
+
+	std::unique_lock<std::mutex> lock{ mutex };
+	condition.wait(lock, [&done]() -> bool {return done; });
+}
+
+}
@@ -0,0 +1,101 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+#include <obs-frontend-api.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+//Control side of the headless OBS stand-in. The plugin sources link against the C functions declared in the fake
+//obs-module.h and obs-frontend-api.h, tests and benchmarks use this class to build scenes and drive signals and the frontend.
+//Sources, items and connections are only freed by reset(), so every pointer handed out stays valid until then.
+//Frontend events and UI tasks run on a thread of their own, just like the OBS UI thread.
+class fake_obs
+{
+	public:
+		struct frontend_options
+		{
+			//Time from the frontend call until the frontend reports the new recording state
+			std::chrono::microseconds m_start_latency{ 0 };
+			std::chrono::microseconds m_stop_latency{ 0 };
+			bool m_can_pause = true;
+			bool m_can_split = true;
+		};
+
+		//Forgets every source, connection, callback and frontend state. Nothing may still run on the UI thread.
+		static void reset();
+
+		static obs_source_t* create_source(const std::string& name);
+		static obs_source_t* create_scene(const std::string& name);
+		static obs_source_t* create_group(const std::string& name);
+		//Transitions are listed by obs_frontend_get_transitions()
+		static obs_source_t* create_transition(const std::string& name);
+
+		//Emits "source_remove" on the global signal handler and "remove" on the source, afterwards weak references no longer resolve
+		static void remove_source(obs_source_t* source);
+
+		//Each change emits the scene's item signal, like OBS does for scenes and groups
+		static obs_sceneitem_t* add_item(obs_source_t* scene, obs_source_t* child, bool visible = true);
+		static void remove_item(obs_sceneitem_t* item);
+		static void set_item_visible(obs_sceneitem_t* item, bool visible);
+
+		//Emits a signal with "source" set on the source's own handler, or on the global one
+		static void emit(obs_source_t* source, const char* signal);
+		static void emit_global(const char* signal, obs_source_t* source);
+		static size_t get_connection_count(obs_source_t* source, const char* signal);
+
+		//Hands one block of planar float audio to the capture callbacks, on the calling thread like the audio thread would
+		static void push_audio(obs_source_t* source, const float* const* planes, uint32_t frames, bool muted = false);
+		static void set_audio_format(size_t channels, uint32_t sample_rate);
+		static size_t get_audio_callback_count(obs_source_t* source);
+
+		static void set_frontend_options(const frontend_options& options);
+
+		//Makes scene the program scene. With a transition, its "transition_start" is emitted on the calling thread first,
+		//then the frontend reports the scene change on the UI thread.
+		static void set_current_scene(obs_source_t* scene, obs_source_t* transition = nullptr);
+
+		//What obs_transition_get_source() reports as the transition's destination until the next change, set_current_scene() sets it as well
+		static void set_transition_target(obs_source_t* transition, obs_source_t* scene);
+
+		//Reports a frontend event on the calling thread, which has to be the UI thread (see run_on_ui)
+		static void dispatch_frontend_event(obs_frontend_event event);
+
+		//Named by obs_frontend_get_current_scene_collection(), "Untitled" after reset()
+		static void set_scene_collection(const std::string& name);
+
+		//Runs the save callbacks on the UI thread like OBS does when it writes or loads the scene collection, returns once everything queued ran
+		static void save_collection(obs_data_t* data);
+		static void load_collection(obs_data_t* data);
+
+		//Waits until everything queued on the UI thread ran, delayed recording events included
+		static void flush_ui();
+		//Runs task on the UI thread and waits like flush_ui(), not from the UI thread itself
+		static void run_on_ui(std::function<void()> task);
+
+		static uint64_t get_start_calls();
+		static uint64_t get_stop_calls();
+
+		//Messages above this level are dropped, LOG_WARNING by default
+		static void set_log_level(int level);
+};
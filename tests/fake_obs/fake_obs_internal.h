@@ -0,0 +1,42 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <obs-module.h>
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+//Shared between the parts of the fake, not meant for tests
+class fake_obs_internal
+{
+	public:
+		//Runs task on the UI thread once delay passed
+		static void post_ui(std::function<void()> task, std::chrono::microseconds delay = std::chrono::microseconds{ 0 });
+		static bool is_ui_thread();
+		static void flush_ui();
+		static void stop_ui();
+
+		//Scenes (not groups) and transitions in creation order, without taking references
+		static std::vector<obs_source_t*> get_scenes();
+		static std::vector<obs_source_t*> get_transitions();
+
+		static void reset_frontend();
+};
@@ -0,0 +1,119 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include "obs-module.h"
+
+//Headless stand-in for obs-frontend-api, see fake_obs.h
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum obs_frontend_event
+{
+	OBS_FRONTEND_EVENT_STREAMING_STARTING,
+	OBS_FRONTEND_EVENT_STREAMING_STARTED,
+	OBS_FRONTEND_EVENT_STREAMING_STOPPING,
+	OBS_FRONTEND_EVENT_STREAMING_STOPPED,
+	OBS_FRONTEND_EVENT_RECORDING_STARTING,
+	OBS_FRONTEND_EVENT_RECORDING_STARTED,
+	OBS_FRONTEND_EVENT_RECORDING_STOPPING,
+	OBS_FRONTEND_EVENT_RECORDING_STOPPED,
+	OBS_FRONTEND_EVENT_SCENE_CHANGED,
+	OBS_FRONTEND_EVENT_SCENE_LIST_CHANGED,
+	OBS_FRONTEND_EVENT_TRANSITION_CHANGED,
+	OBS_FRONTEND_EVENT_TRANSITION_STOPPED,
+	OBS_FRONTEND_EVENT_TRANSITION_LIST_CHANGED,
+	OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED,
+	OBS_FRONTEND_EVENT_SCENE_COLLECTION_LIST_CHANGED,
+	OBS_FRONTEND_EVENT_PROFILE_CHANGED,
+	OBS_FRONTEND_EVENT_PROFILE_LIST_CHANGED,
+	OBS_FRONTEND_EVENT_EXIT,
+	OBS_FRONTEND_EVENT_REPLAY_BUFFER_STARTING,
+	OBS_FRONTEND_EVENT_REPLAY_BUFFER_STARTED,
+	OBS_FRONTEND_EVENT_REPLAY_BUFFER_STOPPING,
+	OBS_FRONTEND_EVENT_REPLAY_BUFFER_STOPPED,
+	OBS_FRONTEND_EVENT_STUDIO_MODE_ENABLED,
+	OBS_FRONTEND_EVENT_STUDIO_MODE_DISABLED,
+	OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED,
+	OBS_FRONTEND_EVENT_SCENE_COLLECTION_CLEANUP,
+	OBS_FRONTEND_EVENT_FINISHED_LOADING,
+	OBS_FRONTEND_EVENT_RECORDING_PAUSED,
+	OBS_FRONTEND_EVENT_RECORDING_UNPAUSED,
+	OBS_FRONTEND_EVENT_TRANSITION_DURATION_CHANGED,
+	OBS_FRONTEND_EVENT_REPLAY_BUFFER_SAVED,
+	OBS_FRONTEND_EVENT_VIRTUALCAM_STARTED,
+	OBS_FRONTEND_EVENT_VIRTUALCAM_STOPPED,
+	OBS_FRONTEND_EVENT_TBAR_VALUE_CHANGED,
+	OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGING,
+	OBS_FRONTEND_EVENT_PROFILE_CHANGING,
+	OBS_FRONTEND_EVENT_SCRIPTING_SHUTDOWN,
+	OBS_FRONTEND_EVENT_PROFILE_RENAMED,
+	OBS_FRONTEND_EVENT_SCENE_COLLECTION_RENAMED,
+	OBS_FRONTEND_EVENT_THEME_CHANGED,
+	OBS_FRONTEND_EVENT_SCREENSHOT_TAKEN
+};
+
+//Same layout as the DARRAY libobs uses
+struct obs_frontend_source_list
+{
+	struct
+	{
+		obs_source_t** array;
+		size_t num;
+		size_t capacity;
+	} sources;
+};
+
+typedef void (*obs_frontend_event_cb)(enum obs_frontend_event event, void* private_data);
+typedef void (*obs_frontend_save_cb)(obs_data_t* save_data, bool saving, void* private_data);
+
+void obs_frontend_add_event_callback(obs_frontend_event_cb callback, void* private_data);
+void obs_frontend_remove_event_callback(obs_frontend_event_cb callback, void* private_data);
+void obs_frontend_add_save_callback(obs_frontend_save_cb callback, void* private_data);
+void obs_frontend_remove_save_callback(obs_frontend_save_cb callback, void* private_data);
+
+char* obs_frontend_get_current_scene_collection(void);
+char** obs_frontend_get_scene_collections(void);
+
+char** obs_frontend_get_scene_names(void);
+void obs_frontend_get_scenes(struct obs_frontend_source_list* sources);
+obs_source_t* obs_frontend_get_current_scene(void);
+void obs_frontend_get_transitions(struct obs_frontend_source_list* sources);
+void obs_frontend_source_list_free(struct obs_frontend_source_list* sources);
+
+void obs_frontend_recording_start(void);
+void obs_frontend_recording_stop(void);
+bool obs_frontend_recording_active(void);
+void obs_frontend_recording_pause(bool pause);
+bool obs_frontend_recording_paused(void);
+bool obs_frontend_recording_split_file(void);
+obs_output_t* obs_frontend_get_recording_output(void);
+bool obs_frontend_recording_add_chapter(const char* name);
+
+void obs_frontend_replay_buffer_start(void);
+void obs_frontend_replay_buffer_stop(void);
+void obs_frontend_replay_buffer_save(void);
+bool obs_frontend_replay_buffer_active(void);
+obs_output_t* obs_frontend_get_replay_buffer_output(void);
+char* obs_frontend_get_last_replay(void);
+
+#ifdef __cplusplus
+}
+#endif
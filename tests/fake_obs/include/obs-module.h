@@ -0,0 +1,183 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//Headless stand-in for the parts of libobs the plugin logic uses, see fake_obs.h.
+//Declarations match libobs, so the plugin sources compile against it unchanged.
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_ERROR 100
+#define LOG_WARNING 200
+#define LOG_INFO 300
+#define LOG_DEBUG 400
+
+#define MAX_AV_PLANES 8
+
+typedef struct obs_source obs_source_t;
+typedef struct obs_weak_source obs_weak_source_t;
+typedef struct obs_scene obs_scene_t;
+typedef struct obs_sceneitem obs_sceneitem_t;
+typedef struct obs_output obs_output_t;
+typedef struct obs_data obs_data_t;
+typedef struct obs_data_array obs_data_array_t;
+typedef struct signal_handler signal_handler_t;
+typedef struct calldata calldata_t;
+typedef struct audio_output audio_t;
+
+typedef void (*signal_callback_t)(void* data, calldata_t* cd);
+
+enum obs_source_type
+{
+	OBS_SOURCE_TYPE_INPUT,
+	OBS_SOURCE_TYPE_FILTER,
+	OBS_SOURCE_TYPE_TRANSITION,
+	OBS_SOURCE_TYPE_SCENE
+};
+
+enum obs_transition_target
+{
+	OBS_TRANSITION_SOURCE_A,
+	OBS_TRANSITION_SOURCE_B
+};
+
+enum obs_task_type
+{
+	OBS_TASK_UI,
+	OBS_TASK_GRAPHICS,
+	OBS_TASK_AUDIO,
+	OBS_TASK_DESTROY
+};
+
+typedef void (*obs_task_t)(void* param);
+
+struct audio_data
+{
+	uint8_t* data[MAX_AV_PLANES];
+	uint32_t frames;
+	uint64_t timestamp;
+};
+
+typedef void (*obs_source_audio_capture_t)(void* param, obs_source_t* source, const struct audio_data* audio_data, bool muted);
+
+//Logging and memory
+void blog(int log_level, const char* format, ...);
+void bfree(void* ptr);
+const char* obs_module_text(const char* lookup_string);
+char* obs_module_config_path(const char* file);
+uint64_t os_gettime_ns(void);
+
+//Signals
+signal_handler_t* obs_get_signal_handler(void);
+signal_handler_t* obs_source_get_signal_handler(const obs_source_t* source);
+signal_handler_t* obs_output_get_signal_handler(const obs_output_t* output);
+void signal_handler_connect(signal_handler_t* handler, const char* signal, signal_callback_t callback, void* data);
+void signal_handler_disconnect(signal_handler_t* handler, const char* signal, signal_callback_t callback, void* data);
+
+void* calldata_ptr(const calldata_t* data, const char* name);
+bool calldata_bool(const calldata_t* data, const char* name);
+long long calldata_int(const calldata_t* data, const char* name);
+const char* calldata_string(const calldata_t* data, const char* name);
+
+//Sources
+const char* obs_source_get_name(const obs_source_t* source);
+const char* obs_source_get_uuid(const obs_source_t* source);
+enum obs_source_type obs_source_get_type(const obs_source_t* source);
+bool obs_source_is_scene(const obs_source_t* source);
+bool obs_source_is_group(const obs_source_t* source);
+obs_source_t* obs_source_get_ref(obs_source_t* source);
+void obs_source_release(obs_source_t* source);
+obs_source_t* obs_get_source_by_name(const char* name);
+obs_source_t* obs_get_source_by_uuid(const char* uuid);
+void obs_enum_sources(bool (*enum_proc)(void*, obs_source_t*), void* param);
+void obs_enum_scenes(bool (*enum_proc)(void*, obs_source_t*), void* param);
+obs_source_t* obs_transition_get_source(obs_source_t* transition, enum obs_transition_target target);
+
+obs_weak_source_t* obs_source_get_weak_source(obs_source_t* source);
+obs_source_t* obs_weak_source_get_source(obs_weak_source_t* weak);
+void obs_weak_source_release(obs_weak_source_t* weak);
+
+//Scenes
+obs_scene_t* obs_scene_from_source(const obs_source_t* source);
+obs_scene_t* obs_group_from_source(const obs_source_t* source);
+obs_source_t* obs_scene_get_source(const obs_scene_t* scene);
+void obs_scene_enum_items(obs_scene_t* scene, bool (*callback)(obs_scene_t*, obs_sceneitem_t*, void*), void* param);
+obs_source_t* obs_sceneitem_get_source(const obs_sceneitem_t* item);
+obs_scene_t* obs_sceneitem_get_scene(const obs_sceneitem_t* item);
+bool obs_sceneitem_visible(const obs_sceneitem_t* item);
+int64_t obs_sceneitem_get_id(const obs_sceneitem_t* item);
+
+//Audio
+void obs_source_add_audio_capture_callback(obs_source_t* source, obs_source_audio_capture_t callback, void* param);
+void obs_source_remove_audio_capture_callback(obs_source_t* source, obs_source_audio_capture_t callback, void* param);
+audio_t* obs_get_audio(void);
+size_t audio_output_get_channels(const audio_t* audio);
+uint32_t audio_output_get_sample_rate(const audio_t* audio);
+
+//Outputs
+bool obs_output_active(const obs_output_t* output);
+bool obs_output_paused(const obs_output_t* output);
+bool obs_output_can_pause(const obs_output_t* output);
+void obs_output_release(obs_output_t* output);
+obs_data_t* obs_output_get_settings(const obs_output_t* output);
+void obs_output_update(obs_output_t* output, obs_data_t* settings);
+
+//Tasks, only OBS_TASK_UI is queued, everything else runs right away
+void obs_queue_task(enum obs_task_type type, obs_task_t task, void* param, bool wait);
+
+//Settings objects, serialized as JSON like libobs does
+obs_data_t* obs_data_create(void);
+obs_data_t* obs_data_create_from_json(const char* json_string);
+obs_data_t* obs_data_create_from_json_file_safe(const char* json_file, const char* backup_ext);
+bool obs_data_save_json_safe(obs_data_t* data, const char* file, const char* temp_ext, const char* backup_ext);
+const char* obs_data_get_json(obs_data_t* data);
+void obs_data_addref(obs_data_t* data);
+void obs_data_release(obs_data_t* data);
+void obs_data_set_string(obs_data_t* data, const char* name, const char* val);
+void obs_data_set_int(obs_data_t* data, const char* name, long long val);
+void obs_data_set_bool(obs_data_t* data, const char* name, bool val);
+void obs_data_set_double(obs_data_t* data, const char* name, double val);
+void obs_data_set_obj(obs_data_t* data, const char* name, obs_data_t* obj);
+void obs_data_set_array(obs_data_t* data, const char* name, obs_data_array_t* array);
+void obs_data_set_default_int(obs_data_t* data, const char* name, long long val);
+void obs_data_set_default_bool(obs_data_t* data, const char* name, bool val);
+const char* obs_data_get_string(obs_data_t* data, const char* name);
+long long obs_data_get_int(obs_data_t* data, const char* name);
+bool obs_data_get_bool(obs_data_t* data, const char* name);
+double obs_data_get_double(obs_data_t* data, const char* name);
+obs_data_t* obs_data_get_obj(obs_data_t* data, const char* name);
+obs_data_array_t* obs_data_get_array(obs_data_t* data, const char* name);
+bool obs_data_has_user_value(obs_data_t* data, const char* name);
+
+obs_data_array_t* obs_data_array_create(void);
+void obs_data_array_addref(obs_data_array_t* array);
+void obs_data_array_release(obs_data_array_t* array);
+size_t obs_data_array_count(obs_data_array_t* array);
+obs_data_t* obs_data_array_item(obs_data_array_t* array, size_t idx);
+size_t obs_data_array_push_back(obs_data_array_t* array, obs_data_t* obj);
+
+#ifdef __cplusplus
+}
+#endif
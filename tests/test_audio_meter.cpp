@@ -0,0 +1,256 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "audio_meter.h"
+#include "audio_monitor.h"
+#include "fake_obs.h"
+#include "test_check.h"
+
+//Every audio_meter kernel the CPU supports against measure_scalar, then audio_gate and audio_monitor on synthetic PCM.
+
+static constexpr uint32_t SAMPLE_RATE = 48000;
+
+//The kernels add in a different order, the sums may differ by rounding
+static bool close_to(float value, float expected)
+{
+	return std::fabs(value - expected) <= 1e-4f * std::fabs(expected) + 1e-6f;
+}
+
+static void test_selected_kernel()
+{
+	auto kernels = audio_meter::get_kernels();
+
+	CHECK(!kernels.empty());
+	CHECK(!kernels.empty() && std::strcmp(kernels.front().m_name, audio_meter::kernel_name()) == 0);
+	CHECK(!kernels.empty() && kernels.back().m_function == audio_meter::measure_scalar);
+
+	for (const auto& v : kernels)
+		std::printf("kernel %s\n", v.m_name);
+}
+
+static void test_kernels_match_scalar()
+{
+	constexpr size_t MAX_COUNT = 4096;
+	constexpr size_t MAX_OFFSET = 16;
+
+	std::mt19937 random{ 2025 };
+	std::uniform_real_distribution<float> sample{ -1.0f, 1.0f };
+
+	std::vector<float> buffer(MAX_COUNT + MAX_OFFSET);
+
+	//Lengths around every unroll width, then random ones
+	std::vector<size_t> counts{ 0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 480, 1024, MAX_COUNT };
+	for (int i = 0; i < 200; ++i)
+		counts.push_back(random() % (MAX_COUNT + 1));
+
+	for (const auto& kernel : audio_meter::get_kernels())
+	{
+		for (auto count : counts)
+		{
+			//Any offset, OBS does not align its planes for us
+			auto offset = random() % MAX_OFFSET;
+			auto samples = buffer.data() + offset;
+
+			for (auto& v : buffer)
+				v = sample(random) * 0.5f;
+
+			//A single loud sample anywhere, the tail included
+			if (count)
+				samples[random() % count] = random() % 2 ? 0.99f : -0.99f;
+
+			auto expected = audio_meter::measure_scalar(samples, count);
+			auto value = kernel.m_function(samples, count);
+
+			if (!close_to(value.m_sum_squares, expected.m_sum_squares) || value.m_peak != expected.m_peak)
+			{
+				std::printf("%s with %zu samples at offset %zu: sum of squares %g instead of %g, peak %g instead of %g\n", kernel.m_name, count, static_cast<size_t>(offset), static_cast<double>(value.m_sum_squares), static_cast<double>(expected.m_sum_squares), static_cast<double>(value.m_peak), static_cast<double>(expected.m_peak));
+				test_failure() = true;
+			}
+		}
+	}
+}
+
+static void test_silence_and_negative_zero()
+{
+	std::vector<float> samples(100, -0.0f);
+
+	for (const auto& kernel : audio_meter::get_kernels())
+	{
+		auto value = kernel.m_function(samples.data(), samples.size());
+		CHECK(value.m_sum_squares == 0.0f);
+		CHECK(value.m_peak == 0.0f && !std::signbit(value.m_peak));
+	}
+}
+
+//Blocks of constant RMS until the gate flips or the time runs out, returns the seconds it took or -1
+static float run_gate(audio_gate& gate, float rms, uint32_t frames, float seconds)
+{
+	auto duration = static_cast<float>(frames) / static_cast<float>(SAMPLE_RATE);
+
+	float elapsed = 0.0f;
+	while (elapsed < seconds)
+	{
+		elapsed += duration;
+		if (gate.process(rms, frames, SAMPLE_RATE))
+			return elapsed;
+	}
+
+	return -1.0f;
+}
+
+static void test_gate()
+{
+	//-40 dBFS opens, -46 dBFS closes after the hold time
+	audio_gate::options options;
+	options.m_threshold = -40;
+	options.m_attack = 20;
+	options.m_hold = 2000;
+	options.m_release = 300;
+
+	constexpr float LOUD = 0.02f;	//-34 dBFS
+
+	//A single 10 ms block does not get the envelope up to the threshold, sustained audio does within two attack times
+	{
+		audio_gate gate{ options };
+		CHECK(!gate.process(LOUD, 480, SAMPLE_RATE));
+		CHECK(!gate.is_open());
+
+		auto opened = run_gate(gate, LOUD, 480, 1.0f);
+		CHECK(opened > 0.0f && opened <= 0.04f);
+		CHECK(gate.is_open());
+	}
+
+	//A pause shorter than release plus hold keeps it open, a longer one closes it
+	{
+		audio_gate gate{ options };
+		CHECK(run_gate(gate, LOUD, 480, 1.0f) > 0.0f);
+		CHECK(run_gate(gate, 0.0f, 480, 2.0f) < 0.0f);
+		CHECK(gate.is_open());
+
+		CHECK(run_gate(gate, LOUD, 480, 0.5f) < 0.0f);
+
+		auto closed = run_gate(gate, 0.0f, 480, 5.0f);
+		CHECK(closed > 2.0f && closed < 3.0f);
+		CHECK(!gate.is_open());
+	}
+
+	//The block size does not change when it flips
+	{
+		audio_gate small{ options };
+		audio_gate large{ options };
+		CHECK(run_gate(small, LOUD, 256, 1.0f) > 0.0f);
+		CHECK(run_gate(large, LOUD, 2048, 1.0f) > 0.0f);
+
+		//Both envelopes settle on the same level before the pause
+		CHECK(run_gate(small, LOUD, 256, 1.0f) < 0.0f);
+		CHECK(run_gate(large, LOUD, 2048, 1.0f) < 0.0f);
+
+		auto closed_small = run_gate(small, 0.0f, 256, 5.0f);
+		auto closed_large = run_gate(large, 0.0f, 2048, 5.0f);
+		CHECK(closed_small > 0.0f && closed_large > 0.0f);
+		CHECK(std::fabs(closed_small - closed_large) <= 2048.0f / static_cast<float>(SAMPLE_RATE));
+	}
+}
+
+//Sine on the first channel only, the others silent. The RMS is taken over every channel.
+static void test_monitor(size_t channels)
+{
+	fake_obs::reset();
+	fake_obs::set_log_level(LOG_ERROR);
+	fake_obs::set_audio_format(channels, SAMPLE_RATE);
+
+	auto source = fake_obs::create_source("Mic " + std::to_string(channels));
+
+	std::vector<bool> changes;
+	{
+		audio_monitor monitor{ [&changes](const source_key& key, bool active, audio_monitor::clock::time_point time) -> void
+			{
+				(void)key;	//unused parameter
+				(void)time;	//unused parameter
+
+				changes.push_back(active);
+			} };
+
+		audio_gate::options options;
+		options.m_threshold = -40;
+		options.m_hold = 200;
+		monitor.set_options(options);
+		monitor.synchronize(&source, 1);
+		CHECK(fake_obs::get_audio_callback_count(source) == 1);
+
+		constexpr uint32_t FRAMES = 480;
+
+		//Channel RMS of 0.1 is about -23 dBFS over six channels, above the threshold for every layout
+		std::vector<float> sine(FRAMES);
+		for (uint32_t i = 0; i < FRAMES; ++i)
+			sine[i] = 0.1f * std::sqrt(2.0f) * std::sin(2.0f * 3.14159265f * 1000.0f * static_cast<float>(i) / static_cast<float>(SAMPLE_RATE));
+
+		std::vector<float> silence(FRAMES, 0.0f);
+
+		std::vector<const float*> loud_planes(channels, silence.data());
+		loud_planes[0] = sine.data();
+		std::vector<const float*> silent_planes(channels, silence.data());
+
+		for (int i = 0; i < 20; ++i)
+			fake_obs::push_audio(source, loud_planes.data(), FRAMES);
+
+		CHECK(changes.size() == 1 && changes[0]);
+
+		//Muted audio counts as silence
+		for (int i = 0; i < 20; ++i)
+			fake_obs::push_audio(source, loud_planes.data(), FRAMES, true);
+
+		for (int i = 0; i < 100; ++i)
+			fake_obs::push_audio(source, silent_planes.data(), FRAMES);
+
+		CHECK(changes.size() == 2 && !changes[1]);
+
+		auto statistics = monitor.get_statistics();
+		CHECK(statistics.size() == 1);
+		CHECK(statistics.size() == 1 && statistics[0].m_blocks == 140 && !statistics[0].m_open);
+		CHECK(statistics.size() == 1 && close_to(statistics[0].m_peak, audio_meter::measure_scalar(sine.data(), sine.size()).m_peak));
+
+		monitor.clear();
+		CHECK(fake_obs::get_audio_callback_count(source) == 0);
+	}
+
+	fake_obs::reset();
+}
+
+int main()
+{
+	test_selected_kernel();
+	test_kernels_match_scalar();
+	test_silence_and_negative_zero();
+	test_gate();
+
+	for (size_t channels : { 1, 2, 6 })
+		test_monitor(channels);
+
+	return test_failed();
+}
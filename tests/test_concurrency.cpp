@@ -0,0 +1,309 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fake_obs.h"
+#include "mpsc_queue.h"
+#include "rcu_cell.h"
+#include "rule_snapshot.h"
+#include "smartstart_recording.h"
+#include "test_check.h"
+#include "wakeup_event.h"
+
+//Hammers the structures shared between the UI thread, OBS signal threads and the controller's worker.
+//Meant to run under ThreadSanitizer (SMARTSTART_TSAN=ON), without it only the invariants are checked.
+
+static bool s_quick = false;
+
+//Producers push ascending numbers, the consumer sleeps on the wakeup between batches and must see every number of a producer in order
+static void stress_mpsc_queue()
+{
+	struct message
+	{
+		uint32_t m_producer;
+		uint32_t m_sequence;
+	};
+
+	constexpr uint32_t PRODUCERS = 4;
+	const uint32_t messages = s_quick ? 20000 : 500000;
+
+	mpsc_queue<message, 256> queue;
+	wakeup_event wakeup;
+	std::atomic<uint32_t> finished{ 0 };
+
+	std::vector<std::thread> producers;
+	for (uint32_t p = 0; p < PRODUCERS; ++p)
+	{
+		producers.emplace_back([&, p]() -> void
+			{
+				for (uint32_t i = 0; i < messages; ++i)
+				{
+					while (!queue.try_push(message{ p, i }))
+					{
+						wakeup.notify();
+						std::this_thread::yield();
+					}
+
+					wakeup.notify();
+				}
+
+				finished.fetch_add(1);
+				wakeup.notify();
+			});
+	}
+
+	std::vector<uint32_t> next(PRODUCERS, 0);
+	uint64_t received = 0;
+
+	while (true)
+	{
+		message value;
+		while (queue.try_pop(value))
+		{
+			CHECK(value.m_producer < PRODUCERS);
+			CHECK(value.m_sequence == next[value.m_producer]);
+
+			next[value.m_producer] = value.m_sequence + 1;
+			++received;
+		}
+
+		if (finished.load() == PRODUCERS && received == static_cast<uint64_t>(PRODUCERS) * messages)
+			break;
+
+		wakeup.wait_until(wakeup_event::clock::now() + std::chrono::milliseconds{ 10 });
+	}
+
+	for (auto& v : producers)
+		v.join();
+
+	CHECK(received == static_cast<uint64_t>(PRODUCERS) * messages);
+	std::printf("mpsc_queue: %llu messages from %u producers\n", static_cast<unsigned long long>(received), PRODUCERS);
+}
+
+//Every rule of a snapshot carries the snapshot's version as its trigger time, so a reader seeing a half built or freed table notices
+static std::vector<recording_setting> make_rules(const std::vector<source_key>& keys, uint64_t version)
+{
+	std::vector<recording_setting> settings;
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		//Edits add and remove the odd rules, the even ones are always there
+		if (i % 2 && version % 3 == 0)
+			continue;
+
+		settings.emplace_back(keys[i], "Scene " + std::to_string(i), recording_setting::action::start, static_cast<uint32_t>(version));
+	}
+
+	settings.emplace_back(source_key::generate(), "Pattern *", recording_setting::action::stop, static_cast<uint32_t>(version), 0, recording_setting::match::wildcard);
+
+	return settings;
+}
+
+static void stress_rcu_cell()
+{
+	constexpr size_t READERS = 4;
+	const uint64_t edits = s_quick ? 500 : 5000;
+
+	std::vector<source_key> keys;
+	for (size_t i = 0; i < 64; ++i)
+		keys.push_back(source_key::generate());
+
+	rcu_cell<rule_snapshot> cell{ std::make_unique<const rule_snapshot>(make_rules(keys, 0), 0) };
+	std::atomic_bool done{ false };
+	std::atomic<uint64_t> reads{ 0 };
+
+	std::vector<std::thread> readers;
+	for (size_t r = 0; r < READERS; ++r)
+	{
+		readers.emplace_back([&, r]() -> void
+			{
+				uint64_t last_version = 0;
+				size_t i = r;
+
+				while (!done.load())
+				{
+					auto snapshot = cell.read();
+					auto version = snapshot->get_version();
+
+					//Versions only move forward for a single reader
+					CHECK(version >= last_version);
+					last_version = version;
+
+					auto rule = snapshot->find(keys[i % keys.size()]);
+					CHECK(rule || i % 2);
+					CHECK(!rule || rule->get_trigger_time() == version);
+
+					auto pattern = snapshot->resolve(source_key{}, "Pattern match");
+					CHECK(pattern && pattern->get_trigger_time() == version);
+
+					++i;
+					reads.fetch_add(1, std::memory_order_relaxed);
+
+					//Signal threads do other things in between, a reader spinning on the cell would only starve the writer
+					std::this_thread::yield();
+				}
+			});
+	}
+
+	//Edits only start once every reader runs, even on a single core
+	while (reads.load() < READERS)
+		std::this_thread::yield();
+
+	//Half the edits go through update, which builds from the current value, the other half are published outright
+	for (uint64_t version = 1; version <= edits; ++version)
+	{
+		if (version % 2)
+		{
+			cell.update([&keys, version](const rule_snapshot& current) -> std::unique_ptr<const rule_snapshot>
+				{
+					(void)current;	//unused parameter
+
+					return std::make_unique<const rule_snapshot>(make_rules(keys, version), version);
+				});
+		}
+		else
+		{
+			cell.publish(std::make_unique<const rule_snapshot>(make_rules(keys, version), version));
+		}
+
+		std::this_thread::yield();
+	}
+
+	done = true;
+	for (auto& v : readers)
+		v.join();
+
+	CHECK(cell.read()->get_version() == edits);
+	std::printf("rcu_cell: %llu edits, %llu reads\n", static_cast<unsigned long long>(edits), static_cast<unsigned long long>(reads.load()));
+}
+
+//The plugin as a whole: transitions fire from several signal threads while the UI thread edits rules and changes scenes
+static void stress_plugin()
+{
+	constexpr size_t SIGNAL_THREADS = 3;
+	const int rounds = s_quick ? 500 : 5000;
+
+	fake_obs::reset();
+	fake_obs::set_log_level(LOG_ERROR);
+
+	std::vector<obs_source_t*> scenes;
+	std::vector<source_key> keys;
+	for (size_t i = 0; i < 32; ++i)
+	{
+		scenes.push_back(fake_obs::create_scene("Scene " + std::to_string(i)));
+		keys.push_back(source_key::from_source(scenes.back()));
+	}
+
+	//Nested scenes, so scene changes on the UI thread also move the scene graph
+	for (size_t i = 1; i < scenes.size(); i += 4)
+		fake_obs::add_item(scenes[i], scenes[i + 1]);
+
+	std::vector<obs_source_t*> transitions;
+	for (size_t i = 0; i < SIGNAL_THREADS; ++i)
+		transitions.push_back(fake_obs::create_transition("Transition " + std::to_string(i)));
+
+	{
+		//The plugin itself, attached like OBS attaches it. Rules are edited on the UI thread like the settings window does.
+		auto& plugin = smartstart_recording::get();
+		auto publish = [&plugin, &keys](uint64_t version) -> void
+			{
+				auto settings = make_rules(keys, version);
+				plugin.update_recording_settings(std::list<recording_setting>{ settings.begin(), settings.end() });
+			};
+
+		fake_obs::run_on_ui([&]() -> void
+			{
+				publish(1);
+				plugin.attach();
+
+				fake_obs::dispatch_frontend_event(OBS_FRONTEND_EVENT_FINISHED_LOADING);
+				fake_obs::dispatch_frontend_event(OBS_FRONTEND_EVENT_TRANSITION_LIST_CHANGED);
+			});
+
+		CHECK(plugin.get_transition_connections().size() == SIGNAL_THREADS);
+
+		std::atomic_bool done{ false };
+		std::vector<std::thread> signal_threads;
+
+		for (size_t t = 0; t < SIGNAL_THREADS; ++t)
+		{
+			signal_threads.emplace_back([&, t]() -> void
+				{
+					while (!done.load())
+					{
+						fake_obs::emit(transitions[t], "transition_start");
+						std::this_thread::yield();
+					}
+				});
+		}
+
+		for (int i = 0; i < rounds; ++i)
+		{
+			if (i % 8 == 0)
+			{
+				fake_obs::run_on_ui([&publish, i]() -> void
+					{
+						publish(static_cast<uint64_t>(i) + 2);
+					});
+			}
+
+			fake_obs::set_current_scene(scenes[static_cast<size_t>(i) % scenes.size()]);
+		}
+
+		fake_obs::flush_ui();
+		done = true;
+
+		for (auto& v : signal_threads)
+			v.join();
+
+		fake_obs::run_on_ui([&plugin]() -> void
+			{
+				plugin.unload();
+			});
+	}
+
+	fake_obs::flush_ui();
+	fake_obs::reset();
+
+	std::printf("plugin: %d scene changes against %zu signal threads\n", rounds, SIGNAL_THREADS);
+}
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--quick") == 0)
+			s_quick = true;
+	}
+
+	stress_mpsc_queue();
+	stress_rcu_cell();
+	stress_plugin();
+
+	return test_failed();
+}
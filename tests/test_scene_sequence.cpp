@@ -0,0 +1,358 @@
+/*
+SmartStart Recording
+Copyright (C) <2025> <ShivaPlays> <stefan.waldegger@yahoo.de>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <obs-module.h>
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "fake_obs.h"
+#include "recording_setting.h"
+#include "scene_sequence_set.h"
+#include "smartstart_recording.h"
+#include "test_check.h"
+
+//Sequence and dwell rules through scene_sequence_set and scene_sequence_matcher, and once through the plugin attached to the fake OBS.
+//Besides the cases below, random scene histories are checked against a plain NFA which keeps every partial match.
+
+using clock_type = scene_sequence_matcher::clock;
+
+static clock_type::time_point at(int64_t milliseconds)
+{
+	return clock_type::time_point{} + std::chrono::hours{ 1 } + std::chrono::milliseconds{ milliseconds };
+}
+
+static recording_setting sequence(const std::string& steps, uint32_t window, int32_t priority = 0)
+{
+	return recording_setting{ source_key::generate(), steps, recording_setting::action::start, 0, 0, recording_setting::match::sequence, priority, window };
+}
+
+static recording_setting dwell(const std::string& scene, uint32_t window, uint32_t trigger_time = 0)
+{
+	return recording_setting{ source_key::generate(), scene, recording_setting::action::stop, trigger_time, 0, recording_setting::match::dwell, 0, window };
+}
+
+static void test_split_steps()
+{
+	auto steps = scene_sequence_set::split_steps(" Intro >Live  >  Outro ");
+	CHECK(steps.size() == 3);
+	CHECK(steps.size() == 3 && steps[0] == "Intro" && steps[1] == "Live" && steps[2] == "Outro");
+
+	CHECK(scene_sequence_set::valid(sequence("Intro > Live", 0)));
+	CHECK(!scene_sequence_set::valid(sequence("Intro > > Live", 0)));
+	CHECK(!scene_sequence_set::valid(sequence("Intro >", 0)));
+	CHECK(scene_sequence_set::valid(dwell("Outro > not a step", 1000)));
+	CHECK(!scene_sequence_set::valid(dwell("  ", 1000)));
+
+	auto renamed = sequence("Intro > Live > Intro", 0);
+	CHECK(scene_sequence_set::rename(renamed, "Intro", "Opening"));
+	CHECK(renamed.get_scene_name() == "Opening > Live > Opening");
+	CHECK(!scene_sequence_set::rename(renamed, "Missing", "Other"));
+}
+
+static void test_sequence_within_window()
+{
+	std::vector<recording_setting> settings{ sequence("Intro > Live", 10000) };
+	scene_sequence_set set;
+	set.build(settings);
+
+	scene_sequence_matcher matcher;
+
+	//Other scenes in between do not break the sequence
+	CHECK(!matcher.advance(set, 1, "Intro", at(0)).m_rule);
+	CHECK(!matcher.advance(set, 1, "Break", at(2000)).m_rule);
+	CHECK(matcher.advance(set, 1, "Live", at(5000)).m_rule == &settings[0]);
+
+	//A completed match is used up
+	CHECK(!matcher.advance(set, 1, "Live", at(6000)).m_rule);
+	CHECK(matcher.get_active() == 0);
+
+	//Too late
+	CHECK(!matcher.advance(set, 1, "Intro", at(20000)).m_rule);
+	CHECK(!matcher.advance(set, 1, "Live", at(30001)).m_rule);
+
+	//Showing the first step again starts the window over
+	CHECK(!matcher.advance(set, 1, "Intro", at(40000)).m_rule);
+	CHECK(!matcher.advance(set, 1, "Intro", at(48000)).m_rule);
+	CHECK(matcher.advance(set, 1, "Live", at(57000)).m_rule == &settings[0]);
+}
+
+static void test_three_steps_and_merging()
+{
+	std::vector<recording_setting> settings{ sequence("A > B > C", 0) };
+	scene_sequence_set set;
+	set.build(settings);
+
+	scene_sequence_matcher matcher;
+
+	//Two partials reaching the same state are one
+	matcher.advance(set, 1, "A", at(0));
+	matcher.advance(set, 1, "B", at(1));
+	matcher.advance(set, 1, "A", at(2));
+	CHECK(matcher.get_active() == 2);
+
+	matcher.advance(set, 1, "B", at(3));
+	CHECK(matcher.get_active() == 1);
+
+	CHECK(matcher.advance(set, 1, "C", at(4)).m_rule == &settings[0]);
+	CHECK(matcher.get_active() == 0);
+
+	//Unknown scenes cost nothing and change nothing
+	CHECK(!matcher.advance(set, 1, "Unknown", at(5)).m_rule);
+	CHECK(matcher.get_active() == 0);
+}
+
+static void test_priority()
+{
+	std::vector<recording_setting> settings{ sequence("A > B", 0, 1), sequence("X > B", 0, 5), sequence("A > B", 0, 5) };
+	scene_sequence_set set;
+	set.build(settings);
+
+	scene_sequence_matcher matcher;
+	matcher.advance(set, 1, "A", at(0));
+	matcher.advance(set, 1, "X", at(1));
+
+	//Highest priority wins, of equal ones the rule listed first
+	CHECK(matcher.advance(set, 1, "B", at(2)).m_rule == &settings[1]);
+}
+
+static void test_dwell()
+{
+	std::vector<recording_setting> settings{ dwell("Outro", 30000) };
+	scene_sequence_set set;
+	set.build(settings);
+
+	scene_sequence_matcher matcher;
+
+	//The rule fires right away, the dispatcher delays it by the window
+	CHECK(matcher.advance(set, 1, "Outro", at(0)).m_rule == &settings[0]);
+
+	//Leaving early withdraws it
+	auto result = matcher.advance(set, 1, "Live", at(10000));
+	CHECK(!result.m_rule && result.m_withdraw);
+
+	//Leaving after the action ran withdraws nothing
+	CHECK(matcher.advance(set, 1, "Outro", at(20000)).m_rule == &settings[0]);
+	result = matcher.advance(set, 1, "Live", at(60000));
+	CHECK(!result.m_rule && !result.m_withdraw);
+}
+
+static void test_new_version_starts_over()
+{
+	std::vector<recording_setting> settings{ sequence("A > B", 0) };
+	scene_sequence_set set;
+	set.build(settings);
+
+	scene_sequence_matcher matcher;
+	matcher.advance(set, 1, "A", at(0));
+	CHECK(matcher.get_active() == 1);
+
+	CHECK(!matcher.advance(set, 2, "B", at(1)).m_rule);
+	CHECK(matcher.get_active() == 0);
+}
+
+//Every partial match kept on its own, no merging. Sequence rules only.
+class reference_matcher
+{
+	public:
+		explicit reference_matcher(const std::vector<recording_setting>& settings)
+			: m_settings{ settings }
+		{
+			for (const auto& v : settings)
+				m_steps.push_back(scene_sequence_set::split_steps(v.get_scene_name()));
+		}
+
+		const recording_setting* advance(std::string_view name, clock_type::time_point time)
+		{
+			std::vector<partial> next;
+			std::vector<bool> completed(m_settings.size(), false);
+
+			for (const auto& p : m_partials)
+			{
+				auto window = std::chrono::milliseconds{ m_settings[p.m_rule].get_window() };
+				if (window.count() && time - p.m_start > window)
+					continue;
+
+				if (m_steps[p.m_rule][p.m_state] != name)
+				{
+					next.push_back(p);
+					continue;
+				}
+
+				if (p.m_state + 1 == m_steps[p.m_rule].size())
+					completed[p.m_rule] = true;
+				else
+					next.push_back(partial{ p.m_rule, p.m_state + 1, p.m_start });
+			}
+
+			for (size_t i = 0; i < m_settings.size(); ++i)
+			{
+				if (m_steps[i][0] != name)
+					continue;
+
+				if (m_steps[i].size() == 1)
+					completed[i] = true;
+				else
+					next.push_back(partial{ i, 1, time });
+			}
+
+			m_partials = std::move(next);
+
+			const recording_setting* winner = nullptr;
+			for (size_t i = 0; i < m_settings.size(); ++i)
+			{
+				if (completed[i] && (!winner || m_settings[i].get_priority() > winner->get_priority()))
+					winner = &m_settings[i];
+			}
+
+			return winner;
+		}
+
+	private:
+		struct partial
+		{
+			size_t m_rule;
+			size_t m_state;
+			clock_type::time_point m_start;
+		};
+
+		const std::vector<recording_setting>& m_settings;
+		std::vector<std::vector<std::string_view>> m_steps;
+		std::vector<partial> m_partials;
+};
+
+static void test_against_reference()
+{
+	const std::vector<std::string> names{ "A", "B", "C", "D", "E" };
+	std::mt19937 random{ 2024 };
+
+	for (int round = 0; round < 200; ++round)
+	{
+		std::vector<recording_setting> settings;
+		auto rule_count = 1 + random() % 6;
+
+		for (size_t i = 0; i < rule_count; ++i)
+		{
+			std::string steps;
+			auto step_count = 1 + random() % 4;
+
+			for (size_t s = 0; s < step_count; ++s)
+				steps += (s ? " > " : "") + names[random() % names.size()];
+
+			settings.push_back(sequence(steps, random() % 3 ? static_cast<uint32_t>(random() % 5000) : 0, static_cast<int32_t>(random() % 3)));
+		}
+
+		scene_sequence_set set;
+		set.build(settings);
+
+		scene_sequence_matcher matcher;
+		reference_matcher reference{ settings };
+
+		int64_t time = 0;
+		for (int event = 0; event < 300; ++event)
+		{
+			time += random() % 1500;
+			const auto& name = names[random() % names.size()];
+
+			auto expected = reference.advance(name, at(time));
+			auto actual = matcher.advance(set, 1, name, at(time)).m_rule;
+
+			CHECK(actual == expected);
+			if (actual != expected)
+			{
+				std::printf("round %d event %d: scene %s\n", round, event, name.c_str());
+				return;
+			}
+		}
+	}
+}
+
+//Every scene change starts with its transition, the frontend reports it on the UI thread afterwards. The matcher only
+//advances with the latter, the transition having handled the scene first must not keep a sequence from completing.
+static void test_through_plugin()
+{
+	fake_obs::reset();
+	fake_obs::set_log_level(LOG_ERROR);
+
+	auto intro = fake_obs::create_scene("Intro");
+	auto other = fake_obs::create_scene("Other");
+	auto live = fake_obs::create_scene("Live");
+	auto transition = fake_obs::create_transition("Fade");
+
+	auto& plugin = smartstart_recording::get();
+
+	fake_obs::run_on_ui([&plugin]() -> void
+		{
+			plugin.update_recording_settings(std::list<recording_setting>{ sequence("Intro > Live", 10000) });
+			plugin.attach();
+
+			fake_obs::dispatch_frontend_event(OBS_FRONTEND_EVENT_FINISHED_LOADING);
+			fake_obs::dispatch_frontend_event(OBS_FRONTEND_EVENT_TRANSITION_LIST_CHANGED);
+		});
+
+	//The rule has no delay, the controller's worker starts right away
+	auto wait_for_start = [](int attempts) -> bool
+		{
+			for (int i = 0; i < attempts && !fake_obs::get_start_calls(); ++i)
+				std::this_thread::sleep_for(std::chrono::milliseconds{ 5 });
+
+			return fake_obs::get_start_calls() != 0;
+		};
+
+	//The frontend asks for the current scene once the event runs, so every change has to be through before the next one
+	auto change_scene = [transition](obs_source_t* scene) -> void
+		{
+			fake_obs::set_current_scene(scene, transition);
+			fake_obs::flush_ui();
+		};
+
+	change_scene(live);
+	change_scene(intro);
+	change_scene(other);
+	CHECK(!wait_for_start(10));
+
+	change_scene(live);
+	CHECK(wait_for_start(200));
+
+	fake_obs::run_on_ui([&plugin]() -> void
+		{
+			plugin.unload();
+		});
+
+	fake_obs::reset();
+}
+
+int main()
+{
+	test_split_steps();
+	test_sequence_within_window();
+	test_three_steps_and_merging();
+	test_priority();
+	test_dwell();
+	test_new_version_starts_over();
+	test_against_reference();
+	test_through_plugin();
+
+	return test_failed();
+}